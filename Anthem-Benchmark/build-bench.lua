@@ -0,0 +1,48 @@
+project "Anthem-Benchmark"
+   kind "ConsoleApp"
+   language "C++"
+   cppdialect "C++20"
+   targetdir "bin/%{cfg.buildcfg}"
+   staticruntime "off"
+
+   files { "src/**.h", "src/**.cpp" }
+
+   includedirs
+   {
+      "src",
+
+	  -- Include Core
+	  "../Anthem/src"
+   }
+
+   links
+   {
+      "Anthem"
+   }
+
+   targetdir ("../bin/" .. OutputDir .. "/%{prj.name}")
+   objdir ("../bin/int/" .. OutputDir .. "/%{prj.name}")
+
+   filter "system:windows"
+       systemversion "latest"
+       defines { "WINDOWS" }
+
+   filter "system:linux"
+       links { "pthread" }
+
+   filter "configurations:Debug"
+       defines { "DEBUG" }
+       runtime "Debug"
+       symbols "On"
+
+   filter "configurations:Release"
+       defines { "RELEASE" }
+       runtime "Release"
+       optimize "On"
+       symbols "On"
+
+   filter "configurations:Dist"
+       defines { "DIST" }
+       runtime "Release"
+       optimize "On"
+       symbols "Off"
\ No newline at end of file
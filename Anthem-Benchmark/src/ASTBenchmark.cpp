@@ -0,0 +1,261 @@
+// ASTBenchmark.cpp
+// Contains the Parser and AST traversal benchmarks
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#include <iostream>
+#include "Benchmark.h"
+#include "Corpus.h"
+#include "Parser/Parser.h"
+#include "Parser/FlatAST.h"
+#include "SemanticAnalyzer/SemanticAnalyzer.h"
+#include "AIR/AIR.h"
+
+namespace Anthem::Benchmark {
+	// Totals gathered by a traversal, so both layouts are checked to visit the same tree
+	struct WalkTotals {
+		size_t nodes{ 0 };
+		int64_t literal_sum{ 0 };
+	};
+
+	// Walk the pointer AST the way the semantic passes do, with a virtual call and a cast per node
+	static void walk_expression(const ExpressionNode* expression, WalkTotals& totals);
+	static void walk_statement(const StatementNode* statement, WalkTotals& totals);
+
+	static void walk_declaration(const DeclarationNode* declaration, WalkTotals& totals) {
+		totals.nodes++;
+		switch (declaration->get_type())
+		{
+		case NodeType::VARIABLE: {
+			auto variable = static_cast<const VariableNode*>(declaration);
+			if (variable->expression)
+				walk_expression(variable->expression, totals);
+			break;
+		}
+		case NodeType::FUNCTION_DECLARATION:
+			walk_statement(static_cast<const FunctionDeclarationNode*>(declaration)->body, totals);
+			break;
+		default:
+			break;
+		}
+	}
+
+	static void walk_statement(const StatementNode* statement, WalkTotals& totals) {
+		totals.nodes++;
+		switch (statement->get_type())
+		{
+		case NodeType::RETURN_STATEMENT:
+			walk_expression(static_cast<const ReturnStatementNode*>(statement)->expression, totals);
+			break;
+		case NodeType::EXPR_STATEMENT:
+			walk_expression(static_cast<const ExprStatementNode*>(statement)->expression, totals);
+			break;
+		case NodeType::BLOCK_STATEMENT:
+			for (const BlockItem& item : static_cast<const BlockStatementNode*>(statement)->items) {
+				if (std::holds_alternative<StatementNode*>(item))
+					walk_statement(std::get<StatementNode*>(item), totals);
+				else
+					walk_declaration(std::get<DeclarationNode*>(item), totals);
+			}
+			break;
+		case NodeType::IF_STATEMENT: {
+			auto if_statement = static_cast<const IfStatementNode*>(statement);
+			walk_expression(if_statement->condition, totals);
+			walk_statement(if_statement->body, totals);
+			if (if_statement->else_body)
+				walk_statement(if_statement->else_body, totals);
+			break;
+		}
+		case NodeType::LOOP_STATEMENT:
+			walk_statement(static_cast<const LoopStatementNode*>(statement)->body, totals);
+			break;
+		case NodeType::WHILE_STATEMENT: {
+			auto while_statement = static_cast<const WhileStatementNode*>(statement);
+			walk_expression(while_statement->condition, totals);
+			walk_statement(while_statement->body, totals);
+			break;
+		}
+		case NodeType::FOR_STATEMENT: {
+			auto for_statement = static_cast<const ForStatementNode*>(statement);
+			walk_expression(for_statement->init, totals);
+			walk_expression(for_statement->condition, totals);
+			walk_expression(for_statement->post_loop, totals);
+			walk_statement(for_statement->body, totals);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	static void walk_expression(const ExpressionNode* expression, WalkTotals& totals) {
+		totals.nodes++;
+		switch (expression->get_type())
+		{
+		case NodeType::INT_LITERAL:
+			totals.literal_sum += static_cast<const IntegerLiteralNode*>(expression)->integer;
+			break;
+		case NodeType::UNARY_OPERATION:
+			walk_expression(static_cast<const UnaryOperationNode*>(expression)->expression, totals);
+			break;
+		case NodeType::BINARY_OPERATION: {
+			auto binary_op = static_cast<const BinaryOperationNode*>(expression);
+			walk_expression(binary_op->left_expression, totals);
+			walk_expression(binary_op->right_expression, totals);
+			break;
+		}
+		case NodeType::ASSIGNMENT: {
+			auto assignment = static_cast<const AssignmentNode*>(expression);
+			walk_expression(assignment->lvalue, totals);
+			walk_expression(assignment->expression, totals);
+			break;
+		}
+		case NodeType::INDEX:
+			walk_expression(static_cast<const IndexNode*>(expression)->index, totals);
+			break;
+		case NodeType::FUNCTION_CALL:
+			for (const ExpressionNode* argument : static_cast<const FunctionCallNode*>(expression)->argument_list)
+				walk_expression(argument, totals);
+			break;
+		default:
+			break;
+		}
+	}
+
+	static WalkTotals walk_pointer_ast(const ProgramNode* program) {
+		WalkTotals totals{ 1 };
+		for (const DeclarationNode* declaration : program->declarations)
+			walk_declaration(declaration, totals);
+		return totals;
+	}
+
+	// The same traversal over the flat layout is a single pass over the kind array
+	static WalkTotals walk_flat_ast(const FlatAST& flat) {
+		WalkTotals totals{ flat.size() };
+		for (NodeIndex node = 0; node < flat.size(); node++) {
+			if (flat.kind(node) == NodeType::INT_LITERAL)
+				totals.literal_sum += flat.literal(node);
+		}
+		return totals;
+	}
+
+	void run_ast_benchmark(std::vector<Result>& results) {
+		constexpr size_t source_size = 16 * 1024 * 1024;
+		constexpr size_t iterations = 5;
+
+		SourceManager source_manager;
+		FileID file_id = source_manager.add_file("benchmark.an", generate_corpus(source_size));
+		ErrorHandler error_handler{ &source_manager };
+		Lexer lexer(&error_handler, &source_manager);
+		const TokenList& tokens = lexer.analyze(file_id);
+
+		std::cout << "AST construction and traversal (" << source_size / (1024 * 1024) << " MB corpus)\n";
+
+		// Every iteration parses into a fresh arena, which is freed in one go at the end of the iteration
+		size_t node_count = 0;
+		Result result = measure("ast/parse", iterations, [&] {
+			ASTArena arena;
+			Parser parser(&error_handler, &source_manager, &arena);
+			parser.parse(tokens);
+			node_count = arena.get_node_count();
+			});
+		result.items = node_count;
+		result.bytes = source_manager.get_source(file_id).size();
+		report(result);
+		results.push_back(result);
+
+		// Top level declarations split between the threads, each chunk is parsed into an arena owned by the iteration's arena
+		ThreadPool thread_pool;
+		result = measure("ast/parse/parallel/" + std::to_string(thread_pool.size()) + "_threads", iterations, [&] {
+			ASTArena arena;
+			Parser parser(&error_handler, &source_manager, &arena);
+			parser.parse_parallel(tokens, thread_pool);
+			node_count = arena.get_node_count();
+			});
+		result.items = node_count;
+		result.bytes = source_manager.get_source(file_id).size();
+		report(result);
+		results.push_back(result);
+
+		ASTArena arena;
+		Parser parser(&error_handler, &source_manager, &arena);
+		ProgramNode* program = parser.parse(tokens);
+		if (error_handler.has_errors()) {
+			std::cout << "Error: the corpus did not parse cleanly\n";
+			return;
+		}
+
+		FlatAST flat;
+		result = measure("ast/flatten", iterations, [&] { flat = FlatAST(program); });
+		result.items = flat.size();
+		report(result);
+		results.push_back(result);
+
+		// Traversals are fast, so they are repeated more to get above the timer resolution
+		WalkTotals pointer_totals;
+		result = measure("ast/walk/pointer", iterations * 10, [&] { pointer_totals = walk_pointer_ast(program); });
+		result.items = pointer_totals.nodes;
+		report(result);
+		results.push_back(result);
+
+		WalkTotals flat_totals;
+		result = measure("ast/walk/flat", iterations * 10, [&] { flat_totals = walk_flat_ast(flat); });
+		result.items = flat_totals.nodes;
+		report(result);
+		results.push_back(result);
+
+		if (pointer_totals.nodes != flat_totals.nodes || pointer_totals.literal_sum != flat_totals.literal_sum)
+			std::cout << "Error: the flat AST does not match the pointer AST\n";
+
+		// The analysis renames Nodes in place, so every iteration parses a fresh AST, which is included in the time
+		size_t symbol_count = 0;
+		result = measure("semantic/separate", iterations, [&] {
+			ASTArena arena;
+			Parser parser(&error_handler, &source_manager, &arena);
+			ProgramNode* program = parser.parse(tokens);
+			SemanticAnalyzer analyzer(&error_handler);
+			TypeChecker type_checker(&error_handler);
+			analyzer.analyze_resolve(program, type_checker);
+			type_checker.check(program);
+			symbol_count = type_checker.get_symbols().size();
+			});
+		result.items = symbol_count;
+		report(result);
+		results.push_back(result);
+
+		result = measure("semantic/fused", iterations, [&] {
+			ASTArena arena;
+			Parser parser(&error_handler, &source_manager, &arena);
+			ProgramNode* program = parser.parse(tokens);
+			SemanticAnalyzer analyzer(&error_handler);
+			TypeChecker type_checker(&error_handler);
+			analyzer.analyze(program, type_checker);
+			symbol_count = type_checker.get_symbols().size();
+			});
+		result.items = symbol_count;
+		report(result);
+		results.push_back(result);
+
+		if (error_handler.has_errors()) {
+			std::cout << "Error: the corpus did not analyze cleanly\n";
+			return;
+		}
+
+		// AIR generation only reads the analyzed AST, so the same one is lowered in every iteration
+		SemanticAnalyzer analyzer(&error_handler);
+		TypeChecker type_checker(&error_handler);
+		analyzer.analyze(program, type_checker);
+		size_t instruction_count = 0;
+		result = measure("air/generate", iterations, [&] {
+			AIRGenerator generator(&error_handler);
+			ptr<AIRProgramNode> air = generator.generate(program, type_checker.get_symbols(), type_checker.get_expression_types());
+			instruction_count = 0;
+			for (auto& declaration : air->declarations)
+				if (declaration->get_type() == AIRNodeType::FUNCTION)
+					instruction_count += std::static_pointer_cast<AIRFunctionNode>(declaration)->instructions.size();
+			});
+		result.items = instruction_count;
+		report(result);
+		results.push_back(result);
+		std::cout << "\n";
+	}
+}
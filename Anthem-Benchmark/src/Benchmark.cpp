@@ -0,0 +1,93 @@
+// Benchmark.cpp
+// Contains the entry point of the Benchmark executable
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#include <iostream>
+#include <fstream>
+#include "Benchmark.h"
+
+namespace Anthem::Benchmark {
+	void report(const Result& result) {
+		double iterations = (double)result.iterations;
+		std::cout << result.name << ": " << result.seconds * 1000 / iterations << " ms/iteration";
+		if (result.items)
+			std::cout << ", " << result.seconds * 1e9 / (iterations * result.items) << " ns/item, "
+				<< iterations * result.items / result.seconds / 1e6 << " M items/s";
+		if (result.bytes)
+			std::cout << ", " << iterations * result.bytes / result.seconds / (1024 * 1024) << " MB/s";
+		std::cout << ", " << result.allocations / iterations << " allocations/iteration"
+			<< ", peak RSS " << result.peak_rss / (1024 * 1024) << " MB\n";
+	}
+
+	static std::string escape_json(std::string_view string) {
+		std::string escaped;
+		for (char character : string) {
+			if (character == '"' || character == '\\')
+				escaped += '\\';
+			escaped += character;
+		}
+		return escaped;
+	}
+
+	bool write_json(const std::vector<Result>& results, const std::string& path) {
+		std::ofstream file(path);
+		if (!file)
+			return false;
+
+		file << "{\n\t\"results\": [\n";
+		for (size_t i = 0; i < results.size(); i++) {
+			const Result& result = results[i];
+			double total_items = (double)result.items * result.iterations;
+			double total_bytes = (double)result.bytes * result.iterations;
+			file << "\t\t{ \"name\": \"" << escape_json(result.name) << "\""
+				<< ", \"iterations\": " << result.iterations
+				<< ", \"seconds\": " << result.seconds
+				<< ", \"items\": " << result.items
+				<< ", \"bytes\": " << result.bytes
+				<< ", \"items_per_second\": " << (result.seconds > 0 ? total_items / result.seconds : 0)
+				<< ", \"bytes_per_second\": " << (result.seconds > 0 ? total_bytes / result.seconds : 0)
+				<< ", \"allocations_per_iteration\": " << (double)result.allocations / result.iterations
+				<< ", \"allocated_bytes_per_iteration\": " << (double)result.allocated_bytes / result.iterations
+				<< ", \"peak_rss_bytes\": " << result.peak_rss
+				<< " }" << (i + 1 < results.size() ? "," : "") << "\n";
+		}
+		file << "\t]\n}\n";
+		return true;
+	}
+
+	// Parse sizes like "512", "64K", "16M" or "1G"
+	static size_t parse_size(const std::string& text) {
+		size_t size = std::stoull(text);
+		switch (text.empty() ? '\0' : text.back())
+		{
+		case 'K': case 'k': return size << 10;
+		case 'M': case 'm': return size << 20;
+		case 'G': case 'g': return size << 30;
+		default:			return size;
+		}
+	}
+}
+
+int main(int argc, char* argv[]) {
+	// Usage: Anthem-Benchmark [--json <path>] [--max-size <size>]
+	Anthem::Benchmark::Options options;
+	std::vector<std::string> arguments(argv + 1, argv + argc);
+	for (size_t i = 0; i + 1 < arguments.size(); i++) {
+		if (arguments[i] == "--json")
+			options.json_path = arguments[++i];
+		else if (arguments[i] == "--max-size")
+			options.max_corpus_size = Anthem::Benchmark::parse_size(arguments[++i]);
+	}
+
+	std::vector<Anthem::Benchmark::Result> results;
+	Anthem::Benchmark::run_keyword_benchmark(results);
+	Anthem::Benchmark::run_lexer_benchmark(results);
+	Anthem::Benchmark::run_corpus_benchmark(options, results);
+	Anthem::Benchmark::run_ast_benchmark(results);
+
+	if (!options.json_path.empty() && !Anthem::Benchmark::write_json(results, options.json_path)) {
+		std::cerr << "Could not write '" << options.json_path << "'\n";
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,71 @@
+// Benchmark.h
+// Contains the Benchmark declarations and timing utilities
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#pragma once
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Memory.h"
+
+namespace Anthem::Benchmark {
+	struct Options {
+		// Largest synthetic corpus the suites generate
+		size_t max_corpus_size{ size_t(1) << 30 };
+
+		// Results are also written as JSON to this file if it is not empty
+		std::string json_path;
+	};
+
+	// Result of timing a single benchmark case
+	struct Result {
+		std::string name;
+		size_t iterations{ 0 };
+		double seconds{ 0 };
+
+		// Work done by a single iteration, in items (e.g. Tokens) and source bytes
+		size_t items{ 0 };
+		size_t bytes{ 0 };
+
+		// Memory behaviour, allocations are summed over all iterations
+		size_t allocations{ 0 };
+		size_t allocated_bytes{ 0 };
+		size_t peak_rss{ 0 };
+	};
+
+	// Run <function> <iterations> times and measure the elapsed wall time and allocations
+	template<typename Function>
+	Result measure(std::string_view name, size_t iterations, Function&& function) {
+		size_t allocations = get_allocation_count();
+		size_t allocated_bytes = get_allocated_bytes();
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < iterations; i++)
+			function();
+		auto end = std::chrono::steady_clock::now();
+
+		Result result{ std::string(name), iterations, std::chrono::duration<double>(end - start).count() };
+		result.allocations = get_allocation_count() - allocations;
+		result.allocated_bytes = get_allocated_bytes() - allocated_bytes;
+		result.peak_rss = get_peak_rss();
+		return result;
+	}
+
+	// Print a result in a human readable way
+	void report(const Result& result);
+
+	// Write all results to a JSON file, returns false if the file could not be written
+	bool write_json(const std::vector<Result>& results, const std::string& path);
+
+	// Compare keyword recognition against the old hash map lookup
+	void run_keyword_benchmark(std::vector<Result>& results);
+
+	// Measure the Lexer throughput with every scanning implementation the CPU supports and in parallel
+	void run_lexer_benchmark(std::vector<Result>& results);
+
+	// Measure Lexer::analyze on synthetic corpora from 1 KB up to the maximum corpus size
+	void run_corpus_benchmark(const Options& options, std::vector<Result>& results);
+
+	// Measure parsing into the ASTArena, compare traversals of the pointer and flat AST layouts and time the semantic passes and AIR generation
+	void run_ast_benchmark(std::vector<Result>& results);
+}
@@ -0,0 +1,208 @@
+// Corpus.cpp
+// Contains the synthetic Anthem source generator implementation
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#include "Corpus.h"
+#include <string_view>
+#include <vector>
+
+namespace Anthem::Benchmark {
+	class CorpusGenerator {
+	public:
+		CorpusGenerator(uint64_t seed) : m_state{ seed ? seed : 1 } {}
+
+		std::string generate(size_t size) {
+			m_output.reserve(size + 4096);
+			m_output += "// Synthetic Anthem program generated for benchmarking\n\n";
+			m_output += "external fn putchar(character: i32): i32;\n\n";
+
+			while (m_output.size() < size) {
+				if (random(8) == 0)
+					generate_global();
+				else
+					generate_function();
+			}
+
+			m_output += "fn main(): i32 {\n\treturn 0;\n}\n";
+			return std::move(m_output);
+		}
+	private:
+		// -- Randomness --
+
+		// xorshift64, fast enough to generate a gigabyte of source in a few seconds
+		uint64_t next() {
+			m_state ^= m_state << 13;
+			m_state ^= m_state >> 7;
+			m_state ^= m_state << 17;
+			return m_state;
+		}
+
+		uint32_t random(uint32_t bound) { return uint32_t(next() % bound); }
+
+		template<size_t N>
+		std::string_view pick(const std::string_view (&words)[N]) { return words[random(N)]; }
+
+		// -- Pieces --
+
+		std::string make_identifier() {
+			static const std::string_view words[] = {
+				"index", "count", "total", "value", "result", "buffer", "offset", "length", "accumulated", "current",
+				"previous", "next", "left", "right", "maximum", "minimum", "temporary", "element", "position", "state"
+			};
+
+			// Mostly short names with the occasional long, descriptive one
+			std::string name{ pick(words) };
+			uint32_t parts = random(4) == 0 ? 2 + random(3) : random(2);
+			for (uint32_t i = 0; i < parts; i++) {
+				name += '_';
+				name += pick(words);
+			}
+			name += '_';
+			name += std::to_string(m_name_counter++);
+			return name;
+		}
+
+		void generate_comment(const std::string& indentation) {
+			static const std::string_view sentences[] = {
+				"Computes the running total over the given range",
+				"TODO: handle the overflow case once the type checker supports it",
+				"Keeps track of the current position inside the buffer",
+				"The loop below is expected to run a handful of times",
+				"Early exit when the value is already known"
+			};
+			if (random(3) == 0) {
+				m_output += indentation + "/* " + std::string(pick(sentences)) + "\n";
+				m_output += indentation + "   " + std::string(pick(sentences)) + " */\n";
+			}
+			else
+				m_output += indentation + "// " + std::string(pick(sentences)) + "\n";
+		}
+
+		std::string make_operand(const std::vector<std::string>& variables) {
+			if (variables.empty() || random(3) == 0)
+				return std::to_string(random(1000));
+			return variables[random(uint32_t(variables.size()))];
+		}
+
+		std::string make_expression(const std::vector<std::string>& variables, int depth = 0) {
+			static const std::string_view operators[] = { " + ", " - ", " * ", " / ", " % " };
+			std::string expression = make_operand(variables);
+			uint32_t operations = depth > 1 ? 0 : random(3);
+			for (uint32_t i = 0; i < operations; i++) {
+				expression += pick(operators);
+				if (random(4) == 0)
+					expression += "(" + make_expression(variables, depth + 1) + ")";
+				else
+					expression += make_operand(variables);
+			}
+
+			// Call one of the previous functions now and then
+			if (!m_functions.empty() && random(6) == 0) {
+				const Function& function = m_functions[random(uint32_t(m_functions.size()))];
+				std::string call = function.name + "(";
+				for (uint32_t i = 0; i < function.parameter_count; i++)
+					call += (i ? ", " : "") + make_operand(variables);
+				expression += " + " + call + ")";
+			}
+			return expression;
+		}
+
+		std::string make_condition(const std::vector<std::string>& variables) {
+			static const std::string_view comparisons[] = { " < ", " <= ", " > ", " >= ", " == ", " != " };
+			std::string condition = make_operand(variables) + std::string(pick(comparisons)) + make_operand(variables);
+			if (random(4) == 0)
+				condition += std::string(random(2) ? " and " : " or ") + make_operand(variables) + " != 0";
+			return condition;
+		}
+
+		void generate_global() {
+			std::string name = make_identifier();
+			if (random(2))
+				m_output += "global " + name + ": i32 = " + std::to_string(random(100000)) + ";\n\n";
+			else
+				m_output += "global " + name + ": i32;\n\n";
+		}
+
+		void generate_statement(std::vector<std::string>& variables, const std::string& indentation) {
+			const std::string& target = variables[random(uint32_t(variables.size()))];
+			switch (random(7))
+			{
+			case 0:
+				m_output += indentation + "for " + target + " = 0; " + target + " < " + std::to_string(1 + random(100)) + "; "
+					+ target + " = " + target + " + 1 -> {\n";
+				m_output += indentation + "\t" + variables[0] + " = " + make_expression(variables) + ";\n";
+				m_output += indentation + "}\n";
+				break;
+			case 1:
+				m_output += indentation + "while " + make_condition(variables) + " -> {\n";
+				m_output += indentation + "\t" + target + " = " + target + " * 2 + 1;\n";
+				m_output += indentation + "\tif " + make_condition(variables) + " -> break;\n";
+				m_output += indentation + "}\n";
+				break;
+			case 2:
+				m_output += indentation + "loop {\n";
+				m_output += indentation + "\t" + target + " = " + target + " - 1;\n";
+				m_output += indentation + "\tif " + target + " < 0 -> break;\n";
+				m_output += indentation + "}\n";
+				break;
+			case 3:
+				m_output += indentation + "if " + make_condition(variables) + " -> " + target + " = " + make_expression(variables) + ";\n";
+				m_output += indentation + "else " + target + " = " + make_expression(variables) + ";\n";
+				break;
+			case 4:
+				generate_comment(indentation);
+				break;
+			default:
+				m_output += indentation + target + " = " + make_expression(variables) + ";\n";
+				break;
+			}
+		}
+
+		void generate_function() {
+			generate_comment("");
+
+			Function function{ make_identifier(), random(5) };
+			std::vector<std::string> variables;
+			m_output += "fn " + function.name + "(";
+			for (uint32_t i = 0; i < function.parameter_count; i++) {
+				variables.push_back(make_identifier());
+				m_output += (i ? ", " : "") + variables.back() + ": i32";
+			}
+			m_output += "): i32 {\n";
+
+			uint32_t locals = 1 + random(4);
+			for (uint32_t i = 0; i < locals; i++) {
+				std::string local = make_identifier();
+				m_output += "\tlet " + local + ": i32 = " + make_expression(variables) + ";\n";
+				variables.push_back(local);
+			}
+
+			uint32_t statements = 2 + random(8);
+			for (uint32_t i = 0; i < statements; i++)
+				generate_statement(variables, "\t");
+
+			m_output += "\treturn " + make_expression(variables) + ";\n}\n\n";
+			if (m_functions.size() < MAX_CALLABLE_FUNCTIONS)
+				m_functions.push_back(function);
+			else
+				m_functions[random(MAX_CALLABLE_FUNCTIONS)] = function;
+		}
+	private:
+		struct Function {
+			std::string name;
+			uint32_t parameter_count;
+		};
+
+		uint64_t m_state;
+		uint64_t m_name_counter{ 0 };
+		std::string m_output;
+
+		// Only a limited set of previous functions is kept around to be called, so huge corpora do not keep every name
+		static constexpr uint32_t MAX_CALLABLE_FUNCTIONS = 64;
+		std::vector<Function> m_functions;
+	};
+
+	std::string generate_corpus(size_t size, uint64_t seed) {
+		return CorpusGenerator(seed).generate(size);
+	}
+}
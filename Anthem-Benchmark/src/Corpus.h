@@ -0,0 +1,14 @@
+// Corpus.h
+// Contains the synthetic Anthem source generator used by the benchmarks
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#pragma once
+#include <string>
+#include <cstdint>
+
+namespace Anthem::Benchmark {
+	// Generate a well formed Anthem program of at least <size> bytes, made of global declarations and functions
+	// with a realistic mix of let statements, loops, conditionals, calls, comments and long identifiers.
+	// The same size and seed always produce the same program
+	std::string generate_corpus(size_t size, uint64_t seed = 1);
+}
@@ -0,0 +1,74 @@
+// KeywordBenchmark.cpp
+// Contains the keyword recognition micro-benchmark
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+#include "Benchmark.h"
+#include "Lexer/Token.h"
+
+namespace Anthem::Benchmark {
+	// The lookup the Lexer used before keywords were recognized at compile time, kept here as the reference
+	static const std::unordered_map<std::string, TokenType> map_keywords = [] {
+		std::unordered_map<std::string, TokenType> map;
+		for (const Keyword& keyword : keyword_table)
+			map[std::string(keyword.spelling)] = keyword.type;
+		return map;
+	}();
+
+	static TokenType map_get_keyword(std::string_view name) {
+		// The old Lexer built a string for every identifier before looking it up
+		std::string key(name);
+		if (map_keywords.find(key) != map_keywords.end())
+			return map_keywords.at(key);
+		return NO_TYPE;
+	}
+
+	// A mix of keywords and identifiers, roughly like the names found in Anthem sources
+	static std::vector<std::string_view> make_names() {
+		std::vector<std::string_view> names;
+		static const std::string_view identifiers[] = {
+			"x", "index", "count", "result", "fib", "value", "print", "i", "foo_bar", "iterator",
+			"lettuce", "format", "internals", "do_it", "f", "in", "returned", "truth", "classic", "enumerate"
+		};
+		for (int repeat = 0; repeat < 64; repeat++) {
+			for (const Keyword& keyword : keyword_table)
+				names.push_back(keyword.spelling);
+			for (std::string_view identifier : identifiers)
+				names.push_back(identifier);
+		}
+		return names;
+	}
+
+	void run_keyword_benchmark(std::vector<Result>& results) {
+		const std::vector<std::string_view> names = make_names();
+		constexpr size_t iterations = 2000;
+
+		// Accumulate the results so the lookups can not be optimized away
+		size_t checksum_map = 0;
+		size_t checksum_switch = 0;
+
+		std::cout << "Keyword recognition (" << names.size() << " names per iteration)\n";
+		Result map_result = measure("keywords/unordered_map", iterations, [&] {
+			for (std::string_view name : names)
+				checksum_map += map_get_keyword(name);
+			});
+		map_result.items = names.size();
+		report(map_result);
+
+		Result switch_result = measure("keywords/get_keyword", iterations, [&] {
+			for (std::string_view name : names)
+				checksum_switch += get_keyword(name);
+			});
+		switch_result.items = names.size();
+		report(switch_result);
+
+		if (checksum_map != checksum_switch)
+			std::cout << "Error: keyword lookups disagree\n";
+		std::cout << "Speedup: " << map_result.seconds / switch_result.seconds << "x\n\n";
+
+		results.push_back(map_result);
+		results.push_back(switch_result);
+	}
+}
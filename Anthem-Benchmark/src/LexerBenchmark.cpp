@@ -0,0 +1,114 @@
+// LexerBenchmark.cpp
+// Contains the Lexer throughput benchmarks
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#include <iostream>
+#include "Benchmark.h"
+#include "Corpus.h"
+#include "Lexer/Lexer.h"
+#include "Lexer/Scanner.h"
+
+namespace Anthem::Benchmark {
+	// Lex a file <iterations> times, the Lexer is warmed up first so the results show its steady state
+	template<typename Analyze>
+	static Result measure_lexer(const std::string& name, SourceManager& source_manager, FileID file_id, size_t iterations, Analyze&& analyze) {
+		ErrorHandler error_handler{ &source_manager };
+		Lexer lexer(&error_handler, &source_manager);
+		size_t token_count = analyze(lexer).size();
+
+		Result result = measure(name, iterations, [&] {
+			token_count = analyze(lexer).size();
+			});
+		result.items = token_count;
+		result.bytes = source_manager.get_source(file_id).size();
+		if (error_handler.has_errors())
+			std::cout << "Error: the corpus did not lex cleanly\n";
+		return result;
+	}
+
+	// The parallel Lexer has to produce the serial Tokens, and chunks that start after a newline followed by indentation
+	// and line comments must not be lexed a second time. Uses its own threads so the file is split on any machine
+	static void check_parallel_lexer() {
+		ThreadPool thread_pool(4);
+		std::string source;
+		while (source.size() < 4 * 1024 * 1024) {
+			source += "fn function_" + std::to_string(source.size()) + "(a: i32, b: i32): i32 {\n"
+				"\t// Indented comment before the body\n"
+				"\tlet total: i32 = a * 3 + b;\n"
+				"\n"
+				"\twhile total > 10 -> {\n"
+				"\t\ttotal = total - b;\n"
+				"    \t}\n"
+				"\treturn total;\n"
+				"}\n\n";
+		}
+
+		SourceManager source_manager;
+		FileID file_id = source_manager.add_file("indented.an", source);
+		ErrorHandler error_handler{ &source_manager };
+		Lexer serial_lexer(&error_handler, &source_manager);
+		Lexer parallel_lexer(&error_handler, &source_manager);
+		const TokenList& serial = serial_lexer.analyze(file_id);
+		const TokenList& parallel = parallel_lexer.analyze_parallel(file_id, thread_pool);
+
+		bool same = serial.size() == parallel.size();
+		for (size_t i = 0; same && i < serial.size(); i++)
+			same = serial[i].type == parallel[i].type && serial[i].offset == parallel[i].offset && serial[i].size() == parallel[i].size();
+		if (!same)
+			std::cout << "Error: the parallel Lexer does not match the serial one\n";
+		if (parallel_lexer.relexed_chunks() != 0)
+			std::cout << "Error: the parallel Lexer lexed " << parallel_lexer.relexed_chunks() << " chunks of an indented file again\n";
+	}
+
+	void run_lexer_benchmark(std::vector<Result>& results) {
+		constexpr size_t source_size = 16 * 1024 * 1024;
+		constexpr size_t iterations = 5;
+
+		SourceManager source_manager;
+		FileID file_id = source_manager.add_file("benchmark.an", generate_corpus(source_size));
+
+		std::cout << "Lexer scanning implementations (" << source_size / (1024 * 1024) << " MB corpus)\n";
+		ScanLevel detected = detect_scan_level();
+		for (int level = 0; level <= (int)detected; level++) {
+			set_scan_level((ScanLevel)level);
+			Result result = measure_lexer(std::string("lexer/scan/") + get_scan_level_name((ScanLevel)level), source_manager, file_id, iterations,
+				[&](Lexer& lexer) -> const TokenList& { return lexer.analyze(file_id); });
+			report(result);
+			results.push_back(result);
+		}
+		set_scan_level(detected);
+
+		check_parallel_lexer();
+		ThreadPool thread_pool;
+		Result result = measure_lexer("lexer/parallel/" + std::to_string(thread_pool.size()) + "_threads", source_manager, file_id, iterations,
+			[&](Lexer& lexer) -> const TokenList& { return lexer.analyze_parallel(file_id, thread_pool); });
+		report(result);
+		results.push_back(result);
+		std::cout << "\n";
+	}
+
+	void run_corpus_benchmark(const Options& options, std::vector<Result>& results) {
+		static const std::pair<size_t, const char*> corpus_sizes[] = {
+			{ size_t(1) << 10, "1KB" }, { size_t(64) << 10, "64KB" }, { size_t(1) << 20, "1MB" },
+			{ size_t(16) << 20, "16MB" }, { size_t(256) << 20, "256MB" }, { size_t(1) << 30, "1GB" }
+		};
+
+		std::cout << "Lexer::analyze on synthetic corpora\n";
+		for (auto& [size, size_name] : corpus_sizes) {
+			if (size > options.max_corpus_size)
+				break;
+
+			// Every corpus gets its own SourceManager so the previous one is released before the next one is generated
+			SourceManager source_manager;
+			FileID file_id = source_manager.add_file("corpus.an", generate_corpus(size));
+
+			// Lex about 64 MB per size, so small corpora are not dominated by timer resolution
+			size_t iterations = std::max<size_t>(1, std::min<size_t>(1000, (size_t(64) << 20) / size));
+			Result result = measure_lexer(std::string("lexer/corpus/") + size_name, source_manager, file_id, iterations,
+				[&](Lexer& lexer) -> const TokenList& { return lexer.analyze(file_id); });
+			report(result);
+			results.push_back(result);
+		}
+		std::cout << "\n";
+	}
+}
@@ -0,0 +1,64 @@
+// Memory.cpp
+// Contains the global operator new replacement counting allocations, and the peak RSS query
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#include "Memory.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+	#include <psapi.h>
+#else
+	#include <sys/resource.h>
+#endif
+
+namespace Anthem::Benchmark {
+	static std::atomic<size_t> s_allocation_count{ 0 };
+	static std::atomic<size_t> s_allocated_bytes{ 0 };
+
+	size_t get_allocation_count() {
+		return s_allocation_count.load(std::memory_order_relaxed);
+	}
+
+	size_t get_allocated_bytes() {
+		return s_allocated_bytes.load(std::memory_order_relaxed);
+	}
+
+	size_t get_peak_rss() {
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters{};
+		GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+		return counters.PeakWorkingSetSize;
+#else
+		rusage usage{};
+		getrusage(RUSAGE_SELF, &usage);
+	#ifdef __APPLE__
+		return size_t(usage.ru_maxrss);
+	#else
+		// Linux reports kilobytes
+		return size_t(usage.ru_maxrss) * 1024;
+	#endif
+#endif
+	}
+
+	static void* counted_allocate(size_t size) {
+		s_allocation_count.fetch_add(1, std::memory_order_relaxed);
+		s_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+		if (void* memory = std::malloc(size ? size : 1))
+			return memory;
+		throw std::bad_alloc{};
+	}
+}
+
+// Replacing the global allocation functions counts every allocation of the benchmarked code, including the standard library's.
+// The nothrow forms forward to these by default
+void* operator new(size_t size) { return Anthem::Benchmark::counted_allocate(size); }
+void* operator new[](size_t size) { return Anthem::Benchmark::counted_allocate(size); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
@@ -0,0 +1,17 @@
+// Memory.h
+// Contains the allocation counters and memory usage queries used by the benchmarks
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#pragma once
+#include <cstddef>
+
+namespace Anthem::Benchmark {
+	// Number of calls to operator new since the start of the program
+	size_t get_allocation_count();
+
+	// Bytes requested from operator new since the start of the program
+	size_t get_allocated_bytes();
+
+	// Highest resident set size of the process so far, in bytes
+	size_t get_peak_rss();
+}
@@ -27,6 +27,9 @@ project "Anthem-Build-Manager"
        systemversion "latest"
        defines { "WINDOWS" }
 
+   filter "system:linux"
+       links { "pthread" }
+
    filter "configurations:Debug"
        defines { "DEBUG" }
        runtime "Debug"
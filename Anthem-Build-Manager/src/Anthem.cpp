@@ -1,9 +1,11 @@
 #include <iostream>
 #include <string>
+#include <charconv>
 #include "Utilities.h"
 #include "Utilities/Utilities.h"
 #include "Lexer/Lexer.h"
 #include "Parser/Parser.h"
+#include "Parser/FlatAST.h"
 #include "CodeGeneration/CodeGenerator.h"
 #include "CodeEmission/x86_GAS_Emitter.h"
 #include "AIR/AIR.h"
@@ -25,74 +27,119 @@ int main(int argc, char* argv[]) {
 
 	bool compile_for_windows = false;
 
-	std::string source = Anthem::read_file(arguments[0]);
 	if (std::find(arguments.begin(), arguments.end(), "-w") != arguments.end())
 		compile_for_windows = true;
 
-	// Lexing Phase
+	// Source Loading
 
-	Anthem::ErrorHandler error_handler{};
-	Anthem::Lexer lexer(&error_handler);
-	Anthem::TokenList tokens = lexer.analyze(source, argv[1]);
+	// Source files are memory mapped and shared by all phases, including error reporting
+	Anthem::SourceManager source_manager;
+	Anthem::FileID file_id = source_manager.load_file(arguments[0]);
+	if (file_id == Anthem::INVALID_FILE) {
+		Anthem::log(Anthem::LogType::ERROR, "Could not open file '" + arguments[0] + "'");
+		return -1;
+	}
+
+	Anthem::ErrorHandler error_handler{ &source_manager };
+
+	// The Parser recovers from errors and keeps going, reporting up to this many errors in one run (0 reports all of them)
+	size_t error_limit = 20;
+	for (const std::string& argument : arguments) {
+		if (argument.starts_with("--error-limit="))
+			std::from_chars(argument.data() + 14, argument.data() + argument.size(), error_limit);
+	}
+	error_handler.set_error_limit(error_limit);
+	Anthem::Lexer lexer(&error_handler, &source_manager);
+
+	// The Parser pulls Tokens from the Lexer as it goes, the whole list is only built when it is printed
+	if (std::find(arguments.begin(), arguments.end(), "--tokens") != arguments.end()) {
+		const Anthem::TokenList& tokens = lexer.analyze(file_id);
+		std::cout << "Tokens for file: " << argv[1] << "\n";
+		Anthem::Lexer::pretty_print(tokens, source_manager);
+		std::cout << '\n';
+	}
+
+	// Lexing & Parsing Phase
+
+	// Every AST Node lives in the arena until the end of the compilation, where it is all freed at once
+	Anthem::ASTArena arena;
+	Anthem::Parser parser(&error_handler, &source_manager, &arena);
+	Anthem::ProgramNode* program_node;
+
+	// Large files can be lexed in parallel up front, instead of streaming the Tokens into the Parser,
+	// then their top level declarations can be parsed in parallel as well
+	bool parallel_lex = std::find(arguments.begin(), arguments.end(), "--parallel-lex") != arguments.end();
+	bool parallel_parse = std::find(arguments.begin(), arguments.end(), "--parallel-parse") != arguments.end();
+	if (parallel_lex || parallel_parse) {
+		Anthem::ThreadPool thread_pool;
+		const Anthem::TokenList& tokens = lexer.analyze_parallel(file_id, thread_pool);
+		program_node = parallel_parse ? parser.parse_parallel(tokens, thread_pool) : parser.parse(tokens);
+	}
+	else
+		program_node = parser.parse(lexer, file_id);
 	if (error_handler.has_errors())
 		error_handler.print_errors();
 	else {
-		std::cout << "Tokens for file: " << argv[1] << "\n";
-		Anthem::Lexer::pretty_print(tokens);
-		std::cout << '\n';
+		Anthem::SemanticAnalyzer analyzer(&error_handler);
+		Anthem::TypeChecker type_checker(&error_handler);
 
-		// Parsing Phase
+		// Names are resolved and types are checked in a single walk, the separate walk of each phase can still be used for debugging
+		if (std::find(arguments.begin(), arguments.end(), "--separate-passes") != arguments.end()) {
+			analyzer.analyze_resolve(program_node, type_checker);
+			if (!error_handler.has_errors())
+				type_checker.check(program_node);
+		}
+		else
+			analyzer.analyze(program_node, type_checker);
 
-		Anthem::Parser parser(&error_handler);
-		Anthem::ptr<Anthem::ProgramNode> program_node = parser.parse(tokens);
 		if (error_handler.has_errors())
 			error_handler.print_errors();
 		else {
-			Anthem::SemanticAnalyzer analyzer(&error_handler);
-			analyzer.analyze_resolve(program_node);
+			std::cout << "Parse Tree for file: " << argv[1] << "\n";
+			// The flat layout of the tree can be printed instead, with one node per line
+			if (std::find(arguments.begin(), arguments.end(), "--flat-ast") != arguments.end())
+				Anthem::FlatAST(program_node).pretty_print();
+			else
+				Anthem::Parser::pretty_print(program_node);
+			std::cout << "\n";
+
+
+			Anthem::AIRGenerator air_gen(&error_handler);
+			Anthem::ptr<Anthem::AIRProgramNode> air_node = air_gen.generate(program_node, type_checker.get_symbols(), type_checker.get_expression_types());
 
-			if (error_handler.has_errors())
+			// Calls to constant functions in initializers are run while the AIR is generated, and may fail
+			if (error_handler.has_errors()) {
 				error_handler.print_errors();
-			else {
-				Anthem::TypeChecker type_checker(&error_handler);
-				type_checker.check(program_node);
+				return 0;
+			}
+			std::cout << "\nAIR Output:\n";
+			for (auto& var : air_gen.get_extra_definitions()) {
+				Anthem::AIRGenerator::pretty_print(var);
+			}
+			Anthem::AIRGenerator::pretty_print(air_node);
 
-				if (error_handler.has_errors())
-					error_handler.print_errors();
-				else {
-					std::cout << "Parse Tree for file: " << argv[1] << "\n";
-					Anthem::Parser::pretty_print(program_node);
-					std::cout << "\n";
-
-
-					Anthem::AIRGenerator air_gen(&error_handler);
-					Anthem::ptr<Anthem::AIRProgramNode> air_node = air_gen.generate(program_node, type_checker.get_symbols());
-					std::cout << "\nAIR Output:\n";
-					for (auto& var : air_gen.get_extra_definitions()) {
-						Anthem::AIRGenerator::pretty_print(var);
-					}
-					Anthem::AIRGenerator::pretty_print(air_node);
-
-					Anthem::CodeGenerator code_gen(&error_handler, compile_for_windows);
-					Anthem::ptr<Anthem::ASMProgramNode> asm_node = code_gen.generate(air_node, air_gen.get_extra_definitions());
-
-					std::string output{ "" };
-					Anthem::x86_GAS_Emitter emitter(compile_for_windows);
-					emitter.emit(asm_node, output);
-					std::cout << "\nAssembly Output for file: " << argv[1] << "\n" << output << "\n";
-
-					std::filesystem::path path = argv[1];
-					path = path.replace_extension("s");
-					Anthem::write_file(path, output);
-
-					std::string execute_gcc = "gcc " + path.string() + " -o " + path.string().substr(0, path.string().size() - 2);
-					std::cout << execute_gcc << '\n';
-					system(execute_gcc.c_str());
-				}
+			Anthem::CodeGenerator code_gen(&error_handler, compile_for_windows);
+			Anthem::ptr<Anthem::ASMProgramNode> asm_node = code_gen.generate(air_node, air_gen.get_extra_definitions());
+
+			// Stack frames that are too large are only found once the arrays get their slots
+			if (error_handler.has_errors()) {
+				error_handler.print_errors();
+				return 0;
 			}
-		}
 
-		
+			std::string output{ "" };
+			Anthem::x86_GAS_Emitter emitter(compile_for_windows);
+			emitter.emit(asm_node, output);
+			std::cout << "\nAssembly Output for file: " << argv[1] << "\n" << output << "\n";
+
+			std::filesystem::path path = argv[1];
+			path = path.replace_extension("s");
+			Anthem::write_file(path, output);
+
+			std::string execute_gcc = "gcc " + path.string() + " -o " + path.string().substr(0, path.string().size() - 2);
+			std::cout << execute_gcc << '\n';
+			system(execute_gcc.c_str());
+		}
 	}
 
 	return 0;
@@ -6,29 +6,14 @@
 #include <iostream>
 
 namespace Anthem {
-	// Utility
-	BinaryOperation token_to_bin_op(const Token& token) {
-		switch (token.type) {
-		case MINUS: return BinaryOperation::SUBTRACTION;
-		case PLUS: return BinaryOperation::ADDITION;
-		case STAR: return BinaryOperation::MULTIPLICATION;
-		case SLASH: return BinaryOperation::DIVISION;
-		case PERCENT: return BinaryOperation::REMAINDER;
-		case GREATER: return BinaryOperation::GREATER;
-		case GREATER_EQUAL: return BinaryOperation::GREATER_EQUAL;
-		case LESS: return BinaryOperation::LESS;
-		case LESS_EQUAL: return BinaryOperation::LESS_EQUAL;
-		case EQUAL_EQUAL: return BinaryOperation::EQUAL;
-		case BANG_EQUAL: return BinaryOperation::NOT_EQUAL;
-		case AND: return BinaryOperation::AND;
-		case OR: return BinaryOperation::OR;
-		}
-	}
-
 	AIRGenerator::AIRGenerator(ErrorHandler* error_handler) : m_error_handler{ error_handler } {}
 
-	Name AIRGenerator::make_temporary_name() {
-		return std::format("#{0}", m_temp_counter++);
+	ptr<AIRVariableValueNode> AIRGenerator::make_temporary(ReturnType type) {
+		return std::make_shared<AIRVariableValueNode>(TempId(m_temp_counter++), type);
+	}
+
+	LabelId AIRGenerator::loop_label(LabelKind kind, uint64_t loop_id) {
+		return { kind, static_cast<uint32_t>(loop_id) };
 	}
 
 	void AIRGenerator::pretty_print(ptr<AIRNode> node) {
@@ -143,6 +128,35 @@ namespace Anthem {
 			std::cout << '\n';
 			break;
 		}
+		case AIRNodeType::CONVERT: {
+			ptr<AIRConvertInstructionNode> convert = std::static_pointer_cast<AIRConvertInstructionNode>(node);
+			pretty_print(convert->destination);
+			std::cout << " = CONVERT ";
+			pretty_print(convert->source);
+			std::cout << '\n';
+			break;
+		}
+		case AIRNodeType::LOAD_ELEMENT: {
+			ptr<AIRLoadElementInstructionNode> load = std::static_pointer_cast<AIRLoadElementInstructionNode>(node);
+			pretty_print(load->destination);
+			std::cout << (load->checked ? " = LOAD_ELEMENT " : " = LOAD_ELEMENT_UNCHECKED ");
+			pretty_print(load->array);
+			std::cout << '[';
+			pretty_print(load->index);
+			std::cout << "; " << load->length << "]\n";
+			break;
+		}
+		case AIRNodeType::STORE_ELEMENT: {
+			ptr<AIRStoreElementInstructionNode> store = std::static_pointer_cast<AIRStoreElementInstructionNode>(node);
+			std::cout << (store->checked ? "STORE_ELEMENT " : "STORE_ELEMENT_UNCHECKED ");
+			pretty_print(store->array);
+			std::cout << '[';
+			pretty_print(store->index);
+			std::cout << "; " << store->length << "], ";
+			pretty_print(store->value);
+			std::cout << '\n';
+			break;
+		}
 		case AIRNodeType::LABEL: {
 			ptr<AIRLabelNode> label = std::static_pointer_cast<AIRLabelNode>(node);
 			std::cout << "LABEL " << label->label << ":\n";
@@ -150,7 +164,12 @@ namespace Anthem {
 		}
 		case AIRNodeType::VARIABLE: {
 			ptr<AIRVariableValueNode> variable = std::static_pointer_cast<AIRVariableValueNode>(node);
-			std::cout << variable->variable;
+			if (variable->local.valid())
+				std::cout << variable->local;
+			else if (variable->temporary.valid())
+				std::cout << variable->temporary;
+			else
+				std::cout << variable->name;
 			break;
 		}
 		case AIRNodeType::INTEGER: {
@@ -158,9 +177,15 @@ namespace Anthem {
 			std::cout << integer->integer;
 			break;
 		}
+		case AIRNodeType::FLOAT: {
+			ptr<AIRFloatValueNode> floating = std::static_pointer_cast<AIRFloatValueNode>(node);
+			std::cout << floating->floating;
+			break;
+		}
 		case AIRNodeType::CALL: {
 			ptr<AIRFunctionCallNode> func_call = std::static_pointer_cast<AIRFunctionCallNode>(node);
-			std::cout << "result = CALL(" << func_call->function << ", [";
+			pretty_print(func_call->destination);
+			std::cout << " = CALL(" << func_call->function << ", [";
 			for (auto& arg : func_call->value_list) {
 				pretty_print(arg);
 				std::cout << ", ";
@@ -170,37 +195,69 @@ namespace Anthem {
 		}
 		case AIRNodeType::FLAGGED_VAR: {
 			ptr<AIRFlaggedVarNode> flagged_node = std::static_pointer_cast<AIRFlaggedVarNode>(node);
-			std::cout << "flagged " << flagged_node->name << '\n';
+			std::cout << "flagged " << flagged_node->name;
+			if (flagged_node->array_length)
+				std::cout << '[' << flagged_node->array_length << ']';
+			std::cout << '\n';
 			break;
 		}
 		}
 	}
 
-	ptr<AIRVariableValueNode> AIRGenerator::make_variable(Name name) {
-		bool flagged = false;
-		for (auto& var : m_extra_definitions) {
-			if (var->name == name) {
-				flagged = true;
-				break;
-			}
-		}
-		return std::make_shared<AIRVariableValueNode>(name, flagged);
+	ptr<AIRVariableValueNode> AIRGenerator::make_variable(VarId id, const Name& name, ReturnType type) {
+		if (id.valid())
+			return std::make_shared<AIRVariableValueNode>(id, type);
+		// Every variable that is not local is defined once for the whole program and addressed by its symbol
+		return std::make_shared<AIRVariableValueNode>(name, type);
 	}
 
-	ptr<AIRProgramNode> AIRGenerator::generate(ptr<ProgramNode> program, SymbolTable& symbol_table) {
+	ptr<AIRProgramNode> AIRGenerator::generate(ProgramNode* program, SymbolTable& symbol_table, const ExpressionTypes& expression_types) {
+		m_symbol_table = &symbol_table;
+		m_expression_types = &expression_types;
 		m_extra_definitions.clear();
+		m_evaluated_variables.clear();
+		ptr<AIRProgramNode> program_node = generate_program(program);
+		evaluate_initializers(program_node);
 		for (auto& [name, type] : symbol_table) {
 			if (std::holds_alternative<VariableType>(type)) {
 				VariableType var_type = std::get<VariableType>(type);
 				if (var_type.flag != VarFlag::Local)
-					m_extra_definitions.push_back(std::make_shared<AIRFlaggedVarNode>(name, var_type.flag, var_type.initializer));
+					m_extra_definitions.push_back(std::make_shared<AIRFlaggedVarNode>(name, var_type.flag, var_type.return_type, var_type.initializer, var_type.array_length));
 			}
 		}
-		ptr<AIRProgramNode> program_node = generate_program(program);
 		return program_node;
 	}
 
-	ptr<AIRProgramNode> AIRGenerator::generate_program(ptr<ProgramNode> program_node) {
+	void AIRGenerator::evaluate_initializers(ptr<AIRProgramNode> program) {
+		if (m_evaluated_variables.empty())
+			return;
+
+		AIRInterpreter interpreter{ m_error_handler };
+		for (auto& declaration : program->declarations) {
+			if (declaration->get_type() != AIRNodeType::FUNCTION)
+				continue;
+			auto function = std::static_pointer_cast<AIRFunctionNode>(declaration);
+			auto symbol = m_symbol_table->find(function->name);
+			if (symbol != m_symbol_table->end() && std::get<FunctionType>(symbol->second).is_const)
+				interpreter.add_function(function);
+		}
+
+		// Each initializer is generated as a function returning its value, which is then run
+		for (VariableNode* variable : m_evaluated_variables) {
+			ptr<AIRFunctionNode> initializer = std::make_shared<AIRFunctionNode>();
+			initializer->name = variable->name;
+			initializer->return_type = variable->type;
+			m_temp_counter = 0;
+			m_return_type = variable->type;
+			ptr<AIRValueNode> value = resolve_expression(variable->expression, initializer->instructions);
+			initializer->instructions.push_back(std::make_shared<AIRReturnInstructionNode>(convert(value, m_return_type, initializer->instructions)));
+
+			if (std::optional<Constant> result = interpreter.run(initializer, variable->variable_token.position()))
+				std::get<VariableType>((*m_symbol_table)[variable->name]).initializer = result->bits();
+		}
+	}
+
+	ptr<AIRProgramNode> AIRGenerator::generate_program(ProgramNode* program_node) {
 		ptr<AIRProgramNode> AIR_program_node = std::make_shared<AIRProgramNode>();
 
 		// Generate AIR Declarations from every one of the AST Program Node
@@ -213,19 +270,24 @@ namespace Anthem {
 		return AIR_program_node;
 	}
 
-	ptr<AIRDeclarationNode> AIRGenerator::generate_declaration(ptr<DeclarationNode> declaration_node, AIRInstructionList* output_optional) {
+	ptr<AIRDeclarationNode> AIRGenerator::generate_declaration(DeclarationNode* declaration_node, AIRInstructionList* output_optional) {
 		// Handle any Declaration Case
 		switch (declaration_node->get_type()) {
 		case NodeType::FUNCTION_DECLARATION:
-			return generate_function_declaration(std::static_pointer_cast<FunctionDeclarationNode>(declaration_node));
+			return generate_function_declaration(static_cast<FunctionDeclarationNode*>(declaration_node));
 		case NodeType::VARIABLE: {
+			auto variable = static_cast<VariableNode*>(declaration_node);
+			if (variable->flag != VarFlag::Local) {
+				auto symbol = m_symbol_table->find(variable->name);
+				if (symbol != m_symbol_table->end() && std::get<VariableType>(symbol->second).calls_functions)
+					m_evaluated_variables.push_back(variable);
+			}
 			if (output_optional) {
-				auto variable = std::static_pointer_cast<VariableNode>(declaration_node);
 				if (variable->expression) {
 					ptr<AIRValueNode> source = resolve_expression(variable->expression, *output_optional);
-					ptr<AIRVariableValueNode> target = make_variable(variable->variable_token.value);
+					ptr<AIRVariableValueNode> target = make_variable(variable->id, variable->name, variable->type);
 
-					output_optional->push_back(std::make_shared<AIRSetInstructionNode>(target, source));
+					assign(target, source, *output_optional);
 				}
 			}
 			return nullptr;
@@ -235,170 +297,253 @@ namespace Anthem {
 		}
 	}
 
-	ptr<AIRFunctionNode> AIRGenerator::generate_function_declaration(ptr<FunctionDeclarationNode> function_node) {
+	ptr<AIRFunctionNode> AIRGenerator::generate_function_declaration(FunctionDeclarationNode* function_node) {
 		ptr<AIRFunctionNode> AIR_function_node = std::make_shared<AIRFunctionNode>();
 		AIR_function_node->name = function_node->name;
-		for (auto& name : function_node->parameters) {
-			AIR_function_node->parameters.push_back(name.name);
+		AIR_function_node->return_type = function_node->return_type;
+		for (auto& parameter : function_node->parameters) {
+			AIR_function_node->parameters.push_back(make_variable(parameter.id, parameter.name, parameter.type));
 		}
+		// Temporaries are numbered per function
+		m_temp_counter = 0;
+		m_return_type = function_node->return_type;
 		generate_statement(function_node->body, AIR_function_node->instructions);
 		// Add return 0 instruction in case function doesn't have a return statement
-		AIR_function_node->instructions.push_back(std::make_shared<AIRReturnInstructionNode>(std::make_shared<AIRIntegerValueNode>(0)));
+		AIR_function_node->instructions.push_back(std::make_shared<AIRReturnInstructionNode>(convert(integer(0), m_return_type, AIR_function_node->instructions)));
 		AIR_function_node->flag = function_node->flag;
 		return AIR_function_node;
 	}
 
-	void AIRGenerator::generate_statement(ptr<StatementNode> statement_node, AIRInstructionList& output) {
+	void AIRGenerator::generate_statement(StatementNode* statement_node, AIRInstructionList& output) {
+		// Nested statements are generated from an explicit stack instead of recursion, so the nesting depth is only limited by memory.
+		// A statement is resumed once the nested statement it returned is done
+		size_t base = m_statement_stack.size();
+		m_statement_stack.push_back({ statement_node, 0, {}, {} });
+		while (m_statement_stack.size() > base) {
+			StatementNode* nested = continue_statement(m_statement_stack.back(), output);
+			if (nested)
+				m_statement_stack.push_back({ nested, 0, {}, {} });
+			else
+				m_statement_stack.pop_back();
+		}
+	}
+
+	StatementNode* AIRGenerator::continue_statement(GenerationFrame& frame, AIRInstructionList& output) {
+		StatementNode* statement_node = static_cast<StatementNode*>(frame.node);
 		switch (statement_node->get_type()) {
 		case NodeType::RETURN_STATEMENT: 
-			generate_return(std::static_pointer_cast<ReturnStatementNode>(statement_node), output);
-			break;
+			generate_return(static_cast<ReturnStatementNode*>(statement_node), output);
+			return nullptr;
 		case NodeType::BLOCK_STATEMENT:
-			generate_block(std::static_pointer_cast<BlockStatementNode>(statement_node), output);
-			break;
+			return generate_block(static_cast<BlockStatementNode*>(statement_node), frame, output);
 		case NodeType::VOID_STATEMENT:
-			return;
+			return nullptr;
 		case NodeType::EXPR_STATEMENT:
-			resolve_expression(std::static_pointer_cast<ExprStatementNode>(statement_node)->expression, output);
-			break;
+			resolve_expression(static_cast<ExprStatementNode*>(statement_node)->expression, output);
+			return nullptr;
 		case NodeType::IF_STATEMENT:
-			generate_if(std::static_pointer_cast<IfStatementNode>(statement_node), output);
-			break;
+			return generate_if(static_cast<IfStatementNode*>(statement_node), frame, output);
 		case NodeType::LOOP_STATEMENT:
-			generate_loop(std::static_pointer_cast<LoopStatementNode>(statement_node), output);
-			break;
+			return generate_loop(static_cast<LoopStatementNode*>(statement_node), frame, output);
 		case NodeType::WHILE_STATEMENT:
-			generate_while(std::static_pointer_cast<WhileStatementNode>(statement_node), output);
-			break;
+			return generate_while(static_cast<WhileStatementNode*>(statement_node), frame, output);
 		case NodeType::FOR_STATEMENT:
-			generate_for(std::static_pointer_cast<ForStatementNode>(statement_node), output);
-			break;
+			return generate_for(static_cast<ForStatementNode*>(statement_node), frame, output);
 		case NodeType::BREAK_STATEMENT:
-			generate_break(std::static_pointer_cast<BreakStatementNode>(statement_node), output);
-			break;
+			generate_break(static_cast<BreakStatementNode*>(statement_node), output);
+			return nullptr;
 		case NodeType::CONTINUE_STATEMENT:
-			generate_continue(std::static_pointer_cast<ContinueStatementNode>(statement_node), output);
-			break;
+			generate_continue(static_cast<ContinueStatementNode*>(statement_node), output);
+			return nullptr;
 		default:
-			return;
+			return nullptr;
 		}
 	}
 
-	void AIRGenerator::generate_return(ptr<ReturnStatementNode> return_statement_node, AIRInstructionList& output) {
-		output.push_back(std::make_shared<AIRReturnInstructionNode>(resolve_expression(return_statement_node->expression, output)));
+	void AIRGenerator::generate_return(ReturnStatementNode* return_statement_node, AIRInstructionList& output) {
+		ptr<AIRValueNode> value = resolve_expression(return_statement_node->expression, output);
+		output.push_back(std::make_shared<AIRReturnInstructionNode>(convert(value, m_return_type, output)));
 	}
 
-	void AIRGenerator::generate_block(ptr<BlockStatementNode> block_statement, AIRInstructionList& output) {
-		for (auto& item : block_statement->items) {
-			if (std::holds_alternative<ptr<StatementNode>>(item))
-				generate_statement(std::get<ptr<StatementNode>>(item), output);
-			else
-				generate_declaration(std::get<ptr<DeclarationNode>>(item), &output);
+	StatementNode* AIRGenerator::generate_block(BlockStatementNode* block_statement, GenerationFrame& frame, AIRInstructionList& output) {
+		// The stage is the index of the next item
+		while (frame.stage < block_statement->items.size()) {
+			auto& item = block_statement->items[frame.stage++];
+			if (std::holds_alternative<StatementNode*>(item))
+				return std::get<StatementNode*>(item);
+			generate_declaration(std::get<DeclarationNode*>(item), &output);
 		}
+		return nullptr;
 	}
 
-	void AIRGenerator::generate_loop(ptr<LoopStatementNode> loop_statement, AIRInstructionList& output) {
-		Name loop_label = std::format("loop.{0}", loop_statement->id);
-		Name exit_label = std::format("exit.{0}", loop_statement->id);
+	StatementNode* AIRGenerator::generate_loop(LoopStatementNode* loop_statement, GenerationFrame& frame, AIRInstructionList& output) {
+		if (frame.stage++ == 0) {
+			frame.first_label = loop_label(LabelKind::LOOP, loop_statement->id);
+			frame.second_label = loop_label(LabelKind::EXIT, loop_statement->id);
+
+			output.push_back(label(frame.first_label));
+			return loop_statement->body;
+		}
 
-		output.push_back(label(loop_label));
-		generate_statement(loop_statement->body, output);
-		output.push_back(jump(loop_label));
-		output.push_back(label(exit_label));
+		output.push_back(jump(frame.first_label));
+		output.push_back(label(frame.second_label));
+		return nullptr;
 	}
 
-	void AIRGenerator::generate_while(ptr<WhileStatementNode> while_statement, AIRInstructionList& output) {
-		Name loop_label = std::format("loop.{0}", while_statement->id);
-		Name exit_label = std::format("exit.{0}", while_statement->id);
+	StatementNode* AIRGenerator::generate_while(WhileStatementNode* while_statement, GenerationFrame& frame, AIRInstructionList& output) {
+		if (frame.stage++ == 0) {
+			frame.first_label = loop_label(LabelKind::LOOP, while_statement->id);
+			frame.second_label = loop_label(LabelKind::EXIT, while_statement->id);
+
+			output.push_back(label(frame.first_label));
+			auto result = condition(resolve_expression(while_statement->condition, output), output);
+			output.push_back(jump_zero(result, frame.second_label));
+			return while_statement->body;
+		}
 
-		output.push_back(label(loop_label));
-		auto result = resolve_expression(while_statement->condition, output);
-		output.push_back(jump_zero(result, exit_label));
-		
-		generate_statement(while_statement->body, output);
-		output.push_back(jump(loop_label));
-		output.push_back(label(exit_label));
+		output.push_back(jump(frame.first_label));
+		output.push_back(label(frame.second_label));
+		return nullptr;
 	}
 
-	void AIRGenerator::generate_for(ptr<ForStatementNode> for_statement, AIRInstructionList& output) {
-		Name loop_label = std::format("loop.{0}", for_statement->id);
-		Name post_label = std::format("post.{0}", for_statement->id);
-		Name exit_label = std::format("exit.{0}", for_statement->id);
+	StatementNode* AIRGenerator::generate_for(ForStatementNode* for_statement, GenerationFrame& frame, AIRInstructionList& output) {
+		if (frame.stage++ == 0) {
+			frame.first_label = loop_label(LabelKind::LOOP, for_statement->id);
+			frame.second_label = loop_label(LabelKind::EXIT, for_statement->id);
 
-		resolve_expression(for_statement->init, output);
-		output.push_back(label(loop_label));
-		auto result = resolve_expression(for_statement->condition, output);
-		output.push_back(jump_zero(result, exit_label));
+			resolve_expression(for_statement->init, output);
+			size_t init_end = output.size();
+			output.push_back(label(frame.first_label));
+			size_t condition_start = output.size();
+			ptr<AIRValueNode> value = resolve_expression(for_statement->condition, output);
+			begin_induction_range(for_statement, init_end, condition_start, value, output);
 
-		generate_statement(for_statement->body, output);
+			auto result = condition(value, output);
+			output.push_back(jump_zero(result, frame.second_label));
+			if (!m_induction_ranges.empty() && m_induction_ranges.back().loop == for_statement)
+				m_induction_ranges.back().body_start = output.size();
+			return for_statement->body;
+		}
 
+		// The range only holds in the body, the post loop expression is generated without it
+		size_t post_start = output.size();
+		std::optional<InductionRange> range;
+		if (!m_induction_ranges.empty() && m_induction_ranges.back().loop == for_statement) {
+			range = std::move(m_induction_ranges.back());
+			m_induction_ranges.pop_back();
+		}
 		resolve_expression(for_statement->post_loop, output);
-		output.push_back(jump(loop_label));
-		output.push_back(label(exit_label));
+		if (range)
+			end_induction_range(*range, post_start, output);
+		output.push_back(jump(frame.first_label));
+		output.push_back(label(frame.second_label));
+		return nullptr;
 	}
 
-	void AIRGenerator::generate_break(ptr<BreakStatementNode> break_statement, AIRInstructionList& output) {
+	void AIRGenerator::generate_break(BreakStatementNode* break_statement, AIRInstructionList& output) {
 		// Jump to the exit label of the loop corresponding to this break statement
-		output.push_back(jump(std::format("exit.{0}", break_statement->id)));
+		output.push_back(jump(loop_label(LabelKind::EXIT, break_statement->id)));
 	}
 
-	void AIRGenerator::generate_continue(ptr<ContinueStatementNode> continue_statement, AIRInstructionList& output) {
+	void AIRGenerator::generate_continue(ContinueStatementNode* continue_statement, AIRInstructionList& output) {
 		// Jump to the loop start label of the loop corresponding to this continue statement
-		output.push_back(jump(std::format("loop.{0}", continue_statement->id)));
+		output.push_back(jump(loop_label(LabelKind::LOOP, continue_statement->id)));
 	}
 
-	void AIRGenerator::generate_if(ptr<IfStatementNode> if_statement, AIRInstructionList& output) {
-		ptr<AIRValueNode> result = resolve_expression(if_statement->condition, output);
-		//ptr<AIRVariableValueNode> result = make_variable(make_temporary_name());
-		//output.push_back(set(result, condition));
+	StatementNode* AIRGenerator::generate_if(IfStatementNode* if_statement, GenerationFrame& frame, AIRInstructionList& output) {
+		switch (frame.stage++) {
+		case 0: {
+			ptr<AIRValueNode> result = condition(resolve_expression(if_statement->condition, output), output);
+			//ptr<AIRVariableValueNode> result = make_temporary();
+			//output.push_back(set(result, condition));
 
-		Name false_label = std::format("false_label.{0}", m_global_label_counter);
-		Name end_label = std::format("end_label.{0}", m_global_label_counter);
-		m_global_label_counter++;
+			frame.first_label = { LabelKind::FALSE_BRANCH, m_global_label_counter };
+			frame.second_label = { LabelKind::END_IF, m_global_label_counter };
+			m_global_label_counter++;
 
-		// If the result of the condition is false, jump to the false label, which might be the
-		// end of the statement or the start of the else statement if one is present
-		output.push_back(jump_zero(result, false_label));
-		generate_statement(if_statement->body, output);
-		
-		if (if_statement->else_body) {
-			// If there is an else statement, emit a jump instruction to execute after the if body
-			// instructions are finished, in order to skip the else body instructions
-			output.push_back(jump(end_label));
+			// If the result of the condition is false, jump to the false label, which might be the
+			// end of the statement or the start of the else statement if one is present
+			output.push_back(jump_zero(result, frame.first_label));
+			return if_statement->body;
+		}
+		case 1:
+			if (if_statement->else_body) {
+				// If there is an else statement, emit a jump instruction to execute after the if body
+				// instructions are finished, in order to skip the else body instructions
+				output.push_back(jump(frame.second_label));
 
-			// Here start the instructions of the else body
-			output.push_back(label(false_label));
-			generate_statement(if_statement->else_body, output);
-			output.push_back(label(end_label));
+				// Here start the instructions of the else body
+				output.push_back(label(frame.first_label));
+				return if_statement->else_body;
+			}
+			output.push_back(label(frame.first_label));
+			return nullptr;
+		default:
+			output.push_back(label(frame.second_label));
+			return nullptr;
 		}
-		else
-			output.push_back(label(false_label));
 	}
 
-	ptr<AIRValueNode> AIRGenerator::resolve_expression(ptr<ExpressionNode> expression, AIRInstructionList& output) {
+	ptr<AIRValueNode> AIRGenerator::resolve_expression(ExpressionNode* expression, AIRInstructionList& output) {
+		// Operands are resolved from an explicit stack instead of recursion, so the nesting depth is only limited by memory.
+		// An expression is resumed once the operand it returned is resolved, finished expressions push their value to <m_values>
+		size_t base = m_expression_stack.size();
+		m_expression_stack.push_back({ expression, 0, {}, {} });
+		while (m_expression_stack.size() > base) {
+			ExpressionNode* operand = continue_expression(m_expression_stack.back(), output);
+			if (operand)
+				m_expression_stack.push_back({ operand, 0, {}, {} });
+			else
+				m_expression_stack.pop_back();
+		}
+		return pop_value();
+	}
+
+	ExpressionNode* AIRGenerator::continue_expression(GenerationFrame& frame, AIRInstructionList& output) {
+		ExpressionNode* expression = static_cast<ExpressionNode*>(frame.node);
 		switch (expression->get_type())
 		{
 		case NodeType::INT_LITERAL:
-			return std::make_shared<AIRIntegerValueNode>(std::static_pointer_cast<IntegerLiteralNode>(expression)->integer);
+			m_values.push_back(integer(static_cast<IntegerLiteralNode*>(expression)->integer, type_of(expression)));
+			return nullptr;
+		case NodeType::FLOAT_LITERAL:
+			m_values.push_back(floating(static_cast<FloatLiteralNode*>(expression)->floating, type_of(expression)));
+			return nullptr;
+		case NodeType::BOOL_LITERAL:
+			m_values.push_back(integer(static_cast<BoolLiteralNode*>(expression)->value, ReturnType::BOOL));
+			return nullptr;
 		case NodeType::UNARY_OPERATION:
-			return unary_operation(std::static_pointer_cast<UnaryOperationNode>(expression), output);
+			return unary_operation(static_cast<UnaryOperationNode*>(expression), frame, output);
 		case NodeType::BINARY_OPERATION:
-			return binary_operation(std::static_pointer_cast<BinaryOperationNode>(expression), output);
+			return binary_operation(static_cast<BinaryOperationNode*>(expression), frame, output);
 		case NodeType::ASSIGNMENT:
-			return assignment(std::static_pointer_cast<AssignmentNode>(expression), output);
-		case NodeType::NAME_ACCESS:
-			return make_variable(std::static_pointer_cast<AccessNode>(expression)->variable_token.value);
+			return assignment(static_cast<AssignmentNode*>(expression), frame, output);
+		case NodeType::NAME_ACCESS: {
+			AccessNode* access = static_cast<AccessNode*>(expression);
+			m_values.push_back(make_variable(access->id, access->name, type_of(access)));
+			return nullptr;
+		}
 		case NodeType::FUNCTION_CALL:
-			return function_call(std::static_pointer_cast<FunctionCallNode>(expression), output);
+			return function_call(static_cast<FunctionCallNode*>(expression), frame, output);
+		case NodeType::INDEX:
+			return element_access(static_cast<IndexNode*>(expression), frame, output);
 		default:
+			m_values.push_back(nullptr);
 			return nullptr;
 		}
 	}
 
-	ptr<AIRValueNode> AIRGenerator::unary_operation(ptr<UnaryOperationNode> unary_op, AIRInstructionList& output) {
-		ptr<AIRValueNode> source = resolve_expression(unary_op->expression, output);
-		Name destination_name = make_temporary_name();
-		ptr<AIRVariableValueNode> destination = make_variable(destination_name);
+	ptr<AIRValueNode> AIRGenerator::pop_value() {
+		ptr<AIRValueNode> value = std::move(m_values.back());
+		m_values.pop_back();
+		return value;
+	}
+
+	ExpressionNode* AIRGenerator::unary_operation(UnaryOperationNode* unary_op, GenerationFrame& frame, AIRInstructionList& output) {
+		if (frame.stage++ == 0)
+			return unary_op->expression;
+
+		ptr<AIRValueNode> source = pop_value();
 		UnaryOperation operation;
 		switch (unary_op->operator_token.type) {
 		case MINUS:
@@ -414,69 +559,157 @@ namespace Anthem {
 			operation = UnaryOperation::NOT;
 			break;
 		default:
+			m_values.push_back(nullptr);
+			return nullptr;
+		}
+
+		if (std::optional<Constant> value = constant_of(source)) {
+			m_values.push_back(constant_value(fold_unary(operation, *value, type_of(unary_op))));
+			return nullptr;
+		}
+
+		ptr<AIRVariableValueNode> destination = make_temporary(type_of(unary_op));
+		if (operation == UnaryOperation::NOT && is_floating(source->type)) {
+			// There is no logical not of floating point values, they are compared to zero instead
+			output.push_back(std::make_shared<AIRBinaryInstructionNode>(BinaryOperation::EQUAL, source, floating(0.0, source->type), destination));
+			m_values.push_back(destination);
 			return nullptr;
 		}
+		if (operation != UnaryOperation::NOT)
+			source = convert(source, type_of(unary_op), output);
 		output.push_back(std::make_shared<AIRUnaryInstructionNode>(operation, source, destination));
-		return destination;
+		m_values.push_back(destination);
+		return nullptr;
 	}
 
-	ptr<AIRValueNode> AIRGenerator::binary_operation(ptr<BinaryOperationNode> binary_op, AIRInstructionList& output) {
+	ExpressionNode* AIRGenerator::binary_operation(BinaryOperationNode* binary_op, GenerationFrame& frame, AIRInstructionList& output) {
 		BinaryOperation operation = token_to_bin_op(binary_op->operator_token); 
 		if (operation == BinaryOperation::AND || operation == BinaryOperation::OR)
-			return logical_binary_operation(binary_op, output);
-		ptr<AIRValueNode> source_a = resolve_expression(binary_op->left_expression, output);
-		ptr<AIRValueNode> source_b = resolve_expression(binary_op->right_expression, output);
+			return logical_binary_operation(binary_op, frame, output);
+
+		switch (frame.stage++) {
+		case 0: return binary_op->left_expression;
+		case 1: return binary_op->right_expression;
+		default: break;
+		}
+		ptr<AIRValueNode> source_b = pop_value();
+		ptr<AIRValueNode> source_a = pop_value();
+
+		// Operations that trap at runtime are left to do so
+		std::optional<Constant> constant_a = constant_of(source_a);
+		std::optional<Constant> constant_b = constant_of(source_b);
+		if (constant_a && constant_b) {
+			if (std::optional<Constant> result = fold_binary(operation, *constant_a, *constant_b, type_of(binary_op))) {
+				m_values.push_back(constant_value(*result));
+				return nullptr;
+			}
+		}
+
+		// Both operands are brought to the same type, which is the type of the result unless the operation is a comparison
+		ReturnType operand_type = is_relational(operation) ? common_type(source_a->type, source_b->type) : type_of(binary_op);
+		source_a = convert(source_a, operand_type, output);
+		source_b = convert(source_b, operand_type, output);
 
-		Name destination_name = make_temporary_name();
-		ptr<AIRVariableValueNode> destination = make_variable(destination_name);
+		ptr<AIRVariableValueNode> destination = make_temporary(type_of(binary_op));
 
 		output.push_back(std::make_shared<AIRBinaryInstructionNode>(operation, source_a, source_b, destination));
-		return destination;
+		m_values.push_back(destination);
+		return nullptr;
 	}
 
-	ptr<AIRValueNode> AIRGenerator::assignment(ptr<AssignmentNode> assignment, AIRInstructionList& output) {
-		ptr<AIRValueNode> source = resolve_expression(assignment->expression, output);
-		ptr<AIRVariableValueNode> target = std::static_pointer_cast<AIRVariableValueNode>(resolve_expression(assignment->lvalue, output));
+	ExpressionNode* AIRGenerator::assignment(AssignmentNode* assignment, GenerationFrame& frame, AIRInstructionList& output) {
+		if (assignment->lvalue->get_type() == NodeType::INDEX)
+			return element_assignment(assignment, static_cast<IndexNode*>(assignment->lvalue), frame, output);
 
-		output.push_back(set(target, source));
-		return target;
-	}
+		switch (frame.stage++) {
+		case 0: return assignment->expression;
+		case 1: return assignment->lvalue;
+		default: break;
+		}
+		ptr<AIRVariableValueNode> target = std::static_pointer_cast<AIRVariableValueNode>(pop_value());
+		ptr<AIRValueNode> source = pop_value();
 
-	ptr<AIRValueNode> AIRGenerator::function_call(ptr<FunctionCallNode> func_call, AIRInstructionList& output) {
-		ValueList args;
-		for (auto& expr : func_call->argument_list) {
-			auto value = resolve_expression(expr, output);
-			auto var = make_variable(make_temporary_name());
-			output.push_back(set(var, value));
-			args.push_back(var);
+		// For compound assignments (e.g. +=) the operation is done in the common type of both sides
+		if (assignment->token.type != EQUAL) {
+			ReturnType operation_type = common_type(target->type, source->type);
+			ptr<AIRValueNode> source_a = convert(target, operation_type, output);
+			ptr<AIRValueNode> source_b = convert(source, operation_type, output);
+			ptr<AIRVariableValueNode> result = make_temporary(operation_type);
+			output.push_back(std::make_shared<AIRBinaryInstructionNode>(token_to_bin_op(assignment->token), source_a, source_b, result));
+			source = result;
 		}
-		auto result_var = make_variable("result");
-		output.push_back(call(func_call->variable_token.value, args, result_var, func_call->is_external));
-		return result_var;
+
+		assign(target, source, output);
+		m_values.push_back(target);
+		return nullptr;
 	}
 
-	ptr<AIRValueNode> AIRGenerator::logical_binary_operation(ptr<BinaryOperationNode> binary_op, AIRInstructionList& output) {
-		Name early_leave_label = std::format("early_leave.{0}", m_global_label_counter);
-		Name end_label = std::format("end.{0}", m_global_label_counter);
-		// Increment label counter in order to have unique identifiers
-		m_global_label_counter++;
+	ExpressionNode* AIRGenerator::function_call(FunctionCallNode* func_call, GenerationFrame& frame, AIRInstructionList& output) {
+		// The stage is the index of the next argument, the value of each resolved argument is copied to a temporary
+		// of the parameter type
+		size_t argument_count = func_call->argument_list.size();
+		if (frame.stage > 0) {
+			auto value = pop_value();
+			ReturnType type = value->type;
+			auto function = m_symbol_table->find(func_call->name);
+			if (function != m_symbol_table->end() && std::holds_alternative<FunctionType>(function->second)) {
+				auto& parameters = std::get<FunctionType>(function->second).parameters;
+				if (frame.stage - 1 < parameters.size())
+					type = parameters[frame.stage - 1];
+			}
+			auto var = make_temporary(type);
+			assign(var, value, output);
+			m_values.push_back(var);
+		}
+		if (frame.stage < argument_count)
+			return func_call->argument_list[frame.stage++];
+
+		// The temporaries of all arguments are the last values
+		ValueList args;
+		for (size_t i = m_values.size() - argument_count; i < m_values.size(); i++)
+			args.push_back(std::static_pointer_cast<AIRVariableValueNode>(m_values[i]));
+		m_values.resize(m_values.size() - argument_count);
+
+		auto result_var = make_temporary(type_of(func_call));
+		output.push_back(call(func_call->name, args, result_var, func_call->is_external));
+		m_values.push_back(result_var);
+		return nullptr;
+	}
 
+	ExpressionNode* AIRGenerator::logical_binary_operation(BinaryOperationNode* binary_op, GenerationFrame& frame, AIRInstructionList& output) {
 		// Set true to evaluate AND operation, false to evaluate OR operation
 		bool and_operation = true;
 
 		if (binary_op->operator_token.type == OR) and_operation = false;
 
-		BinaryOperation operation = BinaryOperation::AND;
-		// Resolve left expression
-		ptr<AIRValueNode> source_a = resolve_expression(binary_op->left_expression, output);
-		// If left expression is false (or true depending on the operation), short-circuit the operation, dont resolve right expression and jump to false/true label
-		if(and_operation)
-			output.push_back(jump_zero(source_a, early_leave_label));
-		else
-			output.push_back(jump_not_zero(source_a, early_leave_label));
+		switch (frame.stage++) {
+		case 0:
+			frame.first_label = { LabelKind::EARLY_LEAVE, m_global_label_counter };
+			frame.second_label = { LabelKind::END_LOGICAL, m_global_label_counter };
+			// Increment label counter in order to have unique identifiers
+			m_global_label_counter++;
+
+			// Resolve left expression
+			return binary_op->left_expression;
+		case 1: {
+			ptr<AIRValueNode> source_a = condition(pop_value(), output);
+			// If left expression is false (or true depending on the operation), short-circuit the operation, dont resolve right expression and jump to false/true label
+			if (and_operation)
+				output.push_back(jump_zero(source_a, frame.first_label));
+			else
+				output.push_back(jump_not_zero(source_a, frame.first_label));
 
-		// Resolve right expression
-		ptr<AIRValueNode> source_b = resolve_expression(binary_op->right_expression, output);
+			// Resolve right expression
+			return binary_op->right_expression;
+		}
+		default:
+			break;
+		}
+
+		LabelId early_leave_label = frame.first_label;
+		LabelId end_label = frame.second_label;
+
+		ptr<AIRValueNode> source_b = condition(pop_value(), output);
 		// If right expression is also false (or true depending on the operation) jump to false/true label
 		if (and_operation)
 			output.push_back(jump_zero(source_b, early_leave_label));
@@ -484,49 +717,321 @@ namespace Anthem {
 			output.push_back(jump_not_zero(source_b, early_leave_label));
 
 		// Return variable
-		Name destination_name = make_temporary_name();
-		ptr<AIRVariableValueNode> destination = make_variable(destination_name);
+		ptr<AIRVariableValueNode> destination = make_temporary(ReturnType::BOOL);
 
 		// If both sides evaluated to true (or false), set the return value to true (or false) and skip over the early_leave label instruction
 		if (and_operation)
-			output.push_back(set(destination, integer(1)));
+			output.push_back(set(destination, integer(1, ReturnType::BOOL)));
 		else
-			output.push_back(set(destination, integer(0)));
+			output.push_back(set(destination, integer(0, ReturnType::BOOL)));
 		output.push_back(jump(end_label));
 
 		// False label, set return value to false
 		output.push_back(label(early_leave_label));
 		if(and_operation)
-			output.push_back(set(destination, integer(0)));
+			output.push_back(set(destination, integer(0, ReturnType::BOOL)));
 		else
-			output.push_back(set(destination, integer(1)));
+			output.push_back(set(destination, integer(1, ReturnType::BOOL)));
 
 		output.push_back(label(end_label));
 
+		m_values.push_back(destination);
+		return nullptr;
+	}
+
+	ExpressionNode* AIRGenerator::element_access(IndexNode* index, GenerationFrame& frame, AIRInstructionList& output) {
+		if (frame.stage++ == 0)
+			return index->index;
+
+		ElementIndex element = element_index(index, pop_value(), output);
+		ptr<AIRVariableValueNode> destination = make_temporary(type_of(index));
+		add_element(element, std::make_shared<AIRLoadElementInstructionNode>(array_of(index), element.value, index->length, element.checked, destination), output);
+		m_values.push_back(destination);
+		return nullptr;
+	}
+
+	ExpressionNode* AIRGenerator::element_assignment(AssignmentNode* assignment, IndexNode* index, GenerationFrame& frame, AIRInstructionList& output) {
+		switch (frame.stage++) {
+		case 0: return assignment->expression;
+		case 1: return index->index;
+		default: break;
+		}
+		ElementIndex element = element_index(index, pop_value(), output);
+		ptr<AIRValueNode> source = pop_value();
+		ptr<AIRVariableValueNode> array = array_of(index);
+
+		// Compound assignments load the element and do the operation in the common type of both sides
+		if (assignment->token.type != EQUAL) {
+			ptr<AIRVariableValueNode> current = make_temporary(array->type);
+			add_element(element, std::make_shared<AIRLoadElementInstructionNode>(array, element.value, index->length, element.checked, current), output);
+
+			ReturnType operation_type = common_type(current->type, source->type);
+			ptr<AIRValueNode> source_a = convert(current, operation_type, output);
+			ptr<AIRValueNode> source_b = convert(source, operation_type, output);
+			ptr<AIRVariableValueNode> result = make_temporary(operation_type);
+			output.push_back(std::make_shared<AIRBinaryInstructionNode>(token_to_bin_op(assignment->token), source_a, source_b, result));
+			source = result;
+		}
+
+		// The stored value is the value of the assignment
+		ptr<AIRValueNode> value = convert(source, array->type, output);
+		add_element(element, std::make_shared<AIRStoreElementInstructionNode>(array, element.value, index->length, element.checked, value), output);
+		m_values.push_back(value);
+		return nullptr;
+	}
+
+	ptr<AIRVariableValueNode> AIRGenerator::array_of(IndexNode* index) {
+		return make_variable(index->array->id, index->array->name, type_of(index));
+	}
+
+	AIRGenerator::ElementIndex AIRGenerator::element_index(IndexNode* index, ptr<AIRValueNode> value, AIRInstructionList& output) {
+		ElementIndex element;
+		if (std::optional<Constant> constant = constant_of(value)) {
+			int64_t position = convert_constant(*constant, ReturnType::I64).integer;
+			if (position < 0 || position >= int64_t(index->length))
+				m_error_handler->report_error(Error{ std::format("Index {0} is out of bounds of array '{1}' of length {2}", position, index->array->identifier, index->length), index->bracket_token.position() });
+			element.checked = false;
+		}
+		else {
+			int64_t low = 0;
+			int64_t high = 0;
+			size_t range = induction_bounds(value, output, low, high);
+			if (range != NO_RANGE && low >= 0 && high < int64_t(index->length)) {
+				element.checked = false;
+				element.range = range;
+			}
+		}
+		element.value = convert(value, ReturnType::I64, output);
+		return element;
+	}
+
+	void AIRGenerator::add_element(const ElementIndex& index, ptr<AIRElementInstructionNode> element, AIRInstructionList& output) {
+		if (index.range != NO_RANGE)
+			m_induction_ranges[index.range].elements.push_back(element);
+		output.push_back(element);
+	}
+
+	// Whether <instruction> assigns the local variable <variable>
+	static bool writes_local(const ptr<AIRInstructionNode>& instruction, VarId variable) {
+		ptr<AIRValueNode> destination;
+		switch (instruction->get_type()) {
+		case AIRNodeType::UNARY_OPERATION:	destination = std::static_pointer_cast<AIRUnaryInstructionNode>(instruction)->destination; break;
+		case AIRNodeType::BINARY_OPERATION:	destination = std::static_pointer_cast<AIRBinaryInstructionNode>(instruction)->destination; break;
+		case AIRNodeType::SET:				destination = std::static_pointer_cast<AIRSetInstructionNode>(instruction)->variable; break;
+		case AIRNodeType::CONVERT:			destination = std::static_pointer_cast<AIRConvertInstructionNode>(instruction)->destination; break;
+		case AIRNodeType::CALL:				destination = std::static_pointer_cast<AIRFunctionCallNode>(instruction)->destination; break;
+		case AIRNodeType::LOAD_ELEMENT:		destination = std::static_pointer_cast<AIRLoadElementInstructionNode>(instruction)->destination; break;
+		default:							return false;
+		}
+		return destination->get_type() == AIRNodeType::VARIABLE && std::static_pointer_cast<AIRVariableValueNode>(destination)->local == variable;
+	}
+
+	// Whether <value> is an integer constant, whose value is stored in <integer>
+	static bool integer_constant(const ptr<AIRValueNode>& value, int64_t& integer) {
+		if (value->get_type() != AIRNodeType::INTEGER || value->type == ReturnType::BOOL)
+			return false;
+		integer = std::static_pointer_cast<AIRIntegerValueNode>(value)->integer;
+		return true;
+	}
+
+	// Whether <value> is a local variable of an integer type
+	static bool integer_local(const ptr<AIRValueNode>& value) {
+		return value->get_type() == AIRNodeType::VARIABLE && std::static_pointer_cast<AIRVariableValueNode>(value)->local.valid()
+			&& !is_floating(value->type) && value->type != ReturnType::BOOL;
+	}
+
+	void AIRGenerator::begin_induction_range(ForStatementNode* for_statement, size_t init_end, size_t condition_start, const ptr<AIRValueNode>& condition, const AIRInstructionList& output) {
+		// The condition has to end with 'i < K' or 'i <= K'
+		if (output.size() == condition_start || output.back()->get_type() != AIRNodeType::BINARY_OPERATION)
+			return;
+		auto comparison = std::static_pointer_cast<AIRBinaryInstructionNode>(output.back());
+		int64_t bound = 0;
+		if (comparison->destination != condition || !integer_local(comparison->source_a) || !integer_constant(comparison->source_b, bound)
+			|| (comparison->operation != BinaryOperation::LESS && comparison->operation != BinaryOperation::LESS_EQUAL))
+			return;
+		auto variable = std::static_pointer_cast<AIRVariableValueNode>(comparison->source_a);
+		for (size_t i = condition_start; i < output.size(); i++)
+			if (writes_local(output[i], variable->local))
+				return;
+
+		// and the init has to end with 'i = c'
+		if (init_end == 0 || output[init_end - 1]->get_type() != AIRNodeType::SET)
+			return;
+		auto init = std::static_pointer_cast<AIRSetInstructionNode>(output[init_end - 1]);
+		int64_t first = 0;
+		if (init->variable->local != variable->local || !integer_constant(init->value, first))
+			return;
+
+		if (comparison->operation == BinaryOperation::LESS && bound == INT64_MIN)
+			return;
+		int64_t last = (comparison->operation == BinaryOperation::LESS) ? bound - 1 : bound;
+		if (first > last)
+			return;
+		m_induction_ranges.push_back({ for_statement, variable->local, variable->type, first, last });
+	}
+
+	void AIRGenerator::end_induction_range(InductionRange& range, size_t post_start, const AIRInstructionList& output) {
+		// The post loop expression has to end with 'i = i + c', which is also what 'i += c' generates, with a positive step
+		// that can't make the variable wrap around
+		auto kept = [&]() {
+			if (output.size() < post_start + 2 || output.back()->get_type() != AIRNodeType::SET
+				|| output[output.size() - 2]->get_type() != AIRNodeType::BINARY_OPERATION)
+				return false;
+			auto set = std::static_pointer_cast<AIRSetInstructionNode>(output.back());
+			auto addition = std::static_pointer_cast<AIRBinaryInstructionNode>(output[output.size() - 2]);
+			if (set->variable->local != range.variable || set->value != addition->destination || addition->operation != BinaryOperation::ADDITION
+				|| addition->destination->type != range.type)
+				return false;
+
+			int64_t step = 0;
+			ptr<AIRValueNode> variable = addition->source_a;
+			if (!integer_constant(addition->source_b, step)) {
+				variable = addition->source_b;
+				if (!integer_constant(addition->source_a, step))
+					return false;
+			}
+			int64_t largest = (range.type == ReturnType::I64) ? INT64_MAX : (int64_t(1) << (type_size(range.type) * 8 - 1)) - 1;
+			if (!integer_local(variable) || std::static_pointer_cast<AIRVariableValueNode>(variable)->local != range.variable
+				|| step <= 0 || step > largest - range.max)
+				return false;
+
+			for (size_t i = post_start; i < output.size() - 1; i++)
+				if (writes_local(output[i], range.variable))
+					return false;
+			for (size_t i = range.body_start; i < post_start; i++)
+				if (writes_local(output[i], range.variable))
+					return false;
+			return true;
+		};
+		if (kept())
+			return;
+		for (auto& element : range.elements)
+			element->checked = true;
+	}
+
+	size_t AIRGenerator::induction_bounds(const ptr<AIRValueNode>& value, const AIRInstructionList& output, int64_t& low, int64_t& high) const {
+		// The value is the variable itself or the last instruction adds a constant to it or subtracts one from it
+		ptr<AIRValueNode> variable = value;
+		int64_t offset = 0;
+		if (!integer_local(value)) {
+			if (output.empty() || output.back()->get_type() != AIRNodeType::BINARY_OPERATION)
+				return NO_RANGE;
+			auto binary = std::static_pointer_cast<AIRBinaryInstructionNode>(output.back());
+			if (binary->destination != value)
+				return NO_RANGE;
+			variable = binary->source_a;
+			if (binary->operation == BinaryOperation::ADDITION && !integer_constant(binary->source_b, offset)) {
+				variable = binary->source_b;
+				if (!integer_constant(binary->source_a, offset))
+					return NO_RANGE;
+			}
+			else if (binary->operation == BinaryOperation::SUBTRACTION) {
+				if (!integer_constant(binary->source_b, offset) || offset == INT64_MIN)
+					return NO_RANGE;
+				offset = -offset;
+			}
+			else if (binary->operation != BinaryOperation::ADDITION)
+				return NO_RANGE;
+			if (!integer_local(variable))
+				return NO_RANGE;
+		}
+
+		VarId local = std::static_pointer_cast<AIRVariableValueNode>(variable)->local;
+		for (size_t i = m_induction_ranges.size(); i-- > 0;) {
+			const InductionRange& range = m_induction_ranges[i];
+			if (range.variable != local)
+				continue;
+
+			// The bounds have to be exact, in 64 bits and in the type the offset is added in
+			if ((offset > 0 && range.max > INT64_MAX - offset) || (offset < 0 && range.min < INT64_MIN - offset))
+				return NO_RANGE;
+			low = range.min + offset;
+			high = range.max + offset;
+			if (wrap_integer(low, value->type) != low || wrap_integer(high, value->type) != high)
+				return NO_RANGE;
+			return i;
+		}
+		return NO_RANGE;
+	}
+
+	ptr<AIRValueNode> AIRGenerator::convert(ptr<AIRValueNode> value, ReturnType type, AIRInstructionList& output) {
+		if (value->type == type)
+			return value;
+
+		if (std::optional<Constant> constant = constant_of(value))
+			return constant_value(convert_constant(*constant, type));
+
+		// A value is true if it is not zero
+		if (type == ReturnType::BOOL) {
+			ptr<AIRVariableValueNode> destination = make_temporary(type);
+			ptr<AIRValueNode> zero = is_floating(value->type) ? ptr<AIRValueNode>(floating(0.0, value->type)) : integer(0, value->type);
+			output.push_back(std::make_shared<AIRBinaryInstructionNode>(BinaryOperation::NOT_EQUAL, value, zero, destination));
+			return destination;
+		}
+
+		ptr<AIRVariableValueNode> destination = make_temporary(type);
+		output.push_back(std::make_shared<AIRConvertInstructionNode>(value, destination));
 		return destination;
 	}
 
-	ptr<AIRIntegerValueNode> AIRGenerator::integer(int integer) {
-		return std::make_shared<AIRIntegerValueNode>(integer);
+	void AIRGenerator::assign(ptr<AIRVariableValueNode> target, ptr<AIRValueNode> value, AIRInstructionList& output) {
+		// Values that need an instruction to be converted are converted directly into the target
+		bool direct = value->type != target->type && target->type != ReturnType::BOOL
+			&& value->get_type() != AIRNodeType::INTEGER && value->get_type() != AIRNodeType::FLOAT;
+		if (direct)
+			output.push_back(std::make_shared<AIRConvertInstructionNode>(value, target));
+		else
+			output.push_back(set(target, convert(value, target->type, output)));
+	}
+
+	ptr<AIRValueNode> AIRGenerator::condition(ptr<AIRValueNode> value, AIRInstructionList& output) {
+		if (is_floating(value->type))
+			return convert(value, ReturnType::BOOL, output);
+		return value;
+	}
+
+	std::optional<Constant> AIRGenerator::constant_of(const ptr<AIRValueNode>& value) const {
+		switch (value->get_type()) {
+		case AIRNodeType::INTEGER:
+			return Constant{ value->type, std::static_pointer_cast<AIRIntegerValueNode>(value)->integer };
+		case AIRNodeType::FLOAT:
+			return Constant{ value->type, 0, std::static_pointer_cast<AIRFloatValueNode>(value)->floating };
+		default:
+			return std::nullopt;
+		}
+	}
+
+	ptr<AIRValueNode> AIRGenerator::constant_value(const Constant& constant) {
+		if (is_floating(constant.type))
+			return floating(constant.floating, constant.type);
+		return integer(constant.integer, constant.type);
+	}
+
+	ptr<AIRIntegerValueNode> AIRGenerator::integer(int64_t integer, ReturnType type) {
+		return std::make_shared<AIRIntegerValueNode>(integer, type);
+	}
+
+	ptr<AIRFloatValueNode> AIRGenerator::floating(double floating, ReturnType type) {
+		return std::make_shared<AIRFloatValueNode>(floating, type);
 	}
 
 	ptr<AIRSetInstructionNode> AIRGenerator::set(ptr<AIRVariableValueNode> variable, ptr<AIRValueNode> value) {
 		return std::make_shared<AIRSetInstructionNode>(variable, value);
 	}
 
-	ptr<AIRLabelNode> AIRGenerator::label(const Name& name) {
+	ptr<AIRLabelNode> AIRGenerator::label(LabelId name) {
 		return std::make_shared<AIRLabelNode>(name);
 	}
 
-	ptr<AIRJumpInstructionNode> AIRGenerator::jump(const Name& label) {
+	ptr<AIRJumpInstructionNode> AIRGenerator::jump(LabelId label) {
 		return std::make_shared<AIRJumpInstructionNode>(label);
 	}
 
-	ptr<AIRJumpIfNotZeroInstructionNode> AIRGenerator::jump_not_zero(ptr<AIRValueNode> condition, const Name& label) {
+	ptr<AIRJumpIfNotZeroInstructionNode> AIRGenerator::jump_not_zero(ptr<AIRValueNode> condition, LabelId label) {
 		return std::make_shared<AIRJumpIfNotZeroInstructionNode>(condition, label);
 	}
 
-	ptr<AIRJumpIfZeroInstructionNode> AIRGenerator::jump_zero(ptr<AIRValueNode> condition, const Name& label) {
+	ptr<AIRJumpIfZeroInstructionNode> AIRGenerator::jump_zero(ptr<AIRValueNode> condition, LabelId label) {
 		return std::make_shared<AIRJumpIfZeroInstructionNode>(condition, label);
 	}
 
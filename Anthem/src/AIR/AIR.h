@@ -5,66 +5,189 @@
 #pragma once
 #include "Parser/Parser.h"
 #include "AIRConstructs.h"
+#include "AIRInterpreter.h"
 
 namespace Anthem {
 	class AIRGenerator {
 	public:
 		AIRGenerator(ErrorHandler* error_handler);
 
-		// Generate an AIR Program Tree from parser AST
-		ptr<AIRProgramNode> generate(ptr<ProgramNode> program, SymbolTable& symbol_table);
+		// Generate an AIR Program Tree from parser AST, typed by the results of the TypeChecker
+		ptr<AIRProgramNode> generate(ProgramNode* program, SymbolTable& symbol_table, const ExpressionTypes& expression_types);
 		std::vector<ptr<AIRFlaggedVarNode>>& get_extra_definitions() { return m_extra_definitions; }
 
 		static void pretty_print(ptr<AIRNode> program_node);
 	private:
-		Name make_temporary_name();
-		ptr<AIRVariableValueNode> make_variable(Name name);
+		// Make a new temporary of the current function
+		ptr<AIRVariableValueNode> make_temporary(ReturnType type);
+
+		// Labels of loops are numbered by the loop id, so break and continue statements can refer to them
+		static LabelId loop_label(LabelKind kind, uint64_t loop_id);
+
+		// A local variable if <id> is valid, otherwise a variable of the whole program named <name>
+		ptr<AIRVariableValueNode> make_variable(VarId id, const Name& name, ReturnType type);
 
 		// Create AIR Program from parser AST Program Node
-		ptr<AIRProgramNode> generate_program(ptr<ProgramNode> program_node);
+		ptr<AIRProgramNode> generate_program(ProgramNode* program_node);
 
 		// Create an AIR Declaration (Function or Global Variable) Node from AST Declaration Node
-		ptr<AIRDeclarationNode> generate_declaration(ptr<DeclarationNode> declaration_node, AIRInstructionList* output_optional = nullptr);
+		ptr<AIRDeclarationNode> generate_declaration(DeclarationNode* declaration_node, AIRInstructionList* output_optional = nullptr);
 
 		// -- Declaration Generation --
 
-		ptr<AIRFunctionNode> generate_function_declaration(ptr<FunctionDeclarationNode> function_node);
+		ptr<AIRFunctionNode> generate_function_declaration(FunctionDeclarationNode* function_node);
+
+		// Evaluate the initializers that call constant functions, once all functions are generated
+		void evaluate_initializers(ptr<AIRProgramNode> program);
 
 		// -- Statement Generation --
 
-		void generate_statement(ptr<StatementNode> statement_node, AIRInstructionList& output);
-		void generate_return(ptr<ReturnStatementNode> return_node, AIRInstructionList& output);
-		void generate_block(ptr<BlockStatementNode> block_statement, AIRInstructionList& output);
-		void generate_if(ptr<IfStatementNode> if_statement, AIRInstructionList& output);
-		void generate_loop(ptr<LoopStatementNode> loop_statement, AIRInstructionList& output);
-		void generate_while(ptr<WhileStatementNode> while_statement, AIRInstructionList& output);
-		void generate_for(ptr<ForStatementNode> for_statement, AIRInstructionList& output);
-		void generate_break(ptr<BreakStatementNode> break_statement, AIRInstructionList& output);
-		void generate_continue(ptr<ContinueStatementNode> continue_statement, AIRInstructionList& output);
+		// A statement or expression whose nested statements or operands are still being generated
+		struct GenerationFrame {
+			ASTNode* node{ nullptr };
+
+			// How far the generation of the node got, its meaning depends on the node
+			uint32_t stage{ 0 };
+
+			// Labels of ifs, loops and logical operations
+			LabelId first_label;
+			LabelId second_label;
+		};
+
+		void generate_statement(StatementNode* statement_node, AIRInstructionList& output);
+
+		// Generate the next part of a statement, returns the nested statement to generate before the statement is continued
+		// or nullptr once it is finished
+		StatementNode* continue_statement(GenerationFrame& frame, AIRInstructionList& output);
+
+		void generate_return(ReturnStatementNode* return_node, AIRInstructionList& output);
+		StatementNode* generate_block(BlockStatementNode* block_statement, GenerationFrame& frame, AIRInstructionList& output);
+		StatementNode* generate_if(IfStatementNode* if_statement, GenerationFrame& frame, AIRInstructionList& output);
+		StatementNode* generate_loop(LoopStatementNode* loop_statement, GenerationFrame& frame, AIRInstructionList& output);
+		StatementNode* generate_while(WhileStatementNode* while_statement, GenerationFrame& frame, AIRInstructionList& output);
+		StatementNode* generate_for(ForStatementNode* for_statement, GenerationFrame& frame, AIRInstructionList& output);
+		void generate_break(BreakStatementNode* break_statement, AIRInstructionList& output);
+		void generate_continue(ContinueStatementNode* continue_statement, AIRInstructionList& output);
 
 		// -- Expression Resolution and Instruction Generation --
 
-		ptr<AIRValueNode> resolve_expression(ptr<ExpressionNode> expression, AIRInstructionList& output);
-		ptr<AIRValueNode> unary_operation(ptr<UnaryOperationNode> unary_op, AIRInstructionList& output);
-		ptr<AIRValueNode> binary_operation(ptr<BinaryOperationNode> binary_op, AIRInstructionList& output);
-		ptr<AIRValueNode> assignment(ptr<AssignmentNode> binary_op, AIRInstructionList& output);
-		ptr<AIRValueNode> function_call(ptr<FunctionCallNode> func_call, AIRInstructionList& output);
-		ptr<AIRValueNode> logical_binary_operation(ptr<BinaryOperationNode> binary_op, AIRInstructionList& output);
+		ptr<AIRValueNode> resolve_expression(ExpressionNode* expression, AIRInstructionList& output);
+
+		// Generate the next part of an expression, returns the operand to resolve before the expression is continued
+		// or nullptr once it is finished and its value was pushed to the value stack
+		ExpressionNode* continue_expression(GenerationFrame& frame, AIRInstructionList& output);
+		ptr<AIRValueNode> pop_value();
+
+		ExpressionNode* unary_operation(UnaryOperationNode* unary_op, GenerationFrame& frame, AIRInstructionList& output);
+		ExpressionNode* binary_operation(BinaryOperationNode* binary_op, GenerationFrame& frame, AIRInstructionList& output);
+		ExpressionNode* assignment(AssignmentNode* binary_op, GenerationFrame& frame, AIRInstructionList& output);
+		ExpressionNode* function_call(FunctionCallNode* func_call, GenerationFrame& frame, AIRInstructionList& output);
+		ExpressionNode* logical_binary_operation(BinaryOperationNode* binary_op, GenerationFrame& frame, AIRInstructionList& output);
+
+		// -- Arrays --
+
+		static constexpr size_t NO_RANGE = SIZE_MAX;
+
+		// Index of an element access as an i64 value, and whether it has to be checked against the length of the array
+		struct ElementIndex {
+			ptr<AIRValueNode> value;
+			bool checked{ true };
+
+			// The induction range that proves the index to be in bounds, if one does
+			size_t range{ NO_RANGE };
+		};
+
+		ExpressionNode* element_access(IndexNode* index, GenerationFrame& frame, AIRInstructionList& output);
+		ExpressionNode* element_assignment(AssignmentNode* assignment, IndexNode* index, GenerationFrame& frame, AIRInstructionList& output);
+
+		// The array an element access reads or writes
+		ptr<AIRVariableValueNode> array_of(IndexNode* index);
+
+		// <value> of the index expression of <index> as an element index, constant indices out of bounds are errors
+		ElementIndex element_index(IndexNode* index, ptr<AIRValueNode> value, AIRInstructionList& output);
+
+		// Add a load or store of an element to the output, and to the induction range it relies on
+		void add_element(const ElementIndex& index, ptr<AIRElementInstructionNode> element, AIRInstructionList& output);
+
+		// -- Range Analysis --
+
+		// In the body of a for loop like 'for i = 0; i < 10; i += 1', the induction variable stays in [min, max] as long as only the
+		// post loop expression assigns it. The range is started once the condition is generated and checked once the loop is done
+		struct InductionRange {
+			ForStatementNode* loop{ nullptr };
+			VarId variable;
+			ReturnType type{ ReturnType::I32 };
+			int64_t min{ 0 };
+			int64_t max{ 0 };
+
+			// Index of the first instruction of the body
+			size_t body_start{ 0 };
+
+			// Element accesses left unchecked because of the range, they are checked again if the loop does not keep it
+			std::vector<ptr<AIRElementInstructionNode>> elements{};
+		};
+
+		// Start the range of <for_statement> if the last instruction of its init sets a local to a constant and its condition
+		// compares that local to a constant, <condition> is the value of the condition
+		void begin_induction_range(ForStatementNode* for_statement, size_t init_end, size_t condition_start, const ptr<AIRValueNode>& condition, const AIRInstructionList& output);
+
+		// Finish the range of <for_statement> once its post loop expression is generated, it is kept if the body does not
+		// assign the variable and the post loop expression only adds a positive constant to it
+		void end_induction_range(InductionRange& range, size_t post_start, const AIRInstructionList& output);
+
+		// Values <value> can take if it is an induction variable, or one plus or minus a constant computed by the last instruction.
+		// Returns the index of the range or NO_RANGE
+		size_t induction_bounds(const ptr<AIRValueNode>& value, const AIRInstructionList& output, int64_t& low, int64_t& high) const;
+
+		// -- Conversions --
+
+		// Type the TypeChecker gave to <expression>
+		ReturnType type_of(ExpressionNode* expression) const { return (*m_expression_types)[expression->expression_id]; }
+
+		// <value> as a value of <type>, constants are converted directly and other values through a new temporary
+		ptr<AIRValueNode> convert(ptr<AIRValueNode> value, ReturnType type, AIRInstructionList& output);
+
+		// Store <value> to <target>, converting it to the type of the target
+		void assign(ptr<AIRVariableValueNode> target, ptr<AIRValueNode> value, AIRInstructionList& output);
+
+		// <value> as the condition of a jump, floating point values are compared to zero first
+		ptr<AIRValueNode> condition(ptr<AIRValueNode> value, AIRInstructionList& output);
+
+		// The value of a constant operand, operations whose operands are all constant are folded instead of generated
+		std::optional<Constant> constant_of(const ptr<AIRValueNode>& value) const;
+		ptr<AIRValueNode> constant_value(const Constant& constant);
 
 		// -- AIR Instruction Creation --
 
-		ptr<AIRIntegerValueNode> integer(int integer);
+		ptr<AIRIntegerValueNode> integer(int64_t integer, ReturnType type = ReturnType::I32);
+		ptr<AIRFloatValueNode> floating(double floating, ReturnType type);
 		ptr<AIRSetInstructionNode> set(ptr<AIRVariableValueNode> variable, ptr<AIRValueNode> value);
-		ptr<AIRLabelNode> label(const Name& name);
-		ptr<AIRJumpInstructionNode> jump(const Name& label);
-		ptr<AIRJumpIfNotZeroInstructionNode> jump_not_zero(ptr<AIRValueNode> condition, const Name& label);
-		ptr<AIRJumpIfZeroInstructionNode> jump_zero(ptr<AIRValueNode> condition, const Name& label);
+		ptr<AIRLabelNode> label(LabelId name);
+		ptr<AIRJumpInstructionNode> jump(LabelId label);
+		ptr<AIRJumpIfNotZeroInstructionNode> jump_not_zero(ptr<AIRValueNode> condition, LabelId label);
+		ptr<AIRJumpIfZeroInstructionNode> jump_zero(ptr<AIRValueNode> condition, LabelId label);
 		ptr<AIRFunctionCallNode> call(const Name& function, const ValueList& value_list, ptr<AIRValueNode> destination, bool is_external = false);
 	private:
 		uint32_t m_global_label_counter{ 0 };
 		ErrorHandler* m_error_handler{ nullptr };
-		int m_temp_counter{ 0 };
+		SymbolTable* m_symbol_table{ nullptr };
+		const ExpressionTypes* m_expression_types{ nullptr };
+		uint32_t m_temp_counter{ 0 };
+
+		// Return type of the function being generated
+		ReturnType m_return_type{ ReturnType::I32 };
 
 		std::vector<ptr<AIRFlaggedVarNode>> m_extra_definitions;
+
+		// Variables whose initializer calls constant functions
+		std::vector<VariableNode*> m_evaluated_variables;
+
+		// Induction ranges of the enclosing for loops
+		std::vector<InductionRange> m_induction_ranges;
+
+		// Explicit stacks replacing recursion over nested statements and expressions, with the values of resolved operands
+		std::vector<GenerationFrame> m_statement_stack;
+		std::vector<GenerationFrame> m_expression_stack;
+		std::vector<ptr<AIRValueNode>> m_values;
 	};
 }
\ No newline at end of file
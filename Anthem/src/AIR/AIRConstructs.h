@@ -10,8 +10,6 @@ namespace Anthem {
 	// Macro to simplify basic setup for all node classes
 #define AIR_NODE_TYPE(x) AIRNodeType get_type() const override { return AIRNodeType::x; }
 
-	using Name = std::string;
-
 	enum class AIRNodeType {
 		INSTRUCTION,
 		VALUE,
@@ -28,8 +26,12 @@ namespace Anthem {
 		JUMP_IF_ZERO,
 		JUMP_IF_NOT_ZERO,
 		SET,
+		CONVERT,
+		LOAD_ELEMENT,
+		STORE_ELEMENT,
 		LABEL,
 		INTEGER,
+		FLOAT,
 		VARIABLE,
 		RETURN,
 		CALL
@@ -55,7 +57,11 @@ namespace Anthem {
 
 	class AIRValueNode : public AIRNode {
 	public:
+		AIRValueNode(ReturnType type) : type{ type } {}
+
 		AIR_NODE_TYPE(VALUE)
+	public:
+		ReturnType type;
 	};
 
 	using AIRDeclarationList = std::vector<ptr<AIRDeclarationNode>>;
@@ -82,7 +88,8 @@ namespace Anthem {
 		AIR_NODE_TYPE(FUNCTION)
 	public:
 		Name name;
-		std::vector<Name> parameters;
+		std::vector<ptr<class AIRVariableValueNode>> parameters;
+		ReturnType return_type{ ReturnType::I32 };
 		VarFlag flag;
 		AIRInstructionList instructions;
 	};
@@ -90,35 +97,57 @@ namespace Anthem {
 	class AIRFlaggedVarNode : public AIRDeclarationNode {
 	public:
 		AIRFlaggedVarNode() = default;
-		AIRFlaggedVarNode(const Name& name, VarFlag flag, int initializer)
-			: name{ name }, flag{ flag }, initializer{ initializer } {}
+		AIRFlaggedVarNode(const Name& name, VarFlag flag, ReturnType type, int64_t initializer, uint32_t array_length = 0)
+			: name{ name }, flag{ flag }, type{ type }, initializer{ initializer }, array_length{ array_length } {}
 
 		AIR_NODE_TYPE(FLAGGED_VAR)
 	public:
 		Name name;
 		VarFlag flag;
-		int initializer;
+		ReturnType type;
+
+		// Initial value, floating point values are stored as their bit pattern
+		int64_t initializer;
+
+		// Number of elements if the variable is an array (whose elements start as zeros), 0 otherwise
+		uint32_t array_length;
 	};
 
 	// Operand Nodes
 
+	// Constant of an integer type or bool
 	class AIRIntegerValueNode : public AIRValueNode {
 	public:
-		AIRIntegerValueNode(int number) : integer{ number } {}
+		AIRIntegerValueNode(int64_t number, ReturnType type = ReturnType::I32) : AIRValueNode{ type }, integer{ number } {}
 
 		AIR_NODE_TYPE(INTEGER)
 	public:
-		int integer;
+		int64_t integer;
+	};
+
+	// Constant of a floating point type
+	class AIRFloatValueNode : public AIRValueNode {
+	public:
+		AIRFloatValueNode(double number, ReturnType type = ReturnType::F64) : AIRValueNode{ type }, floating{ number } {}
+
+		AIR_NODE_TYPE(FLOAT)
+	public:
+		double floating;
 	};
 
+	// A local variable, a temporary, or a flagged variable defined once for the whole program, only one of them is set
 	class AIRVariableValueNode : public AIRValueNode {
 	public:
-		AIRVariableValueNode(const Name& variable, bool flagged = false) : variable{ variable }, flagged{ flagged } {}
+		AIRVariableValueNode(VarId local, ReturnType type) : AIRValueNode{ type }, local{ local } {}
+		AIRVariableValueNode(TempId temporary, ReturnType type) : AIRValueNode{ type }, temporary{ temporary } {}
+		AIRVariableValueNode(const Name& name, ReturnType type) : AIRValueNode{ type }, name{ name }, flagged{ true } {}
 
 		AIR_NODE_TYPE(VARIABLE)
 	public:
-		Name variable;
-		bool flagged;
+		VarId local;
+		TempId temporary;
+		Name name;
+		bool flagged{ false };
 	};
 
 	// Instruction Nodes
@@ -159,42 +188,42 @@ namespace Anthem {
 
 	class AIRJumpInstructionNode : public AIRInstructionNode {
 	public:
-		AIRJumpInstructionNode(const Name& label) : label{ label } {}
+		AIRJumpInstructionNode(LabelId label) : label{ label } {}
 
 		AIR_NODE_TYPE(JUMP)
 	public:
-		Name label;
+		LabelId label;
 	};
 
 	class AIRJumpIfZeroInstructionNode : public AIRInstructionNode {
 	public:
-		AIRJumpIfZeroInstructionNode(ptr<AIRValueNode> condition, const Name& label)
+		AIRJumpIfZeroInstructionNode(ptr<AIRValueNode> condition, LabelId label)
 			: label{ label }, condition{ condition } {}
 
 		AIR_NODE_TYPE(JUMP_IF_ZERO)
 	public:
-		Name label;
+		LabelId label;
 		ptr<AIRValueNode> condition;
 	};
 
 	class AIRJumpIfNotZeroInstructionNode : public AIRInstructionNode {
 	public:
-		AIRJumpIfNotZeroInstructionNode(ptr<AIRValueNode> condition, const Name& label)
+		AIRJumpIfNotZeroInstructionNode(ptr<AIRValueNode> condition, LabelId label)
 			: label{ label }, condition{ condition } {}
 
 		AIR_NODE_TYPE(JUMP_IF_NOT_ZERO)
 	public:
-		Name label;
+		LabelId label;
 		ptr<AIRValueNode> condition;
 	};
 
 	class AIRLabelNode : public AIRInstructionNode {
 	public:
-		AIRLabelNode(const Name& label) : label{ label } {}
+		AIRLabelNode(LabelId label) : label{ label } {}
 
 		AIR_NODE_TYPE(LABEL)
 	public:
-		Name label;
+		LabelId label;
 	};
 
 	class AIRSetInstructionNode : public AIRInstructionNode {
@@ -208,6 +237,55 @@ namespace Anthem {
 		ptr<AIRValueNode> value;
 	};
 
+	// Convert a value to the type of the destination
+	class AIRConvertInstructionNode : public AIRInstructionNode {
+	public:
+		AIRConvertInstructionNode(ptr<AIRValueNode> source, ptr<AIRVariableValueNode> destination)
+			: source{ source }, destination{ destination } {}
+
+		AIR_NODE_TYPE(CONVERT)
+	public:
+		ptr<AIRValueNode> source;
+		ptr<AIRVariableValueNode> destination;
+	};
+
+	// Access to an element of an array, the array is a variable of the element type that takes <length> elements
+	class AIRElementInstructionNode : public AIRInstructionNode {
+	public:
+		AIRElementInstructionNode(ptr<AIRVariableValueNode> array, ptr<AIRValueNode> index, uint32_t length, bool checked)
+			: array{ array }, index{ index }, length{ length }, checked{ checked } {}
+	public:
+		ptr<AIRVariableValueNode> array;
+
+		// An i64 value
+		ptr<AIRValueNode> index;
+		uint32_t length;
+
+		// Whether the index has to be checked against the length, it is not if it was proven to be in range
+		bool checked;
+	};
+
+	class AIRLoadElementInstructionNode : public AIRElementInstructionNode {
+	public:
+		AIRLoadElementInstructionNode(ptr<AIRVariableValueNode> array, ptr<AIRValueNode> index, uint32_t length, bool checked, ptr<AIRVariableValueNode> destination)
+			: AIRElementInstructionNode{ array, index, length, checked }, destination{ destination } {}
+
+		AIR_NODE_TYPE(LOAD_ELEMENT)
+	public:
+		ptr<AIRVariableValueNode> destination;
+	};
+
+	// Store a value of the element type
+	class AIRStoreElementInstructionNode : public AIRElementInstructionNode {
+	public:
+		AIRStoreElementInstructionNode(ptr<AIRVariableValueNode> array, ptr<AIRValueNode> index, uint32_t length, bool checked, ptr<AIRValueNode> value)
+			: AIRElementInstructionNode{ array, index, length, checked }, value{ value } {}
+
+		AIR_NODE_TYPE(STORE_ELEMENT)
+	public:
+		ptr<AIRValueNode> value;
+	};
+
 	using ValueList = std::vector<ptr<AIRVariableValueNode>>;
 
 	class AIRFunctionCallNode : public AIRInstructionNode {
@@ -0,0 +1,285 @@
+// AIRInterpreter.cpp
+// Contains the AIRInterpreter Class method implementations
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#include "AIRInterpreter.h"
+
+namespace Anthem {
+	AIRInterpreter::AIRInterpreter(ErrorHandler* error_handler, uint64_t step_budget)
+		: m_error_handler{ error_handler }, m_step_budget{ step_budget } {}
+
+	void AIRInterpreter::add_function(ptr<AIRFunctionNode> function) {
+		m_function_indices[function->name] = static_cast<uint32_t>(m_functions.size());
+		m_functions.push_back({ function });
+	}
+
+	uint32_t AIRInterpreter::function_index(const Name& name) {
+		auto index = m_function_indices.find(name);
+		return index == m_function_indices.end() ? NO_SLOT : index->second;
+	}
+
+	void AIRInterpreter::report_error(const std::string& message) {
+		m_error_handler->report_error(Error{ std::format("Could not evaluate '{0}' at compile time: {1}", m_evaluated.view(), message), m_evaluated_position });
+	}
+
+	void AIRInterpreter::prepare(PreparedFunction& function) {
+		function.prepared = true;
+
+		// Locals and temporaries get the slots of the frame in the order they are first used
+		std::unordered_map<VarId, uint32_t> local_slots;
+		std::unordered_map<TempId, uint32_t> temporary_slots;
+		// Arrays take <count> consecutive slots
+		auto slot = [&](const ptr<AIRVariableValueNode>& variable, uint32_t count = 1) -> uint32_t {
+			if (variable->flagged) {
+				if (function.error.empty())
+					function.error = std::format("'{0}' accesses global variable '{1}'", function.node->name.view(), variable->name.view());
+				return 0;
+			}
+			uint32_t& entry = variable->local.valid() ? local_slots.try_emplace(variable->local, NO_SLOT).first->second
+				: temporary_slots.try_emplace(variable->temporary, NO_SLOT).first->second;
+			if (entry == NO_SLOT) {
+				if (function.slot_count + uint64_t(count) > MAX_SLOTS) {
+					if (function.error.empty())
+						function.error = std::format("'{0}' uses more than {1} variables and array elements", function.node->name.view(), MAX_SLOTS);
+					return 0;
+				}
+				entry = function.slot_count;
+				function.slot_count += count;
+			}
+			return entry;
+		};
+		auto operand = [&](const ptr<AIRValueNode>& value) -> Operand {
+			switch (value->get_type()) {
+			case AIRNodeType::INTEGER:
+				return { NO_SLOT, Constant{ value->type, std::static_pointer_cast<AIRIntegerValueNode>(value)->integer } };
+			case AIRNodeType::FLOAT:
+				return { NO_SLOT, Constant{ value->type, 0, std::static_pointer_cast<AIRFloatValueNode>(value)->floating } };
+			default:
+				return { slot(std::static_pointer_cast<AIRVariableValueNode>(value)) };
+			}
+		};
+
+		for (auto& parameter : function.node->parameters)
+			function.parameter_slots.push_back(slot(parameter));
+
+		// Labels are dropped, jumps go to the index of the operation after their label
+		auto label_key = [](const LabelId& label) { return (uint64_t(label.kind) << 32) | label.number; };
+		std::unordered_map<uint64_t, uint32_t> label_indices;
+		std::vector<std::pair<uint32_t, LabelId>> jumps;
+
+		for (auto& instruction : function.node->instructions) {
+			Operation operation{ instruction->get_type() };
+			switch (instruction->get_type()) {
+			case AIRNodeType::LABEL:
+				label_indices[label_key(std::static_pointer_cast<AIRLabelNode>(instruction)->label)] = static_cast<uint32_t>(function.operations.size());
+				continue;
+			case AIRNodeType::UNARY_OPERATION: {
+				auto unary = std::static_pointer_cast<AIRUnaryInstructionNode>(instruction);
+				operation.unary = unary->operation;
+				operation.a = operand(unary->source);
+				operation.destination = slot(unary->destination);
+				operation.type = unary->destination->type;
+				break;
+			}
+			case AIRNodeType::BINARY_OPERATION: {
+				auto binary = std::static_pointer_cast<AIRBinaryInstructionNode>(instruction);
+				operation.binary = binary->operation;
+				operation.a = operand(binary->source_a);
+				operation.b = operand(binary->source_b);
+				operation.destination = slot(binary->destination);
+				operation.type = binary->destination->type;
+				break;
+			}
+			case AIRNodeType::SET: {
+				auto set = std::static_pointer_cast<AIRSetInstructionNode>(instruction);
+				operation.a = operand(set->value);
+				operation.destination = slot(set->variable);
+				operation.type = set->variable->type;
+				break;
+			}
+			case AIRNodeType::CONVERT: {
+				auto convert = std::static_pointer_cast<AIRConvertInstructionNode>(instruction);
+				operation.a = operand(convert->source);
+				operation.destination = slot(convert->destination);
+				operation.type = convert->destination->type;
+				break;
+			}
+			case AIRNodeType::LOAD_ELEMENT: {
+				auto load = std::static_pointer_cast<AIRLoadElementInstructionNode>(instruction);
+				operation.array = slot(load->array, load->length);
+				operation.length = load->length;
+				operation.a = operand(load->index);
+				operation.destination = slot(load->destination);
+				operation.type = load->destination->type;
+				break;
+			}
+			case AIRNodeType::STORE_ELEMENT: {
+				auto store = std::static_pointer_cast<AIRStoreElementInstructionNode>(instruction);
+				operation.array = slot(store->array, store->length);
+				operation.length = store->length;
+				operation.a = operand(store->index);
+				operation.b = operand(store->value);
+				operation.type = store->array->type;
+				break;
+			}
+			case AIRNodeType::JUMP:
+				jumps.push_back({ static_cast<uint32_t>(function.operations.size()), std::static_pointer_cast<AIRJumpInstructionNode>(instruction)->label });
+				break;
+			case AIRNodeType::JUMP_IF_ZERO: {
+				auto jump = std::static_pointer_cast<AIRJumpIfZeroInstructionNode>(instruction);
+				operation.a = operand(jump->condition);
+				jumps.push_back({ static_cast<uint32_t>(function.operations.size()), jump->label });
+				break;
+			}
+			case AIRNodeType::JUMP_IF_NOT_ZERO: {
+				auto jump = std::static_pointer_cast<AIRJumpIfNotZeroInstructionNode>(instruction);
+				operation.a = operand(jump->condition);
+				jumps.push_back({ static_cast<uint32_t>(function.operations.size()), jump->label });
+				break;
+			}
+			case AIRNodeType::RETURN:
+				operation.a = operand(std::static_pointer_cast<AIRReturnInstructionNode>(instruction)->value);
+				break;
+			case AIRNodeType::CALL: {
+				auto call = std::static_pointer_cast<AIRFunctionCallNode>(instruction);
+				for (auto& argument : call->value_list)
+					operation.arguments.push_back(operand(argument));
+				operation.destination = slot(std::static_pointer_cast<AIRVariableValueNode>(call->destination));
+				operation.type = call->destination->type;
+				operation.target = function_index(call->function);
+				if (operation.target == NO_SLOT && function.error.empty())
+					function.error = std::format("'{0}' calls '{1}', which is not a constant function", function.node->name.view(), call->function.view());
+				break;
+			}
+			default:
+				continue;
+			}
+			function.operations.push_back(std::move(operation));
+		}
+
+		for (auto& [index, label] : jumps)
+			function.operations[index].target = label_indices[label_key(label)];
+	}
+
+	std::optional<Constant> AIRInterpreter::run(ptr<AIRFunctionNode> function, const Position& position) {
+		// Recursion is limited as well, the frames of a function that never returns would otherwise use up the memory
+		static constexpr size_t MAX_CALL_DEPTH = 10'000;
+
+		m_evaluated = function->name;
+		m_evaluated_position = position;
+
+		// The function that is run can't be called by name
+		uint32_t run_index = static_cast<uint32_t>(m_functions.size());
+		m_functions.push_back({ function });
+
+		m_frames.clear();
+		m_slots.clear();
+		std::optional<Constant> result;
+		uint64_t steps = 0;
+
+		PreparedFunction* running = &m_functions[run_index];
+		prepare(*running);
+		m_frames.push_back({ run_index });
+		m_slots.resize(running->slot_count);
+
+		while (!m_frames.empty()) {
+			Frame& frame = m_frames.back();
+			PreparedFunction& current = m_functions[frame.function];
+			if (!current.error.empty()) {
+				report_error(current.error);
+				break;
+			}
+			if (++steps > m_step_budget) {
+				report_error(std::format("exceeded the limit of {0} executed instructions", m_step_budget));
+				break;
+			}
+
+			const Operation& operation = current.operations[frame.next++];
+			Constant* destination = operation.destination == NO_SLOT ? nullptr : &m_slots[frame.slot_base + operation.destination];
+			switch (operation.kind) {
+			case AIRNodeType::UNARY_OPERATION:
+				*destination = convert_constant(fold_unary(operation.unary, value(operation.a, frame), operation.type), operation.type);
+				continue;
+			case AIRNodeType::BINARY_OPERATION:
+				if (std::optional<Constant> folded = fold_binary(operation.binary, value(operation.a, frame), value(operation.b, frame), operation.type)) {
+					*destination = convert_constant(*folded, operation.type);
+					continue;
+				}
+				report_error("division by zero or overflow");
+				break;
+			case AIRNodeType::SET:
+			case AIRNodeType::CONVERT:
+				*destination = convert_constant(value(operation.a, frame), operation.type);
+				continue;
+			case AIRNodeType::LOAD_ELEMENT:
+			case AIRNodeType::STORE_ELEMENT: {
+				// Elements are checked even if the generated code does not check them, nothing proved them to be in bounds here
+				int64_t index = value(operation.a, frame).integer;
+				if (index < 0 || index >= int64_t(operation.length)) {
+					report_error(std::format("index {0} is out of bounds of an array of length {1}", index, operation.length));
+					break;
+				}
+				Constant& element = m_slots[frame.slot_base + operation.array + index];
+				if (operation.kind == AIRNodeType::LOAD_ELEMENT)
+					*destination = convert_constant(element, operation.type);
+				else
+					element = convert_constant(value(operation.b, frame), operation.type);
+				continue;
+			}
+			case AIRNodeType::JUMP:
+				frame.next = operation.target;
+				continue;
+			case AIRNodeType::JUMP_IF_ZERO:
+				if (!value(operation.a, frame).is_true())
+					frame.next = operation.target;
+				continue;
+			case AIRNodeType::JUMP_IF_NOT_ZERO:
+				if (value(operation.a, frame).is_true())
+					frame.next = operation.target;
+				continue;
+			case AIRNodeType::CALL: {
+				if (m_frames.size() >= MAX_CALL_DEPTH) {
+					report_error(std::format("exceeded the limit of {0} nested calls", MAX_CALL_DEPTH));
+					break;
+				}
+				PreparedFunction& callee = m_functions[operation.target];
+				if (!callee.prepared)
+					prepare(callee);
+				if (m_slots.size() + callee.slot_count > MAX_SLOTS) {
+					report_error(std::format("the called functions use more than {0} variables and array elements", MAX_SLOTS));
+					break;
+				}
+
+				// The parameters are set before the frame is pushed, which may move the frame of the caller
+				Frame callee_frame{ operation.target, 0, static_cast<uint32_t>(m_slots.size()), operation.destination, operation.type };
+				m_slots.resize(m_slots.size() + callee.slot_count);
+				for (size_t i = 0; i < operation.arguments.size() && i < callee.parameter_slots.size(); i++)
+					m_slots[callee_frame.slot_base + callee.parameter_slots[i]] = convert_constant(value(operation.arguments[i], frame), callee.node->parameters[i]->type);
+				m_frames.push_back(callee_frame);
+				continue;
+			}
+			case AIRNodeType::RETURN: {
+				Constant returned = convert_constant(value(operation.a, frame), current.node->return_type);
+				Frame finished = frame;
+				m_frames.pop_back();
+				m_slots.resize(finished.slot_base);
+				if (m_frames.empty())
+					result = returned;
+				else
+					m_slots[m_frames.back().slot_base + finished.destination] = convert_constant(returned, finished.destination_type);
+				continue;
+			}
+			default:
+				continue;
+			}
+
+			// Only errors leave the switch
+			break;
+		}
+
+		m_functions.pop_back();
+		m_frames.clear();
+		m_slots.clear();
+		return result;
+	}
+}
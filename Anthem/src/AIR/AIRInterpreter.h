@@ -0,0 +1,102 @@
+// AIRInterpreter.h
+// Contains the AIRInterpreter Class definition
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#pragma once
+#include <unordered_map>
+#include "AIRConstructs.h"
+#include "SemanticAnalyzer/ConstantEvaluator.h"
+
+namespace Anthem {
+	/*
+	*  Runs AIR functions at compile time, to evaluate calls to constant functions.
+	*  Functions are run in a sandbox: they can only call the constant functions added to the interpreter and can't touch
+	*  global variables, and the number of instructions a run executes is limited so a function that never returns is an error
+	*/
+	class AIRInterpreter {
+	public:
+		static constexpr uint64_t DEFAULT_STEP_BUDGET = 10'000'000;
+
+		AIRInterpreter(ErrorHandler* error_handler, uint64_t step_budget = DEFAULT_STEP_BUDGET);
+
+		// Make a constant function callable by the functions that are run
+		void add_function(ptr<AIRFunctionNode> function);
+
+		// Run <function>, which has no parameters, and return what it returns as its return type.
+		// Reports an error at <position> and returns nothing if it does something only possible at runtime or runs out of steps
+		std::optional<Constant> run(ptr<AIRFunctionNode> function, const Position& position);
+	private:
+		static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+		// Arrays take a slot per element, so the slots of all frames are limited as well
+		static constexpr size_t MAX_SLOTS = 1 << 22;
+
+		// A constant, or the slot of a local variable or temporary in the frame of the running function
+		struct Operand {
+			uint32_t slot{ NO_SLOT };
+			Constant constant{};
+		};
+
+		// An AIR instruction with its variables replaced by slots and its labels by instruction indices
+		struct Operation {
+			AIRNodeType kind;
+			UnaryOperation unary{ UnaryOperation::NONE };
+			BinaryOperation binary{ BinaryOperation::NONE };
+			Operand a{};
+			Operand b{};
+			uint32_t destination{ NO_SLOT };
+			ReturnType type{ ReturnType::I32 };
+
+			// Index of the jump target or of the called function
+			uint32_t target{ NO_SLOT };
+			std::vector<Operand> arguments{};
+
+			// First slot and number of elements of the array an element is loaded from or stored to
+			uint32_t array{ NO_SLOT };
+			uint32_t length{ 0 };
+		};
+
+		// A function translated to Operations the first time it is called
+		struct PreparedFunction {
+			ptr<AIRFunctionNode> node;
+			std::vector<Operation> operations{};
+			std::vector<uint32_t> parameter_slots{};
+			uint32_t slot_count{ 0 };
+			bool prepared{ false };
+
+			// Set if the function uses something only known at runtime, e.g. a global variable
+			std::string error{};
+		};
+
+		struct Frame {
+			uint32_t function;
+			uint32_t next{ 0 };
+			uint32_t slot_base{ 0 };
+
+			// Slot of the caller that receives the returned value and its type
+			uint32_t destination{ NO_SLOT };
+			ReturnType destination_type{ ReturnType::I32 };
+		};
+
+		void prepare(PreparedFunction& function);
+		uint32_t function_index(const Name& name);
+
+		Constant value(const Operand& operand, const Frame& frame) const { return operand.slot == NO_SLOT ? operand.constant : m_slots[frame.slot_base + operand.slot]; }
+
+		void report_error(const std::string& message);
+	private:
+		ErrorHandler* m_error_handler;
+		uint64_t m_step_budget;
+
+		std::vector<PreparedFunction> m_functions;
+		std::unordered_map<Name, uint32_t> m_function_indices;
+
+		// Slots of every active frame, each frame uses the slots from its base on
+		std::vector<Frame> m_frames;
+		std::vector<Constant> m_slots;
+
+		// Name of the function that was run and the declaration it evaluates, for error messages
+		Name m_evaluated;
+		Position m_evaluated_position;
+	};
+}
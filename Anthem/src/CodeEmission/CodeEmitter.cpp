@@ -19,8 +19,8 @@ namespace Anthem {
 
 	void CodeEmitter::emit_function(ptr<ASMFunctionNode> function) {
 		emit_directive("text");
-		emit_identifier(function->name, function->flag == VarFlag::Global);
-		emit_label(function->name);
+		emit_identifier(function->name.str(), function->flag == VarFlag::Global);
+		emit_label(function->name.str());
 		emit_function_prologue();
 		for(auto& instruction : function->instructions)
 			emit_instruction(instruction);
@@ -38,21 +38,30 @@ namespace Anthem {
 			switch (var->flag)
 			{
 			case VarFlag::Global:
-				emit_directive("globl " + var->name);
+				emit_directive("globl " + var->name.str());
 			default:
 				break;
 			}
 			if (var->initializer) {
+				const char* directive = "long ";
+				switch (var->size) {
+				case 1: directive = "byte "; break;
+				case 2: directive = "short "; break;
+				case 8: directive = "quad "; break;
+				default: break;
+				}
 				emit_directive("data");
-				emit_directive("align 4");
-				emit_label(var->name);
-				emit_directive("long " + std::to_string(var->initializer));
+				emit_directive("align " + std::to_string(var->size));
+				emit_label(var->name.str());
+				emit_directive(directive + std::to_string(var->initializer));
 			}
 			else {
+				// Arrays can't have an initializer, all of their elements start as zeros
+				uint64_t bytes = uint64_t(var->size) * std::max(var->length, 1u);
 				emit_directive("bss");
-				emit_directive("align 4");
-				emit_label(var->name);
-				emit_directive("zero 4");
+				emit_directive("align " + std::to_string(var->size));
+				emit_label(var->name.str());
+				emit_directive("zero " + std::to_string(bytes));
 			}
 			break;
 		}
@@ -78,9 +87,12 @@ namespace Anthem {
 			if (!node->flagged)
 				emit_stack_access(node->stack_offset);
 			else
-				emit_data_access(node->name);
+				emit_data_access(node->name.str());
 			break;
 		}
+		case ASMNodeType::INDEXED_OPERAND:
+			emit_indexed_access(std::static_pointer_cast<IndexedOperandNode>(operand));
+			break;
 		default:
 			break;
 		}
@@ -119,10 +131,13 @@ namespace Anthem {
 			emit_compare(std::static_pointer_cast<CompareInstructionNode>(instruction));
 			break;
 		case ASMNodeType::LABEL:
-			emit_label(".L" + std::static_pointer_cast<ASMLabelNode>(instruction)->label);
+			emit_label(".L" + std::static_pointer_cast<ASMLabelNode>(instruction)->label.str());
 			break;
 		case ASMNodeType::SIGN_EXTEND:
-			emit_cdq();
+			emit_cdq(std::static_pointer_cast<SignExtendInstructionNode>(instruction));
+			break;
+		case ASMNodeType::CONVERT:
+			emit_convert(std::static_pointer_cast<ConvertInstructionNode>(instruction));
 			break;
 		case ASMNodeType::DEALLOCATE_STACK:
 			emit_deallocate_stack(std::static_pointer_cast<ASMDeallocateStackNode>(instruction));
@@ -133,6 +148,12 @@ namespace Anthem {
 		case ASMNodeType::CALL:
 			emit_call(std::static_pointer_cast<ASMCallNode>(instruction));
 			break;
+		case ASMNodeType::LOAD_ADDRESS:
+			emit_load_address(std::static_pointer_cast<LoadAddressNode>(instruction));
+			break;
+		case ASMNodeType::TRAP:
+			emit_trap();
+			break;
 		default:
 			return;
 		}
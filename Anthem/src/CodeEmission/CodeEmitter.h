@@ -35,7 +35,7 @@ namespace Anthem {
 		virtual void emit_move(ptr<MoveInstructionNode> move_instruction) = 0;
 		virtual void emit_operand(ptr<ASMOperandNode> operand, Size size = Size::DWORD);
 		virtual void emit_register(Register register_op, Size size = Size::DWORD) = 0;
-		virtual void emit_integer(int integer) = 0;
+		virtual void emit_integer(int64_t integer) = 0;
 		virtual void emit_return() = 0;
 		virtual void emit_file_epilogue() = 0;
 		virtual void emit_unary(ptr<UnaryInstructionNode> unary_operation) = 0;
@@ -45,13 +45,17 @@ namespace Anthem {
 		virtual void emit_jump_conditional(ptr<JumpConditionalNode> conditional_jump) = 0;
 		virtual void emit_set_conditional(ptr<SetConditionalNode> set_conditional) = 0;
 		virtual void emit_idiv(ptr<DivideInstructionNode> divide) = 0;
-		virtual void emit_cdq() = 0;
+		virtual void emit_cdq(ptr<SignExtendInstructionNode> sign_extend) = 0;
+		virtual void emit_convert(ptr<ConvertInstructionNode> convert) = 0;
 		virtual void emit_stack_access(int offset) = 0;
 		virtual void emit_data_access(const std::string& name) = 0;
+		virtual void emit_indexed_access(ptr<IndexedOperandNode> operand) = 0;
 		virtual void emit_allocate_stack(ptr<AllocateStackNode> stack_operand) = 0;
 		virtual void emit_deallocate_stack(ptr<ASMDeallocateStackNode> stack_operand) = 0;
 		virtual void emit_push_stack(ptr<ASMPushStackNode> operand) = 0;
 		virtual void emit_call(ptr<ASMCallNode> call) = 0;
+		virtual void emit_load_address(ptr<LoadAddressNode> load_address) = 0;
+		virtual void emit_trap() = 0;
 		virtual void emit_directive(const std::string& dir) = 0;
 		virtual const std::string& assembly_out() = 0;
 	};
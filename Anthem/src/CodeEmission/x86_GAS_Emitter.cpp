@@ -32,6 +32,41 @@ namespace Anthem {
 		}
 	}
 
+	// Condition codes after a floating point comparison, which sets the flags like an unsigned one
+	std::string floating_condition_code(BinaryOperation condition) {
+		switch (condition)
+		{
+		case BinaryOperation::GREATER:			return "a";
+		case BinaryOperation::GREATER_EQUAL:	return "ae";
+		case BinaryOperation::LESS:				return "b";
+		case BinaryOperation::LESS_EQUAL:		return "be";
+		default:								return condition_code(condition);
+		}
+	}
+
+	std::string suffix(ASMType type) {
+		switch (type)
+		{
+		case ASMType::BYTE:		return "b";
+		case ASMType::WORD:		return "w";
+		case ASMType::QUADWORD:	return "q";
+		case ASMType::SINGLE:	return "ss";
+		case ASMType::DOUBLE:	return "sd";
+		default:				return "l";
+		}
+	}
+
+	Size operand_size(ASMType type) {
+		switch (type)
+		{
+		case ASMType::BYTE:		return Size::BYTE;
+		case ASMType::WORD:		return Size::WORD;
+		case ASMType::QUADWORD:
+		case ASMType::DOUBLE:	return Size::QWORD;
+		default:				return Size::DWORD;
+		}
+	}
+
 	x86_GAS_Emitter::x86_GAS_Emitter(bool compile_for_windows) : m_compile_for_windows{ compile_for_windows } {}
 
 	void x86_GAS_Emitter::emit_string(const std::string& str, bool idented) {
@@ -66,10 +101,21 @@ namespace Anthem {
 	}
 
 	void x86_GAS_Emitter::emit_move(ptr<MoveInstructionNode> move_instruction) {
-		emit_string("movl ");
-		emit_operand(move_instruction->source);
+		ASMType type = move_instruction->type;
+		if (is_floating(type))
+			emit_string("mov" + suffix(type) + " ");
+		// Integers are moved to and from SSE registers with movd and movq
+		else if (is_sse_register(move_instruction->source) || is_sse_register(move_instruction->destination))
+			emit_string(type == ASMType::QUADWORD ? "movq " : "movd ");
+		// 64 bit immediates only fit the movabsq form
+		else if (type == ASMType::QUADWORD && move_instruction->source->get_type() == ASMNodeType::INTEGER
+			&& std::static_pointer_cast<IntegerOperandNode>(move_instruction->source)->integer != int32_t(std::static_pointer_cast<IntegerOperandNode>(move_instruction->source)->integer))
+			emit_string("movabsq ");
+		else
+			emit_string("mov" + suffix(type) + " ");
+		emit_operand(move_instruction->source, operand_size(type));
 		emit_string(", ", false);
-		emit_operand(move_instruction->destination);
+		emit_operand(move_instruction->destination, operand_size(type));
 		emit_line();
 	}
 
@@ -83,7 +129,7 @@ namespace Anthem {
 					emit_string("%al", false);
 					break;
 				case Anthem::Size::WORD:
-					emit_string("%ah", false);
+					emit_string("%ax", false);
 					break;
 				case Anthem::Size::DWORD:
 					emit_string("%eax", false);
@@ -103,7 +149,7 @@ namespace Anthem {
 					emit_string("%dl", false);
 					break;
 				case Anthem::Size::WORD:
-					emit_string("%dh", false);
+					emit_string("%dx", false);
 					break;
 				case Anthem::Size::DWORD:
 					emit_string("%edx", false);
@@ -123,7 +169,7 @@ namespace Anthem {
 					emit_string("%cl", false);
 					break;
 				case Anthem::Size::WORD:
-					emit_string("%ch", false);
+					emit_string("%cx", false);
 					break;
 				case Anthem::Size::DWORD:
 					emit_string("%ecx", false);
@@ -143,7 +189,7 @@ namespace Anthem {
 					emit_string("%dil", false);
 					break;
 				case Anthem::Size::WORD:
-					emit_string("%dih", false);
+					emit_string("%di", false);
 					break;
 				case Anthem::Size::DWORD:
 					emit_string("%edi", false);
@@ -163,7 +209,7 @@ namespace Anthem {
 					emit_string("%sil", false);
 					break;
 				case Anthem::Size::WORD:
-					emit_string("%sih", false);
+					emit_string("%si", false);
 					break;
 				case Anthem::Size::DWORD:
 					emit_string("%esi", false);
@@ -189,7 +235,7 @@ namespace Anthem {
 					emit_string("%r8d", false);
 					break;
 				case Anthem::Size::QWORD:
-					emit_string("%r8q", false);
+					emit_string("%r8", false);
 					break;
 				default:
 					break;
@@ -209,7 +255,7 @@ namespace Anthem {
 					emit_string("%r9d", false);
 					break;
 				case Anthem::Size::QWORD:
-					emit_string("%r9q", false);
+					emit_string("%r9", false);
 					break;
 				default:
 					break;
@@ -229,7 +275,7 @@ namespace Anthem {
 					emit_string("%r10d", false);
 					break;
 				case Anthem::Size::QWORD:
-					emit_string("%r10q", false);
+					emit_string("%r10", false);
 					break;
 				default:
 					break;
@@ -249,17 +295,27 @@ namespace Anthem {
 					emit_string("%r11d", false);
 					break;
 				case Anthem::Size::QWORD:
-					emit_string("%r11q", false);
+					emit_string("%r11", false);
 					break;
 				default:
 					break;
 				}
 				break;
 			}
+			// SSE registers have the same name for every size
+			case Register::XMM14:
+				emit_string("%xmm14", false);
+				break;
+			case Register::XMM15:
+				emit_string("%xmm15", false);
+				break;
+			default:
+				emit_string(std::format("%xmm{0}", static_cast<int>(register_op) - static_cast<int>(Register::XMM0)), false);
+				break;
 		}
 	}
 
-	void x86_GAS_Emitter::emit_integer(int integer) {
+	void x86_GAS_Emitter::emit_integer(int64_t integer) {
 		emit_string(std::format("${0}", integer), false);
 	}
 
@@ -271,6 +327,29 @@ namespace Anthem {
 		emit_string(name + "(%rip)", false);
 	}
 
+	void x86_GAS_Emitter::emit_indexed_access(ptr<IndexedOperandNode> operand) {
+		int64_t displacement = operand->displacement;
+		if (operand->base->get_type() == ASMNodeType::REGISTER) {
+			emit_string(std::format("{0}(", displacement), false);
+			emit_register(std::static_pointer_cast<RegisterOperandNode>(operand->base)->register_op, Size::QWORD);
+		}
+		else {
+			ptr<PseudoOperandNode> pseudo = std::static_pointer_cast<PseudoOperandNode>(operand->base);
+			// A symbol is only addressed relative to RIP, which can't be indexed
+			if (pseudo->flagged) {
+				emit_string(pseudo->name.str() + (displacement ? std::format("+{0}", displacement) : "") + "(%rip)", false);
+				return;
+			}
+			emit_string(std::format("{0}(%rbp", pseudo->stack_offset + displacement), false);
+		}
+		if (operand->index) {
+			emit_string(", ", false);
+			emit_register(*operand->index, Size::QWORD);
+			emit_string(std::format(", {0}", operand->scale), false);
+		}
+		emit_string(")", false);
+	}
+
 	void x86_GAS_Emitter::emit_return() {
 		emit_string("movq %rbp, %rsp");
 		emit_line();
@@ -281,73 +360,101 @@ namespace Anthem {
 	}
 
 	void x86_GAS_Emitter::emit_unary(ptr<UnaryInstructionNode> unary_operation) {
+		Size size = operand_size(unary_operation->type);
 		switch (unary_operation->unary_operation) {
 		case UnaryOperation::NEGATE:
-			emit_string("negl ");
-			emit_operand(unary_operation->operand);
+			emit_string("neg" + suffix(unary_operation->type) + " ");
+			emit_operand(unary_operation->operand, size);
 			break;
 		case UnaryOperation::COMPLEMENT:
-			emit_string("notl ");
-			emit_operand(unary_operation->operand);
+			emit_string("not" + suffix(unary_operation->type) + " ");
+			emit_operand(unary_operation->operand, size);
 			break;
 		}
 		emit_line();
 	}
 
 	void x86_GAS_Emitter::emit_binary(ptr<BinaryInstructionNode> binary_operation) {
+		ASMType type = binary_operation->type;
 		switch (binary_operation->binary_operation) {
 		case BinaryOperation::ADDITION:
-			emit_string("addl ");
-			emit_operand(binary_operation->operand_a);
-			emit_string(", ", false);
-			emit_operand(binary_operation->operand_b);
+			emit_string("add" + suffix(type) + " ");
 			break;
 		case BinaryOperation::SUBTRACTION:
-			emit_string("subl ");
-			emit_operand(binary_operation->operand_a);
-			emit_string(", ", false);
-			emit_operand(binary_operation->operand_b);
+			emit_string("sub" + suffix(type) + " ");
 			break;
 		case BinaryOperation::MULTIPLICATION:
-			emit_string("imull ");
-			emit_operand(binary_operation->operand_a);
-			emit_string(", ", false);
-			emit_operand(binary_operation->operand_b);
+			emit_string((is_floating(type) ? "mul" : "imul") + suffix(type) + " ");
+			break;
+		case BinaryOperation::DIVISION:
+			emit_string("div" + suffix(type) + " ");
 			break;
+		case BinaryOperation::AND:
+			emit_string("and" + suffix(type) + " ");
+			break;
+		case BinaryOperation::OR:
+			emit_string("or" + suffix(type) + " ");
+			break;
+		default:
+			emit_line();
+			return;
 		}
+		emit_operand(binary_operation->operand_a, operand_size(type));
+		emit_string(", ", false);
+		emit_operand(binary_operation->operand_b, operand_size(type));
 		emit_line();
 	}
 	void x86_GAS_Emitter::emit_idiv(ptr<DivideInstructionNode> divide) {
-		emit_string("idivl ");
-		emit_operand(divide->operand);
+		emit_string("idiv" + suffix(divide->type) + " ");
+		emit_operand(divide->operand, operand_size(divide->type));
 		emit_line();
 	}
 
 	void x86_GAS_Emitter::emit_compare(ptr<CompareInstructionNode> compare_operation) {
-		emit_string("cmpl ");
-		emit_operand(compare_operation->operand_a);
+		ASMType type = compare_operation->type;
+		emit_string((is_floating(type) ? "ucomi" : "cmp") + suffix(type) + " ");
+		emit_operand(compare_operation->operand_a, operand_size(type));
 		emit_string(", ", false);
-		emit_operand(compare_operation->operand_b);
+		emit_operand(compare_operation->operand_b, operand_size(type));
 		emit_line();
 	}
 
 	void x86_GAS_Emitter::emit_jump(ptr<JumpInstructionNode> jump) {
-		emit_string("jmp .L" + jump->label);
+		emit_string("jmp .L" + jump->label.str());
 		emit_line();
 	}
 	void x86_GAS_Emitter::emit_jump_conditional(ptr<JumpConditionalNode> conditional_jump) {
-		emit_string("j" + condition_code(conditional_jump->condition) + " .L" + conditional_jump->label);
+		std::string code = conditional_jump->is_unsigned ? floating_condition_code(conditional_jump->condition) : condition_code(conditional_jump->condition);
+		emit_string("j" + code + " .L" + conditional_jump->label.str());
 		emit_line();
 	}
 
 	void x86_GAS_Emitter::emit_set_conditional(ptr<SetConditionalNode> set_conditional) {
-		emit_string("set" + condition_code(set_conditional->condition) + " ");
-		emit_operand(set_conditional->operand);
+		std::string code = set_conditional->floating ? floating_condition_code(set_conditional->condition) : condition_code(set_conditional->condition);
+		emit_string("set" + code + " ");
+		emit_operand(set_conditional->operand, Size::BYTE);
 		emit_line();
 	}
 
-	void x86_GAS_Emitter::emit_cdq() {
-		emit_string("cdq");
+	void x86_GAS_Emitter::emit_cdq(ptr<SignExtendInstructionNode> sign_extend) {
+		emit_string(sign_extend->type == ASMType::QUADWORD ? "cqo" : "cdq");
+		emit_line();
+	}
+
+	void x86_GAS_Emitter::emit_convert(ptr<ConvertInstructionNode> convert) {
+		ASMType source = convert->source_type;
+		ASMType destination = convert->destination_type;
+		if (!is_floating(source) && !is_floating(destination))
+			emit_string((convert->zero_extend ? "movz" : "movs") + suffix(source) + suffix(destination) + " ");
+		else if (!is_floating(source))
+			emit_string("cvtsi2" + suffix(destination) + suffix(source) + " ");
+		else if (!is_floating(destination))
+			emit_string("cvtt" + suffix(source) + "2si" + suffix(destination) + " ");
+		else
+			emit_string("cvt" + suffix(source) + "2" + suffix(destination) + " ");
+		emit_operand(convert->source, operand_size(source));
+		emit_string(", ", false);
+		emit_operand(convert->destination, operand_size(destination));
 		emit_line();
 	}
 
@@ -363,7 +470,20 @@ namespace Anthem {
 	}
 
 	void x86_GAS_Emitter::emit_call(ptr<ASMCallNode> call) {
-		emit_string("call " + call->label + (call->is_external && !m_compile_for_windows ? "@PLT" : ""));
+		emit_string("call " + call->label.str() + (call->is_external && !m_compile_for_windows ? "@PLT" : ""));
+		emit_line();
+	}
+
+	void x86_GAS_Emitter::emit_load_address(ptr<LoadAddressNode> load_address) {
+		emit_string("leaq ");
+		emit_operand(load_address->source, Size::QWORD);
+		emit_string(", ", false);
+		emit_operand(load_address->destination, Size::QWORD);
+		emit_line();
+	}
+
+	void x86_GAS_Emitter::emit_trap() {
+		emit_string("ud2");
 		emit_line();
 	}
 
@@ -16,12 +16,13 @@ namespace Anthem {
 		virtual void emit_function_epilogue() override;
 		virtual void emit_move(ptr<MoveInstructionNode> move_instruction) override;
 		virtual void emit_register(Register register_op, Size size = Size::DWORD) override;
-		virtual void emit_integer(int integer) override;
+		virtual void emit_integer(int64_t integer) override;
 		virtual void emit_return() override;
 		virtual void emit_file_epilogue() override;
 		virtual void emit_unary(ptr<UnaryInstructionNode> unary_operation) override;
 		virtual void emit_stack_access(int offset) override;
 		virtual void emit_data_access(const std::string& name) override;
+		virtual void emit_indexed_access(ptr<IndexedOperandNode> operand) override;
 		virtual void emit_allocate_stack(ptr<AllocateStackNode> allocate_stack) override;
 		virtual void emit_binary(ptr<BinaryInstructionNode> binary_operation) override;
 		virtual void emit_idiv(ptr<DivideInstructionNode> divide) override;
@@ -29,10 +30,13 @@ namespace Anthem {
 		virtual void emit_jump(ptr<JumpInstructionNode> jump) override;
 		virtual void emit_jump_conditional(ptr<JumpConditionalNode> conditional_jump) override;
 		virtual void emit_set_conditional(ptr<SetConditionalNode> set_conditional) override;
-		virtual void emit_cdq() override;
+		virtual void emit_cdq(ptr<SignExtendInstructionNode> sign_extend) override;
+		virtual void emit_convert(ptr<ConvertInstructionNode> convert) override;
 		virtual void emit_deallocate_stack(ptr<ASMDeallocateStackNode> stack_operand) override;
 		virtual void emit_push_stack(ptr<ASMPushStackNode> operand) override;
 		virtual void emit_call(ptr<ASMCallNode> call) override;
+		virtual void emit_load_address(ptr<LoadAddressNode> load_address) override;
+		virtual void emit_trap() override;
 		virtual void emit_directive(const std::string& dir) override;
 
 		virtual const std::string& assembly_out() override;
@@ -7,13 +7,12 @@
 #include <vector>
 #include "Utilities/Utilities.h"
 #include <deque>
+#include <optional>
 
 namespace Anthem {
 // Macro to simplify basic setup for all node classes
 #define ASM_NODE_TYPE(x) ASMNodeType get_type() const override { return ASMNodeType::x; }
 
-	using Name = std::string;
-
 	enum class Register {
 		EAX,
 		EDX,
@@ -23,9 +22,60 @@ namespace Anthem {
 		EDI,
 		ESI,
 		R8D,
-		R9D
+		R9D,
+
+		// -- SSE Registers --
+
+		XMM0,
+		XMM1,
+		XMM2,
+		XMM3,
+		XMM4,
+		XMM5,
+		XMM6,
+		XMM7,
+		XMM14,
+		XMM15
+	};
+
+	inline bool is_sse_register(Register register_op) { return register_op >= Register::XMM0; }
+
+	// Operand type of an instruction, it picks the instruction suffix and the register names
+	enum class ASMType {
+		BYTE,
+		WORD,
+		LONGWORD,
+		QUADWORD,
+		SINGLE,
+		DOUBLE
 	};
 
+	inline bool is_floating(ASMType type) { return type == ASMType::SINGLE || type == ASMType::DOUBLE; }
+
+	inline ASMType asm_type(ReturnType type) {
+		switch (type)
+		{
+		case ReturnType::I8:
+		case ReturnType::BOOL:
+			return ASMType::BYTE;
+		case ReturnType::I16:	return ASMType::WORD;
+		case ReturnType::I64:	return ASMType::QUADWORD;
+		case ReturnType::F32:	return ASMType::SINGLE;
+		case ReturnType::F64:	return ASMType::DOUBLE;
+		default:				return ASMType::LONGWORD;
+		}
+	}
+
+	// Integer type of the same size, used to move floating point values through general purpose registers
+	inline ASMType integer_type(ASMType type) {
+		switch (type)
+		{
+		case ASMType::SINGLE:	return ASMType::LONGWORD;
+		case ASMType::DOUBLE:	return ASMType::QUADWORD;
+		default:				return type;
+		}
+	}
+
 	enum class ASMNodeType {
 		INSTRUCTION,
 		OPERAND,
@@ -42,6 +92,7 @@ namespace Anthem {
 		REGISTER,
 		PSEUDO_OPERAND,
 		STACK_OPERAND,
+		INDEXED_OPERAND,
 
 		// -- Instructions --
 
@@ -51,6 +102,7 @@ namespace Anthem {
 		BINARY,
 		DIVIDE,
 		SIGN_EXTEND,
+		CONVERT,
 		ALLOCATE_STACK,
 		JUMP,
 		JUMP_CONDITIONAL,
@@ -59,6 +111,8 @@ namespace Anthem {
 		DEALLOCATE_STACK,
 		PUSH,
 		CALL,
+		LOAD_ADDRESS,
+		TRAP,
 	};
 
 	// General Nodes
@@ -115,25 +169,34 @@ namespace Anthem {
 	class ASMFlaggedVar : public ASMDeclarationNode {
 	public:
 		ASMFlaggedVar() = default;
-		ASMFlaggedVar(const Name& name, VarFlag flag, int initializer)
-			: name{ name }, flag{ flag }, initializer{ initializer } {}
+		ASMFlaggedVar(const Name& name, VarFlag flag, int64_t initializer, uint32_t size, uint32_t length = 0)
+			: name{ name }, flag{ flag }, initializer{ initializer }, size{ size }, length{ length } {}
 
 		ASM_NODE_TYPE(FLAGGED_VAR)
 	public:
 		Name name;
 		VarFlag flag;
-		int initializer;
+
+		// Bit pattern of the initial value
+		int64_t initializer;
+
+		// Size and alignment in bytes
+		uint32_t size;
+
+		// Number of elements of an array, which starts as zeros, 0 otherwise
+		uint32_t length;
 	};
 
 	// -- Operand Nodes --
 
 	class IntegerOperandNode : public ASMOperandNode {
 	public:
-		IntegerOperandNode(int number) : integer{ number } {}
+		IntegerOperandNode(int64_t number) : integer{ number } {}
 
 		ASM_NODE_TYPE(INTEGER)
 	public:
-		int integer;
+		// Floating point constants are stored as their bit pattern
+		int64_t integer;
 	};
 
 	class RegisterOperandNode : public ASMOperandNode {
@@ -147,6 +210,10 @@ namespace Anthem {
 	// Macro to simplify setting a register as an operand
 #define REGISTER(x) std::make_shared<RegisterOperandNode>(Register::x)
 
+	inline bool is_sse_register(ptr<ASMOperandNode> operand) {
+		return operand->get_type() == ASMNodeType::REGISTER && is_sse_register(std::static_pointer_cast<RegisterOperandNode>(operand)->register_op);
+	}
+
 	class AllocateStackNode : public ASMInstructionNode {
 	public:
 		AllocateStackNode(int position) : position{ position } {}
@@ -168,7 +235,11 @@ namespace Anthem {
 	// This also acts as a StackOperandNode
 	class PseudoOperandNode : public ASMOperandNode {
 	public:
-		PseudoOperandNode(Name name) : name{ name } {}
+		// A stack slot of a local variable or temporary
+		PseudoOperandNode(int stack_offset) : stack_offset{ stack_offset } {}
+
+		// A flagged variable, accessed through its symbol
+		PseudoOperandNode(const Name& name) : name{ name }, flagged{ true } {}
 
 		ASM_NODE_TYPE(PSEUDO_OPERAND)
 	public:
@@ -177,6 +248,23 @@ namespace Anthem {
 		bool flagged = false;
 	};
 
+	// Element of an array, at <displacement> + <index> * <scale> bytes from the start of <base>. The base is the pseudo
+	// operand of the array, or a register holding the address of a flagged array since symbols can't be indexed
+	class IndexedOperandNode : public ASMOperandNode {
+	public:
+		IndexedOperandNode(ptr<ASMOperandNode> base, std::optional<Register> index, uint32_t scale, int64_t displacement)
+			: base{ base }, index{ index }, scale{ scale }, displacement{ displacement } {}
+
+		ASM_NODE_TYPE(INDEXED_OPERAND)
+	public:
+		ptr<ASMOperandNode> base;
+
+		// Register holding the 64 bit index, none if the index is constant and part of the displacement
+		std::optional<Register> index;
+		uint32_t scale;
+		int64_t displacement;
+	};
+
 	// -- Instruction Nodes --
 
 	class ReturnInstructionNode : public ASMInstructionNode {
@@ -186,105 +274,142 @@ namespace Anthem {
 
 	class MoveInstructionNode : public ASMInstructionNode {
 	public:
-		MoveInstructionNode(ptr<ASMOperandNode> source, ptr<ASMOperandNode> destination)
-			: source{ source }, destination{ destination } {}
+		MoveInstructionNode(ptr<ASMOperandNode> source, ptr<ASMOperandNode> destination, ASMType type = ASMType::LONGWORD)
+			: source{ source }, destination{ destination }, type{ type } {}
 
 		ASM_NODE_TYPE(MOVE)
 	public:
 		ptr<ASMOperandNode> source;
 		ptr<ASMOperandNode> destination;
+		ASMType type;
 	};
 
 	class UnaryInstructionNode : public ASMInstructionNode {
 	public:
-		UnaryInstructionNode(UnaryOperation unary_operation, ptr<ASMOperandNode> operand)
-			: unary_operation{ unary_operation }, operand{ operand } {}
+		UnaryInstructionNode(UnaryOperation unary_operation, ptr<ASMOperandNode> operand, ASMType type = ASMType::LONGWORD)
+			: unary_operation{ unary_operation }, operand{ operand }, type{ type } {}
 
 		ASM_NODE_TYPE(UNARY)
 	public:
 		UnaryOperation unary_operation;
 		ptr<ASMOperandNode> operand;
+		ASMType type;
 	};
 
+	// Arithmetic operation, AND and OR are bitwise at this level
 	class BinaryInstructionNode : public ASMInstructionNode {
 	public:
-		BinaryInstructionNode(BinaryOperation binary_operation, ptr<ASMOperandNode> operand_a, ptr<ASMOperandNode> operand_b)
-			: binary_operation{ binary_operation }, operand_a{ operand_a }, operand_b{ operand_b } {}
+		BinaryInstructionNode(BinaryOperation binary_operation, ptr<ASMOperandNode> operand_a, ptr<ASMOperandNode> operand_b, ASMType type = ASMType::LONGWORD)
+			: binary_operation{ binary_operation }, operand_a{ operand_a }, operand_b{ operand_b }, type{ type } {}
 
 		ASM_NODE_TYPE(BINARY)
 	public:
 		BinaryOperation binary_operation;
 		ptr<ASMOperandNode> operand_a;
 		ptr<ASMOperandNode> operand_b;
+		ASMType type;
 	};
 
 	class DivideInstructionNode : public ASMInstructionNode {
 	public:
 		DivideInstructionNode() = default;
-		DivideInstructionNode(ptr<ASMOperandNode> operand) : operand{ operand } {}
+		DivideInstructionNode(ptr<ASMOperandNode> operand, ASMType type = ASMType::LONGWORD) : operand{ operand }, type{ type } {}
 
 		ASM_NODE_TYPE(DIVIDE)
 	public:
 		ptr<ASMOperandNode> operand;
+		ASMType type{ ASMType::LONGWORD };
 	};
 
+	// Sign extend the accumulator into the data register before a division
 	class SignExtendInstructionNode : public ASMInstructionNode {
 	public:
+		SignExtendInstructionNode(ASMType type = ASMType::LONGWORD) : type{ type } {}
+
 		ASM_NODE_TYPE(SIGN_EXTEND)
+	public:
+		ASMType type;
+	};
+
+	// Convert between types of different size or between integers and floating point values,
+	// the destination is always a register
+	class ConvertInstructionNode : public ASMInstructionNode {
+	public:
+		ConvertInstructionNode(ptr<ASMOperandNode> source, ptr<ASMOperandNode> destination, ASMType source_type, ASMType destination_type, bool zero_extend = false)
+			: source{ source }, destination{ destination }, source_type{ source_type }, destination_type{ destination_type }, zero_extend{ zero_extend } {}
+
+		ASM_NODE_TYPE(CONVERT)
+	public:
+		ptr<ASMOperandNode> source;
+		ptr<ASMOperandNode> destination;
+		ASMType source_type;
+		ASMType destination_type;
+
+		// Widen integers with zeros instead of the sign bit
+		bool zero_extend;
 	};
 
 	class CompareInstructionNode : public ASMInstructionNode {
 	public:
 		CompareInstructionNode() = default;
-		CompareInstructionNode(ptr<ASMOperandNode> operand_a, ptr<ASMOperandNode> operand_b)
-			: operand_a{ operand_a }, operand_b{ operand_b } {}
+		CompareInstructionNode(ptr<ASMOperandNode> operand_a, ptr<ASMOperandNode> operand_b, ASMType type = ASMType::LONGWORD)
+			: operand_a{ operand_a }, operand_b{ operand_b }, type{ type } {}
 
 		ASM_NODE_TYPE(COMPARE)
 	public:
 		ptr<ASMOperandNode> operand_a;
 		ptr<ASMOperandNode> operand_b;
+		ASMType type{ ASMType::LONGWORD };
 	};
 
 	class JumpInstructionNode : public ASMInstructionNode {
 	public:
 		JumpInstructionNode() = default;
-		JumpInstructionNode(const Name& label) : label{ label } {}
+		JumpInstructionNode(LabelId label) : label{ label } {}
 
 		ASM_NODE_TYPE(JUMP)
 	public:
-		Name label;
+		LabelId label;
 	};
 
 	class JumpConditionalNode : public ASMInstructionNode {
 	public:
 		JumpConditionalNode() = default;
-		JumpConditionalNode(BinaryOperation condition, const Name& label) : label{ label }, condition{ condition } {}
+		JumpConditionalNode(BinaryOperation condition, LabelId label, bool is_unsigned = false)
+			: label{ label }, condition{ condition }, is_unsigned{ is_unsigned } {}
 
 		ASM_NODE_TYPE(JUMP_CONDITIONAL)
 	public:
-		Name label;
+		LabelId label;
 		BinaryOperation condition;
+
+		// The flags were set by a comparison of unsigned values
+		bool is_unsigned{ false };
 	};
 
 	class SetConditionalNode : public ASMInstructionNode {
 	public:
 		SetConditionalNode() = default;
-		SetConditionalNode(BinaryOperation condition, ptr<ASMOperandNode> operand) : condition{ condition }, operand{ operand } {}
+		SetConditionalNode(BinaryOperation condition, ptr<ASMOperandNode> operand, bool floating = false)
+			: condition{ condition }, operand{ operand }, floating{ floating } {}
 
 		ASM_NODE_TYPE(SET_CONDITIONAL)
 	public:
 		BinaryOperation condition;
 		ptr<ASMOperandNode> operand;
+
+		// The flags were set by a floating point comparison, which sets them like an unsigned one
+		bool floating;
 	};
 
 	class ASMLabelNode : public ASMInstructionNode {
 	public:
 		ASMLabelNode() = default;
-		ASMLabelNode(const Name& label) : label{ label } {}
+		ASMLabelNode(LabelId label) : label{ label } {}
 
 		ASM_NODE_TYPE(LABEL)
 	public:
-		Name label;
+		LabelId label;
 	};
 
 	class ASMDeallocateStackNode : public ASMInstructionNode {
@@ -317,4 +442,21 @@ namespace Anthem {
 		Name label;
 		bool is_external;
 	};
+
+	// Load the address of a memory operand to a register
+	class LoadAddressNode : public ASMInstructionNode {
+	public:
+		LoadAddressNode(ptr<ASMOperandNode> source, ptr<ASMOperandNode> destination) : source{ source }, destination{ destination } {}
+
+		ASM_NODE_TYPE(LOAD_ADDRESS)
+	public:
+		ptr<ASMOperandNode> source;
+		ptr<ASMOperandNode> destination;
+	};
+
+	// Stop the program with an invalid instruction
+	class TrapNode : public ASMInstructionNode {
+	public:
+		ASM_NODE_TYPE(TRAP)
+	};
 }
\ No newline at end of file
@@ -22,6 +22,20 @@ namespace Anthem {
 		}
 	}
 
+	// Memory operands, at most one operand of an instruction may be one
+	bool is_memory(ptr<ASMOperandNode> operand) {
+		return operand->get_type() == ASMNodeType::PSEUDO_OPERAND || operand->get_type() == ASMNodeType::STACK_OPERAND
+			|| operand->get_type() == ASMNodeType::INDEXED_OPERAND;
+	}
+
+	// Immediates of 64 bit instructions are sign extended from 32 bits, larger ones have to be moved to a register first
+	bool is_large_immediate(ptr<ASMOperandNode> operand) {
+		if (operand->get_type() != ASMNodeType::INTEGER)
+			return false;
+		int64_t integer = std::static_pointer_cast<IntegerOperandNode>(operand)->integer;
+		return integer < INT32_MIN || integer > INT32_MAX;
+	}
+
 	CodeGenerator::CodeGenerator(ErrorHandler* error_handler, bool compile_for_windows)
 		: m_error_handler{ error_handler }, m_compile_for_windows{ compile_for_windows } {}
 
@@ -58,35 +72,68 @@ namespace Anthem {
 	}
 
 	ptr<ASMFunctionNode> CodeGenerator::generate_function_declaration(ptr<AIRFunctionNode> function_node) {
-		// System V Calling Convention sets 6 registers before allocating passed arguments to stack, Microsoft's requires 4
-		uint8_t registers_to_set = (m_compile_for_windows ? 4 : 6);
-		using R = Register;
-
-		std::vector<Register> argument_registers = (m_compile_for_windows)
-			? std::vector<Register>{ R::ECX, R::EDX, R::R8D, R::R9D }	// <- Microsoft ABI
-			: std::vector<Register>{ R::EDI, R::ESI, R::EDX, R::ECX, R::R8D, R::R9D };	// <- System V ABI
-
 		ptr<ASMFunctionNode> asm_function_node = std::make_shared<ASMFunctionNode>();
 		asm_function_node->name = function_node->name;
 		asm_function_node->flag = function_node->flag;
 		// Push new vector for local variables
 		m_functions.push_back({ &asm_function_node->instructions });
+
+		auto registers = argument_registers(function_node->parameters);
+		uint32_t stack_index = 0;
 		for (uint32_t i = 0; i < function_node->parameters.size(); i++) {
-			if(i <= 6)
+			auto& parameter = function_node->parameters[i];
+			ASMType type = asm_type(parameter->type);
+			if (registers[i])
 				asm_function_node->instructions.push_back(
-					mov(std::make_shared<RegisterOperandNode>(argument_registers[i]), make_pseudo_register(function_node->parameters[i])));
+					mov(std::make_shared<RegisterOperandNode>(*registers[i]), make_pseudo_register(parameter), type));
 			else
-				mov(stack(16 + (i - registers_to_set) * 8), make_pseudo_register(function_node->parameters[i]));
-						// Stack access starts at 16, and for every argument after the 6th (The number of Registers used for Argument passing)
-						// access a multiple of 8 bytes after 16
+				// Stack access starts at 16, and every argument that is not passed in a register is 8 bytes after the previous one
+				asm_function_node->instructions.push_back(mov(stack(16 + stack_index++ * 8), make_pseudo_register(parameter), type));
 		}
 		for (auto& instruction : function_node->instructions)
 			generate_instruction(instruction, asm_function_node->instructions);
+
+		// Every function ends with a return, so the trap is only reached through a failed check
+		if (m_functions.back().bounds_checked) {
+			asm_function_node->instructions.push_back(std::make_shared<ASMLabelNode>(LabelId{ LabelKind::OUT_OF_BOUNDS, static_cast<uint32_t>(m_functions.size() - 1) }));
+			asm_function_node->instructions.push_back(std::make_shared<TrapNode>());
+		}
 		return asm_function_node;
 	}
 
+	std::vector<std::optional<Register>> CodeGenerator::argument_registers(const ValueList& arguments) {
+		using R = Register;
+		std::vector<std::optional<Register>> registers;
+
+		if (m_compile_for_windows) {
+			// Microsoft's ABI passes the first 4 arguments in registers, picked by position
+			const Register integer_registers[] = { R::ECX, R::EDX, R::R8D, R::R9D };
+			const Register sse_registers[] = { R::XMM0, R::XMM1, R::XMM2, R::XMM3 };
+			for (size_t i = 0; i < arguments.size(); i++) {
+				if (i >= 4)
+					registers.push_back(std::nullopt);
+				else
+					registers.push_back(is_floating(arguments[i]->type) ? sse_registers[i] : integer_registers[i]);
+			}
+			return registers;
+		}
+
+		// System V ABI passes the first 6 integer and the first 8 floating point arguments in registers
+		const Register integer_registers[] = { R::EDI, R::ESI, R::EDX, R::ECX, R::R8D, R::R9D };
+		const Register sse_registers[] = { R::XMM0, R::XMM1, R::XMM2, R::XMM3, R::XMM4, R::XMM5, R::XMM6, R::XMM7 };
+		uint32_t integer_index = 0;
+		uint32_t sse_index = 0;
+		for (auto& argument : arguments) {
+			if (is_floating(argument->type))
+				registers.push_back(sse_index < 8 ? std::optional<Register>(sse_registers[sse_index++]) : std::nullopt);
+			else
+				registers.push_back(integer_index < 6 ? std::optional<Register>(integer_registers[integer_index++]) : std::nullopt);
+		}
+		return registers;
+	}
+
 	ptr<ASMFlaggedVar> CodeGenerator::generate_flagged_var(ptr<AIRFlaggedVarNode> var_node) {
-		return std::make_shared<ASMFlaggedVar>(var_node->name, var_node->flag, var_node->initializer);
+		return std::make_shared<ASMFlaggedVar>(var_node->name, var_node->flag, var_node->initializer, type_size(var_node->type), var_node->array_length);
 	}
 
 	void CodeGenerator::generate_instruction(ptr<AIRInstructionNode> instruction_node, ASMInstructionList& list_output) {
@@ -114,13 +161,28 @@ namespace Anthem {
 			return;
 		case AIRNodeType::SET: {
 			auto set = std::static_pointer_cast<AIRSetInstructionNode>(instruction_node);
-			instr(mov(resolve_value(set->value), resolve_value(set->variable)));
+			instr(mov(resolve_value(set->value), resolve_value(set->variable), asm_type(set->variable->type)));
 			return;
 		}
+		case AIRNodeType::CONVERT:
+			generate_convert(std::static_pointer_cast<AIRConvertInstructionNode>(instruction_node), list_output);
+			return;
 		case AIRNodeType::CALL: {
 			generate_call(std::static_pointer_cast<AIRFunctionCallNode>(instruction_node), list_output);
 			return;
 		}
+		case AIRNodeType::LOAD_ELEMENT: {
+			auto load = std::static_pointer_cast<AIRLoadElementInstructionNode>(instruction_node);
+			auto element = element_operand(load, list_output);
+			instr(mov(element, resolve_value(load->destination), asm_type(load->destination->type)));
+			return;
+		}
+		case AIRNodeType::STORE_ELEMENT: {
+			auto store = std::static_pointer_cast<AIRStoreElementInstructionNode>(instruction_node);
+			auto element = element_operand(store, list_output);
+			instr(mov(resolve_value(store->value), element, asm_type(store->array->type)));
+			return;
+		}
 		default:
 			return;
 		}
@@ -129,48 +191,61 @@ namespace Anthem {
 	void CodeGenerator::generate_unary(ptr<AIRUnaryInstructionNode> unary_node, ASMInstructionList& list_output) {
 		auto destination = resolve_value(unary_node->destination);
 		auto source = resolve_value(unary_node->source);
+		ASMType type = asm_type(unary_node->source->type);
+
+		if (unary_node->operation == UnaryOperation::NOT) {
+			instr(cmp(integer(0), source, type));
+			instr(set(BinaryOperation::EQUAL, destination));
+			return;
+		}
 
-		if (unary_node->operation != UnaryOperation::NOT) {
-			instr(mov(source, destination));
-			instr(std::make_shared<UnaryInstructionNode>(unary_node->operation, destination));
+		if (is_floating(type)) {
+			// Floating point values are negated by subtracting them from -0.0
+			if (unary_node->operation == UnaryOperation::NEGATE) {
+				instr(mov(integer(floating_bits(-0.0, unary_node->source->type)), REGISTER(XMM14), type));
+				instr(std::make_shared<BinaryInstructionNode>(BinaryOperation::SUBTRACTION, source, REGISTER(XMM14), type));
+				source = REGISTER(XMM14);
+			}
+			instr(mov(source, destination, type));
 			return;
 		}
 
-		instr(cmp(integer(0), source));
-		instr(mov(integer(0), destination));
-		instr(set(BinaryOperation::EQUAL, destination));
+		instr(mov(source, destination, type));
+		instr(std::make_shared<UnaryInstructionNode>(unary_node->operation, destination, type));
 	}
 
 	void CodeGenerator::handle_complex_binary(ptr<AIRBinaryInstructionNode> binary_node, ASMInstructionList& list_output) {
 		auto destination = resolve_value(binary_node->destination);
 		auto source_a = resolve_value(binary_node->source_a);
 		auto source_b = resolve_value(binary_node->source_b);
+		ASMType type = asm_type(binary_node->source_a->type);
+		BinaryOperation operation = binary_node->operation;
 
-		instr(cmp(source_b, source_a));
-		instr(mov(integer(0), destination));
+		// The result is a bool, so setting its only byte is enough
+		if (!is_floating(type)) {
+			instr(cmp(source_b, source_a, type));
+			instr(set(operation, destination));
+			return;
+		}
 
-		switch (binary_node->operation)
-		{
-		case BinaryOperation::GREATER:
-			instr(std::make_shared<SetConditionalNode>(BinaryOperation::GREATER, destination));
-			break;
-		case BinaryOperation::LESS:
-			instr(std::make_shared<SetConditionalNode>(BinaryOperation::LESS, destination));
-			break;
-		case BinaryOperation::GREATER_EQUAL:
-			instr(std::make_shared<SetConditionalNode>(BinaryOperation::GREATER_EQUAL, destination));
-			break;
-		case BinaryOperation::LESS_EQUAL:
-			instr(std::make_shared<SetConditionalNode>(BinaryOperation::LESS_EQUAL, destination));
-			break;
-		case BinaryOperation::EQUAL:
-			instr(std::make_shared<SetConditionalNode>(BinaryOperation::EQUAL, destination));
-			break;
-		case BinaryOperation::NOT_EQUAL:
-			instr(std::make_shared<SetConditionalNode>(BinaryOperation::NOT_EQUAL, destination));
-			break;
-		default:
-			break;
+		// Floating point comparisons set the flags like unsigned ones and need a register as the second operand.
+		// Less than is done as greater than with the operands swapped, so a NaN operand (which sets the carry flag) gives false
+		if (operation == BinaryOperation::LESS || operation == BinaryOperation::LESS_EQUAL) {
+			std::swap(source_a, source_b);
+			operation = (operation == BinaryOperation::LESS) ? BinaryOperation::GREATER : BinaryOperation::GREATER_EQUAL;
+		}
+		instr(mov(source_a, REGISTER(XMM14), type));
+		instr(cmp(source_b, REGISTER(XMM14), type));
+		instr(set(operation, destination, true));
+
+		// A NaN operand also sets the zero flag, it is told apart from equality by the carry flag
+		if (operation == BinaryOperation::EQUAL) {
+			instr(set(BinaryOperation::GREATER_EQUAL, REGISTER(R11D), true));
+			instr(std::make_shared<BinaryInstructionNode>(BinaryOperation::AND, REGISTER(R11D), destination, ASMType::BYTE));
+		}
+		else if (operation == BinaryOperation::NOT_EQUAL) {
+			instr(set(BinaryOperation::LESS, REGISTER(R11D), true));
+			instr(std::make_shared<BinaryInstructionNode>(BinaryOperation::OR, REGISTER(R11D), destination, ASMType::BYTE));
 		}
 	}
 
@@ -184,28 +259,142 @@ namespace Anthem {
 		auto destination = resolve_value(binary_node->destination);
 		auto source_a = resolve_value(binary_node->source_a);
 		auto source_b = resolve_value(binary_node->source_b);
+		ASMType type = asm_type(binary_node->destination->type);
 
-		if (binary_node->operation == BinaryOperation::DIVISION) {
-			instr(mov(source_a, REGISTER(EAX)));
-			instr(sign_extend());
-			instr(div(source_b));
-			instr(mov(REGISTER(EAX), destination));
+		// SSE operations need a register as the destination
+		if (is_floating(type)) {
+			instr(mov(source_a, REGISTER(XMM14), type));
+			instr(std::make_shared<BinaryInstructionNode>(binary_node->operation, source_b, REGISTER(XMM14), type));
+			instr(mov(REGISTER(XMM14), destination, type));
 			return;
 		}
-		if (binary_node->operation == BinaryOperation::REMAINDER) {
-			instr(mov(source_a, REGISTER(EAX)));
-			instr(sign_extend());
-			instr(div(source_b));
-			instr(mov(REGISTER(EDX), destination));
+
+		if (binary_node->operation == BinaryOperation::DIVISION || binary_node->operation == BinaryOperation::REMAINDER) {
+			// 8 and 16 bit divisions are done in 32 bits, which also keeps the quotient of the smallest value by -1 from trapping
+			ASMType division_type = type;
+			if (type == ASMType::BYTE || type == ASMType::WORD) {
+				division_type = ASMType::LONGWORD;
+				if (source_a->get_type() == ASMNodeType::INTEGER)
+					instr(mov(source_a, REGISTER(EAX), division_type));
+				else
+					instr(convert(source_a, REGISTER(EAX), type, division_type));
+				if (source_b->get_type() != ASMNodeType::INTEGER) {
+					instr(convert(source_b, REGISTER(R10D), type, division_type));
+					source_b = REGISTER(R10D);
+				}
+			}
+			else
+				instr(mov(source_a, REGISTER(EAX), type));
+			instr(sign_extend(division_type));
+			instr(div(source_b, division_type));
+			if (binary_node->operation == BinaryOperation::DIVISION)
+				instr(mov(REGISTER(EAX), destination, type));
+			else
+				instr(mov(REGISTER(EDX), destination, type));
 			return;
 		}
-		instr(mov(source_a, destination));
-		instr(std::make_shared<BinaryInstructionNode>(binary_node->operation, source_b, destination));
+
+		// There is no 8 bit multiplication with two operands, the low byte of a 32 bit one is the same
+		if (binary_node->operation == BinaryOperation::MULTIPLICATION && type == ASMType::BYTE) {
+			if (source_a->get_type() == ASMNodeType::INTEGER)
+				instr(mov(source_a, REGISTER(R11D), ASMType::LONGWORD));
+			else
+				instr(convert(source_a, REGISTER(R11D), type, ASMType::LONGWORD));
+			if (source_b->get_type() != ASMNodeType::INTEGER) {
+				instr(convert(source_b, REGISTER(R10D), type, ASMType::LONGWORD));
+				source_b = REGISTER(R10D);
+			}
+			instr(std::make_shared<BinaryInstructionNode>(binary_node->operation, source_b, REGISTER(R11D), ASMType::LONGWORD));
+			instr(mov(REGISTER(R11D), destination, type));
+			return;
+		}
+
+		instr(mov(source_a, destination, type));
+		instr(std::make_shared<BinaryInstructionNode>(binary_node->operation, source_b, destination, type));
+	}
+
+	void CodeGenerator::generate_convert(ptr<AIRConvertInstructionNode> convert_node, ASMInstructionList& list_output) {
+		auto source = resolve_value(convert_node->source);
+		auto destination = resolve_value(convert_node->destination);
+		ASMType source_type = asm_type(convert_node->source->type);
+		ASMType destination_type = asm_type(convert_node->destination->type);
+		bool zero_extend = convert_node->source->type == ReturnType::BOOL;
+
+		if (!is_floating(source_type) && !is_floating(destination_type)) {
+			// Narrowing keeps the low bytes, which are the first ones in memory
+			if (type_size(convert_node->destination->type) <= type_size(convert_node->source->type)) {
+				instr(mov(source, destination, destination_type));
+				return;
+			}
+			instr(convert(source, REGISTER(R11D), source_type, destination_type, zero_extend));
+			instr(mov(REGISTER(R11D), destination, destination_type));
+			return;
+		}
+
+		if (!is_floating(source_type)) {
+			// Only 32 and 64 bit integers can be converted to floating point values
+			if (source_type == ASMType::BYTE || source_type == ASMType::WORD) {
+				instr(convert(source, REGISTER(R11D), source_type, ASMType::LONGWORD, zero_extend));
+				source = REGISTER(R11D);
+				source_type = ASMType::LONGWORD;
+			}
+			instr(convert(source, REGISTER(XMM15), source_type, destination_type));
+			instr(mov(REGISTER(XMM15), destination, destination_type));
+			return;
+		}
+
+		if (!is_floating(destination_type)) {
+			// Narrow integers take the low bytes of a 32 bit conversion
+			ASMType conversion_type = (destination_type == ASMType::QUADWORD) ? ASMType::QUADWORD : ASMType::LONGWORD;
+			instr(convert(source, REGISTER(R11D), source_type, conversion_type));
+			instr(mov(REGISTER(R11D), destination, destination_type));
+			return;
+		}
+
+		instr(convert(source, REGISTER(XMM15), source_type, destination_type));
+		instr(mov(REGISTER(XMM15), destination, destination_type));
+	}
+
+	ptr<IndexedOperandNode> CodeGenerator::element_operand(ptr<AIRElementInstructionNode> element, ASMInstructionList& list_output) {
+		FunctionInfo& function = m_functions.back();
+		uint32_t scale = type_size(element->array->type);
+
+		// The slot of a local array is taken the first time one of its elements is accessed
+		ptr<ASMOperandNode> base;
+		if (element->array->local.valid()) {
+			auto& pseudo = function.locals[element->array->local];
+			if (!pseudo) {
+				// Each array fits, but together they may not fit the offsets from the base pointer
+				if (function.stack_size + uint64_t(scale) * element->length > INT32_MAX)
+					m_error_handler->report_error(Error{ std::format("The local arrays of a function take more than {0} bytes", INT32_MAX) });
+				pseudo = new_stack_slot(asm_type(element->array->type), element->length);
+			}
+			base = pseudo;
+		}
+		else
+			base = make_pseudo_register(element->array);
+
+		if (element->index->get_type() == AIRNodeType::INTEGER)
+			return std::make_shared<IndexedOperandNode>(base, std::nullopt, scale, std::static_pointer_cast<AIRIntegerValueNode>(element->index)->integer * scale);
+
+		instr(mov(resolve_value(element->index), REGISTER(ECX), ASMType::QUADWORD));
+		if (element->checked) {
+			// Negative indices are larger than the length as unsigned values
+			instr(cmp(integer(element->length), REGISTER(ECX), ASMType::QUADWORD));
+			instr(jmpc(BinaryOperation::GREATER_EQUAL, { LabelKind::OUT_OF_BOUNDS, static_cast<uint32_t>(m_functions.size() - 1) }, true));
+			function.bounds_checked = true;
+		}
+		if (element->array->flagged) {
+			instr(std::make_shared<LoadAddressNode>(base, REGISTER(R11D)));
+			base = REGISTER(R11D);
+		}
+		return std::make_shared<IndexedOperandNode>(base, Register::ECX, scale, 0);
 	}
 
 	void CodeGenerator::generate_return(ptr<AIRReturnInstructionNode> return_node, ASMInstructionList& list_output) {
-		// Move the result of the return expression to EAX register
-		instr(mov(resolve_value(return_node->value), REGISTER(EAX)));
+		// Move the result of the return expression to EAX register, or XMM0 for floating point values
+		ASMType type = asm_type(return_node->value->type);
+		instr(mov(resolve_value(return_node->value), is_floating(type) ? REGISTER(XMM0) : REGISTER(EAX), type));
 		// Return
 		instr(ret());
 	}
@@ -215,6 +404,8 @@ namespace Anthem {
 		{
 		case AIRNodeType::INTEGER:
 			return std::make_shared<IntegerOperandNode>(std::static_pointer_cast<AIRIntegerValueNode>(value)->integer);
+		case AIRNodeType::FLOAT:
+			return std::make_shared<IntegerOperandNode>(floating_bits(std::static_pointer_cast<AIRFloatValueNode>(value)->floating, value->type));
 		case AIRNodeType::VARIABLE:
 			return make_pseudo_register(std::static_pointer_cast<AIRVariableValueNode>(value));
 		default:
@@ -223,47 +414,63 @@ namespace Anthem {
 	}
 
 	ptr<PseudoOperandNode> CodeGenerator::make_pseudo_register(ptr<AIRVariableValueNode> variable) {
-		ptr<PseudoOperandNode> pseudo = std::make_shared<PseudoOperandNode>(variable->variable);
-		if (variable->flagged) {
-			pseudo->flagged = true;
-			auto& flagged_list = m_functions[m_functions.size() - 1].flagged_vars;
-			if (flagged_list.find(variable->variable) != flagged_list.end())
-				return flagged_list[variable->variable];
-			flagged_list[variable->variable] = pseudo;
+		FunctionInfo& function = m_functions.back();
+		if (variable->local.valid()) {
+			auto& pseudo = function.locals[variable->local];
+			if (!pseudo)
+				pseudo = new_stack_slot(asm_type(variable->type));
+			return pseudo;
+		}
+
+		if (variable->temporary.valid()) {
+			uint32_t index = variable->temporary.value();
+			if (index >= function.temporaries.size())
+				function.temporaries.resize(index + 1);
+			if (!function.temporaries[index])
+				function.temporaries[index] = new_stack_slot(asm_type(variable->type));
+			return function.temporaries[index];
 		}
-		auto& pseudo_list = m_functions[m_functions.size() - 1].pseudo_registers;
-		if (pseudo_list.find(variable->variable) != pseudo_list.end())
-			return pseudo_list[variable->variable];
-		pseudo_list[variable->variable] = pseudo;
-		return pseudo;
-	}
 
-	ptr<PseudoOperandNode> CodeGenerator::make_pseudo_register(const Name& variable) {
-		ptr<PseudoOperandNode> pseudo = std::make_shared<PseudoOperandNode>(variable);
-		auto& pseudo_list = m_functions[m_functions.size() - 1].pseudo_registers;
-		if (pseudo_list.find(variable) != pseudo_list.end())
-			return pseudo_list[variable];
-		pseudo_list[variable] = pseudo;
-		return pseudo;
+		auto& flagged = function.flagged_vars[variable->name];
+		if (!flagged)
+			flagged = std::make_shared<PseudoOperandNode>(variable->name);
+		return flagged;
+	}
+
+	ptr<PseudoOperandNode> CodeGenerator::new_stack_slot(ASMType type, uint32_t count) {
+		// Slots are handed out in order of first use, each one below the previous and aligned to its size.
+		// The values of an array slot go up from its offset
+		FunctionInfo& function = m_functions.back();
+		uint32_t size = 1;
+		switch (type) {
+		case ASMType::WORD:		size = 2; break;
+		case ASMType::LONGWORD:
+		case ASMType::SINGLE:	size = 4; break;
+		case ASMType::QUADWORD:
+		case ASMType::DOUBLE:	size = 8; break;
+		default: break;
+		}
+		function.stack_size = (function.stack_size + size * count + size - 1) / size * size;
+		return std::make_shared<PseudoOperandNode>(-static_cast<int>(function.stack_size));
 	}
 
-	ptr<MoveInstructionNode> CodeGenerator::mov(ptr<ASMOperandNode> source, ptr<ASMOperandNode> destination) {
-		return std::make_shared<MoveInstructionNode>(source, destination);
+	ptr<MoveInstructionNode> CodeGenerator::mov(ptr<ASMOperandNode> source, ptr<ASMOperandNode> destination, ASMType type) {
+		return std::make_shared<MoveInstructionNode>(source, destination, type);
 	}
 
 	ptr<ReturnInstructionNode> CodeGenerator::ret() {
 		return std::make_shared<ReturnInstructionNode>();
 	}
 
-	ptr<CompareInstructionNode> CodeGenerator::cmp(ptr<ASMOperandNode> source, ptr<ASMOperandNode> destination) {
-		return std::make_shared<CompareInstructionNode>(source, destination);
+	ptr<CompareInstructionNode> CodeGenerator::cmp(ptr<ASMOperandNode> source, ptr<ASMOperandNode> destination, ASMType type) {
+		return std::make_shared<CompareInstructionNode>(source, destination, type);
 	}
 
-	ptr<SetConditionalNode> CodeGenerator::set(BinaryOperation operation, ptr<ASMOperandNode> destination) {
-		return std::make_shared<SetConditionalNode>(operation, destination);
+	ptr<SetConditionalNode> CodeGenerator::set(BinaryOperation operation, ptr<ASMOperandNode> destination, bool floating) {
+		return std::make_shared<SetConditionalNode>(operation, destination, floating);
 	}
 
-	ptr<IntegerOperandNode> CodeGenerator::integer(int integer) {
+	ptr<IntegerOperandNode> CodeGenerator::integer(int64_t integer) {
 		return std::make_shared<IntegerOperandNode>(integer);
 	}
 
@@ -271,24 +478,28 @@ namespace Anthem {
 		return std::make_shared<StackOperandNode>(amount);
 	}
 
-	ptr<SignExtendInstructionNode> CodeGenerator::sign_extend() {
-		return std::make_shared<SignExtendInstructionNode>();
+	ptr<SignExtendInstructionNode> CodeGenerator::sign_extend(ASMType type) {
+		return std::make_shared<SignExtendInstructionNode>(type);
+	}
+
+	ptr<DivideInstructionNode> CodeGenerator::div(ptr<ASMOperandNode> operand, ASMType type) {
+		return std::make_shared<DivideInstructionNode>(operand, type);
 	}
 
-	ptr<DivideInstructionNode> CodeGenerator::div(ptr<ASMOperandNode> operand) {
-		return std::make_shared<DivideInstructionNode>(operand);
+	ptr<ConvertInstructionNode> CodeGenerator::convert(ptr<ASMOperandNode> source, ptr<ASMOperandNode> destination, ASMType source_type, ASMType destination_type, bool zero_extend) {
+		return std::make_shared<ConvertInstructionNode>(source, destination, source_type, destination_type, zero_extend);
 	}
 
 	ptr<ASMCallNode> CodeGenerator::call(const Name& label, bool is_external) {
 		return std::make_shared<ASMCallNode>(label, is_external);
 	}
 
-	ptr<JumpInstructionNode> CodeGenerator::jmp(const Name& label) {
+	ptr<JumpInstructionNode> CodeGenerator::jmp(LabelId label) {
 		return std::make_shared<JumpInstructionNode>(label);
 	}
 
-	ptr<JumpConditionalNode> CodeGenerator::jmpc(BinaryOperation condition, const Name& label) {
-		return std::make_shared<JumpConditionalNode>(condition, label);
+	ptr<JumpConditionalNode> CodeGenerator::jmpc(BinaryOperation condition, LabelId label, bool is_unsigned) {
+		return std::make_shared<JumpConditionalNode>(condition, label, is_unsigned);
 	}
 
 	ptr<AllocateStackNode> CodeGenerator::stack_alloc(int amount) {
@@ -308,12 +519,12 @@ namespace Anthem {
 	}
 
 	void CodeGenerator::generate_jump_if_zero(ptr<AIRJumpIfZeroInstructionNode> jump_node, ASMInstructionList& list_output) {
-		instr(cmp(integer(0), resolve_value(jump_node->condition)));
+		instr(cmp(integer(0), resolve_value(jump_node->condition), asm_type(jump_node->condition->type)));
 		instr(jmpc(BinaryOperation::EQUAL, jump_node->label));
 	}
 
 	void CodeGenerator::generate_jump_if_not_zero(ptr<AIRJumpIfNotZeroInstructionNode> jump_node, ASMInstructionList& list_output) {
-		instr(cmp(integer(0), resolve_value(jump_node->condition)));
+		instr(cmp(integer(0), resolve_value(jump_node->condition), asm_type(jump_node->condition->type)));
 		instr(jmpc(BinaryOperation::NOT_EQUAL, jump_node->label));
 	}
 
@@ -322,37 +533,32 @@ namespace Anthem {
 	}
 
 	void CodeGenerator::generate_call(ptr<AIRFunctionCallNode> call_node, ASMInstructionList& list_output) {
-		// System V Calling Convention sets 6 registers before allocating passed arguments to stack, Microsoft's requires 4
-		uint8_t registers_to_set = (m_compile_for_windows ? 4 : 6);
-		using R = Register;
-
-		std::vector<Register> argument_registers = (m_compile_for_windows)
-			? std::vector<Register>{ R::ECX, R::EDX, R::R8D, R::R9D }	// <- Microsoft ABI
-			: std::vector<Register>{ R::EDI, R::ESI, R::EDX, R::ECX, R::R8D, R::R9D };	// <- System V ABI
-		uint32_t args_size = call_node->value_list.size();
-		uint32_t stack_argument_size = args_size - registers_to_set;
-		if (stack_argument_size < 0) stack_argument_size = 0;
-
-		// Padding to adjust stack alignment for calling convention
-		int8_t stack_padding = (args_size % 2 == 0 ? 0 : 8);
-		if (!stack_padding) instr(stack_alloc(stack_padding));
+		auto registers = argument_registers(call_node->value_list);
+		std::vector<ptr<AIRVariableValueNode>> stack_arguments;
+		for (size_t i = 0; i < registers.size(); i++)
+			if (!registers[i])
+				stack_arguments.push_back(call_node->value_list[i]);
 
-		uint32_t register_index = 0;
+		// Padding to keep the stack 16 byte aligned at the call, every stack argument takes 8 bytes
+		int stack_padding = (stack_arguments.size() % 2 == 0 ? 0 : 8);
+		if (stack_padding) instr(stack_alloc(stack_padding));
 
 		// Pass Arguments first to registers
-		for (uint8_t i = 0; i < args_size && i < registers_to_set; i++) {
-			R reg = argument_registers[i];
-			auto assembly_arg = resolve_value(call_node->value_list[i]);
-			instr(mov(assembly_arg, std::make_shared<RegisterOperandNode>(reg)));
+		for (size_t i = 0; i < registers.size(); i++) {
+			if (!registers[i])
+				continue;
+			auto& argument = call_node->value_list[i];
+			instr(mov(resolve_value(argument), std::make_shared<RegisterOperandNode>(*registers[i]), asm_type(argument->type)));
 		}
 
-		// Push any remaining Arguments to the stack
-		for (uint8_t i = registers_to_set; i < args_size; i++) {
-			auto assembly_arg = resolve_value(call_node->value_list[i]);
+		// Push any remaining Arguments to the stack, the last one first
+		for (auto argument = stack_arguments.rbegin(); argument != stack_arguments.rend(); argument++) {
+			auto assembly_arg = resolve_value(*argument);
 			if(assembly_arg->get_type() == ASMNodeType::REGISTER || assembly_arg->get_type() == ASMNodeType::INTEGER)
 				instr(push(assembly_arg));
 			else {
-				instr(mov(assembly_arg, REGISTER(EAX)));
+				// Floating point values are pushed through a general purpose register as well
+				instr(mov(assembly_arg, REGISTER(EAX), integer_type(asm_type((*argument)->type))));
 				instr(push(REGISTER(EAX)));
 			}
 		}
@@ -360,27 +566,24 @@ namespace Anthem {
 		instr(call(call_node->function, call_node->is_external));
 
 		// Adjust SP (Stack Pointer)
-		uint32_t bytes_to_remove = 8 * stack_argument_size + stack_padding;
+		uint32_t bytes_to_remove = 8 * static_cast<uint32_t>(stack_arguments.size()) + stack_padding;
 		if (bytes_to_remove) instr(stack_dealloc(bytes_to_remove));
 
+		ASMType type = asm_type(call_node->destination->type);
 		auto assembly_dest = resolve_value(call_node->destination);
-		instr(mov(REGISTER(EAX), assembly_dest));
+		instr(mov(is_floating(type) ? REGISTER(XMM0) : REGISTER(EAX), assembly_dest, type));
 	}
 
 	void CodeGenerator::replace_pseudo_registers() {
 		for (auto& function : m_functions) {
-			// Allocate Stack Size 4 times the pseudo registers the function has (each one is 4 bytes)
-			uint64_t to_allocate = function.pseudo_registers.size() * 4;
+			// Allocate the bytes taken by the stack slots of the function
+			uint64_t to_allocate = function.stack_size;
 			// And round it up to nearest multiple of 16
 			uint8_t remainder = to_allocate % 16;
 			to_allocate += 16 - remainder;
 
+			// The offsets of the pseudo registers were already set when their slots were handed out
 			function.instructions->push_front(std::make_shared<AllocateStackNode>(to_allocate));
-			int offset = -4;
-			for (auto& [name, pointer] : function.pseudo_registers) {
-				pointer->stack_offset = offset;
-				offset -= 4;
-			}
 		}
 	}
 
@@ -391,75 +594,110 @@ namespace Anthem {
 			case ASMNodeType::FUNCTION:
 				ptr<ASMFunctionNode> function = std::static_pointer_cast<ASMFunctionNode>(declaration);
 				int index = 0;
+				// An instruction inserted before the current one is validated as well, followed by the current one again
+				auto insert_before = [&](ptr<ASMInstructionNode> instruction) {
+					function->instructions.insert(std::next(function->instructions.begin(), index), instruction);
+				};
+				auto insert_after = [&](ptr<ASMInstructionNode> instruction) {
+					function->instructions.insert(std::next(function->instructions.begin(), index + 1), instruction);
+				};
 				while (index < function->instructions.size()) {
 					auto instruction = function->instructions[index];
 					switch (instruction->get_type()) {
 					// Validate Move instructions
 						case ASMNodeType::MOVE: {
 							auto move_instruction = std::static_pointer_cast<MoveInstructionNode>(instruction);
+							// Floating point values that don't need an SSE register are moved as integers of the same size
+							if (is_floating(move_instruction->type)
+								&& (move_instruction->source->get_type() == ASMNodeType::INTEGER
+									|| (is_memory(move_instruction->source) && is_memory(move_instruction->destination))))
+								move_instruction->type = integer_type(move_instruction->type);
+
+							// Immediates can't be moved to SSE registers, and large ones only to general purpose registers
+							if (move_instruction->source->get_type() == ASMNodeType::INTEGER
+								&& (is_sse_register(move_instruction->destination)
+									|| (is_large_immediate(move_instruction->source) && is_memory(move_instruction->destination)))) {
+								insert_before(std::make_shared<MoveInstructionNode>(move_instruction->source, REGISTER(R10D), move_instruction->type));
+								move_instruction->source = REGISTER(R10D);
+								continue;
+							}
+
 							// If both operands are stack memory addresses, move value from first address to a scratch register
 							// and then move the value from the scratch register to the other memory address
-							if (move_instruction->source->get_type() == ASMNodeType::PSEUDO_OPERAND
-								&& move_instruction->destination->get_type() == ASMNodeType::PSEUDO_OPERAND) {
+							if (is_memory(move_instruction->source) && is_memory(move_instruction->destination)) {
 								auto destination = move_instruction->destination;
 								move_instruction->destination = REGISTER(R10D);
-								auto new_move_instruction = std::make_shared<MoveInstructionNode>(REGISTER(R10D), destination);
-								auto begin = function->instructions.begin();
-								function->instructions.insert(std::next(begin, index + 1), new_move_instruction);
+								insert_after(std::make_shared<MoveInstructionNode>(REGISTER(R10D), destination, move_instruction->type));
 							}
 							break;
 						}
 						case ASMNodeType::COMPARE: {
 							auto cmp_instruction = std::static_pointer_cast<CompareInstructionNode>(instruction);
-							// If both operands are stack memory addresses, move value from first address to a scratch register
-							// and then move the value from the scratch register to the other memory address
+							// Floating point comparisons can't take immediates
+							if (is_floating(cmp_instruction->type) && cmp_instruction->operand_a->get_type() == ASMNodeType::INTEGER) {
+								insert_before(std::make_shared<MoveInstructionNode>(cmp_instruction->operand_a, REGISTER(XMM15), cmp_instruction->type));
+								cmp_instruction->operand_a = REGISTER(XMM15);
+								continue;
+							}
+							if (is_large_immediate(cmp_instruction->operand_a)) {
+								insert_before(std::make_shared<MoveInstructionNode>(cmp_instruction->operand_a, REGISTER(R10D), cmp_instruction->type));
+								cmp_instruction->operand_a = REGISTER(R10D);
+								continue;
+							}
+							// The second operand can't be an immediate, move it to a scratch register first
 							if (cmp_instruction->operand_b->get_type() == ASMNodeType::INTEGER) {
-								auto destination = cmp_instruction->operand_b;
+								insert_before(std::make_shared<MoveInstructionNode>(cmp_instruction->operand_b, REGISTER(R11D), cmp_instruction->type));
 								cmp_instruction->operand_b = REGISTER(R11D);
-								auto new_move_instruction = std::make_shared<MoveInstructionNode>(destination, REGISTER(R11D));
-								auto begin = function->instructions.begin();
-								function->instructions.insert(std::next(begin, index), new_move_instruction);
+								continue;
 							}
-							if (cmp_instruction->operand_a->get_type() == ASMNodeType::PSEUDO_OPERAND
-								&& cmp_instruction->operand_b->get_type() == ASMNodeType::PSEUDO_OPERAND) {
-								auto source = cmp_instruction->operand_a;
+							// If both operands are stack memory addresses, move the first one to a scratch register
+							if (is_memory(cmp_instruction->operand_a) && is_memory(cmp_instruction->operand_b)) {
+								insert_before(std::make_shared<MoveInstructionNode>(cmp_instruction->operand_a, REGISTER(R10D), cmp_instruction->type));
 								cmp_instruction->operand_a = REGISTER(R10D);
-								auto new_move_instruction = std::make_shared<MoveInstructionNode>(source, REGISTER(R10D));
-								auto begin = function->instructions.begin();
-								function->instructions.insert(std::next(begin, index), new_move_instruction);
+								continue;
 							}
 							break;
 						}
 						case ASMNodeType::BINARY: {
 							auto binary_instruction = std::static_pointer_cast<BinaryInstructionNode>(instruction);
+							// SSE operations can't take immediates
+							if (is_floating(binary_instruction->type) && binary_instruction->operand_a->get_type() == ASMNodeType::INTEGER) {
+								insert_before(std::make_shared<MoveInstructionNode>(binary_instruction->operand_a, REGISTER(XMM15), binary_instruction->type));
+								binary_instruction->operand_a = REGISTER(XMM15);
+								continue;
+							}
+							if (is_large_immediate(binary_instruction->operand_a)) {
+								insert_before(std::make_shared<MoveInstructionNode>(binary_instruction->operand_a, REGISTER(R10D), binary_instruction->type));
+								binary_instruction->operand_a = REGISTER(R10D);
+								continue;
+							}
 							// If both operands are stack memory addresses, move value from first address to a scratch register
 							// and then move the value from the scratch register to the other memory address
-							if (binary_instruction->operand_a->get_type() == ASMNodeType::PSEUDO_OPERAND
-								&& binary_instruction->operand_b->get_type() == ASMNodeType::PSEUDO_OPERAND) {
+							if (is_memory(binary_instruction->operand_a) && is_memory(binary_instruction->operand_b)) {
 								auto destination = binary_instruction->operand_b;
 
 								// Move the second operand (which is also the destination) to a scratch register in order to operate on it
-								auto first_move_instruction = std::make_shared<MoveInstructionNode>(destination, REGISTER(R10D));
+								auto first_move_instruction = std::make_shared<MoveInstructionNode>(destination, REGISTER(R10D), binary_instruction->type);
 								auto begin = function->instructions.begin();
 								function->instructions.insert(std::next(begin, index), first_move_instruction);
 
 								// After the operation, move the the value held by the scratch register to the original destination
 								begin = function->instructions.begin();
-								auto second_move_instruction = std::make_shared<MoveInstructionNode>(REGISTER(R10D), destination);
+								auto second_move_instruction = std::make_shared<MoveInstructionNode>(REGISTER(R10D), destination, binary_instruction->type);
 								function->instructions.insert(std::next(begin, index + 2), second_move_instruction);
 
 								// Change the destination of the operation to the scratch register
 								binary_instruction->operand_b = REGISTER(R10D);
 							}
 							if (binary_instruction->binary_operation == BinaryOperation::MULTIPLICATION
-								&& binary_instruction->operand_b->get_type() == ASMNodeType::PSEUDO_OPERAND) {
+								&& is_memory(binary_instruction->operand_b)) {
 								auto destination = binary_instruction->operand_b;
-								auto set_move_instruction = std::make_shared<MoveInstructionNode>(destination, REGISTER(R11D));
+								auto set_move_instruction = std::make_shared<MoveInstructionNode>(destination, REGISTER(R11D), binary_instruction->type);
 								auto begin = function->instructions.begin();
 								function->instructions.insert(std::next(begin, index), set_move_instruction);
 								binary_instruction->operand_b = REGISTER(R11D);
 								begin = function->instructions.begin();
-								auto retrieve_move_instruction = std::make_shared<MoveInstructionNode>(REGISTER(R11D), destination);
+								auto retrieve_move_instruction = std::make_shared<MoveInstructionNode>(REGISTER(R11D), destination, binary_instruction->type);
 								function->instructions.insert(std::next(begin, index + 2), retrieve_move_instruction);
 							}
 							break;
@@ -471,7 +709,7 @@ namespace Anthem {
 							if (div_instruction->operand->get_type() == ASMNodeType::INTEGER) {
 								auto begin = function->instructions.begin();
 								auto source = div_instruction->operand;
-								auto new_move_instruction = std::make_shared<MoveInstructionNode>(source, REGISTER(R10D));
+								auto new_move_instruction = std::make_shared<MoveInstructionNode>(source, REGISTER(R10D), div_instruction->type);
 								function->instructions.insert(std::next(begin, index), new_move_instruction);
 								div_instruction->operand = REGISTER(R10D);
 							}
@@ -483,4 +721,4 @@ namespace Anthem {
 			}
 		}
 	}
-}
\ No newline at end of file
+}
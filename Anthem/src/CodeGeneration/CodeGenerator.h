@@ -3,6 +3,7 @@
 // Copyright (c) 2024-present, Stylianos Kementzetzidis
 
 #pragma once
+#include <optional>
 #include "Utilities/Error.h"
 #include "ASMProgramStruct.h"
 #include "AIR/AIR.h"
@@ -37,19 +38,29 @@ namespace Anthem {
 		void generate_jump_if_not_zero(ptr<AIRJumpIfNotZeroInstructionNode> jump_node, ASMInstructionList& list_output);
 		void generate_label(ptr<AIRLabelNode> label_node, ASMInstructionList& list_output);
 		void generate_call(ptr<AIRFunctionCallNode> call_node, ASMInstructionList& list_output);
+		void generate_convert(ptr<AIRConvertInstructionNode> convert_node, ASMInstructionList& list_output);
+
+		// Operand of the element a load or store accesses. A non-constant index is moved to RCX and, unless it was proven
+		// to be in bounds, compared to the length of the array, jumping to the trap of the function if it is out of bounds
+		ptr<IndexedOperandNode> element_operand(ptr<AIRElementInstructionNode> element, ASMInstructionList& list_output);
+
+		// Register each argument of a call (or parameter of a function) is passed in, the ones without a register
+		// are passed on the stack in order
+		std::vector<std::optional<Register>> argument_registers(const ValueList& arguments);
 
 		// -- Simple Instruction Generation -- (Create a Shared Ptr)
 
-		ptr<MoveInstructionNode> mov(ptr<ASMOperandNode> source, ptr<ASMOperandNode> destination);
+		ptr<MoveInstructionNode> mov(ptr<ASMOperandNode> source, ptr<ASMOperandNode> destination, ASMType type = ASMType::LONGWORD);
 		ptr<ReturnInstructionNode> ret();
-		ptr<CompareInstructionNode> cmp(ptr<ASMOperandNode> source, ptr<ASMOperandNode> destination);
-		ptr<SetConditionalNode> set(BinaryOperation operation, ptr<ASMOperandNode> destination);
-		ptr<IntegerOperandNode> integer(int integer);
+		ptr<CompareInstructionNode> cmp(ptr<ASMOperandNode> source, ptr<ASMOperandNode> destination, ASMType type = ASMType::LONGWORD);
+		ptr<SetConditionalNode> set(BinaryOperation operation, ptr<ASMOperandNode> destination, bool floating = false);
+		ptr<IntegerOperandNode> integer(int64_t integer);
 		ptr<StackOperandNode> stack(int amount);
-		ptr<SignExtendInstructionNode> sign_extend();
-		ptr<DivideInstructionNode> div(ptr<ASMOperandNode> operand);
-		ptr<JumpInstructionNode> jmp(const Name& label);
-		ptr<JumpConditionalNode> jmpc(BinaryOperation condition, const Name& label);
+		ptr<SignExtendInstructionNode> sign_extend(ASMType type = ASMType::LONGWORD);
+		ptr<DivideInstructionNode> div(ptr<ASMOperandNode> operand, ASMType type = ASMType::LONGWORD);
+		ptr<ConvertInstructionNode> convert(ptr<ASMOperandNode> source, ptr<ASMOperandNode> destination, ASMType source_type, ASMType destination_type, bool zero_extend = false);
+		ptr<JumpInstructionNode> jmp(LabelId label);
+		ptr<JumpConditionalNode> jmpc(BinaryOperation condition, LabelId label, bool is_unsigned = false);
 		ptr<AllocateStackNode> stack_alloc(int amount);
 		ptr<ASMDeallocateStackNode> stack_dealloc(int amount);
 		ptr<ASMPushStackNode> push(ptr<ASMOperandNode> operand);
@@ -59,7 +70,9 @@ namespace Anthem {
 		ptr<ASMOperandNode> resolve_value(ptr<AIRValueNode> expression);
 
 		ptr<PseudoOperandNode> make_pseudo_register(ptr<AIRVariableValueNode> variable);
-		ptr<PseudoOperandNode> make_pseudo_register(const Name& variable);
+
+		// Give the current function a new stack slot for <count> values, sized and aligned for <type>
+		ptr<PseudoOperandNode> new_stack_slot(ASMType type, uint32_t count = 1);
 
 		// -- Subsequent Passes --
 
@@ -68,8 +81,17 @@ namespace Anthem {
 	private:
 		struct FunctionInfo {
 			ASMInstructionList* instructions{ nullptr };
-			std::unordered_map<Name, ptr<PseudoOperandNode>> pseudo_registers{};
+			std::unordered_map<VarId, ptr<PseudoOperandNode>> locals{};
+
+			// Temporaries are numbered from 0 in every function, so they are indexed directly
+			std::vector<ptr<PseudoOperandNode>> temporaries{};
 			std::unordered_map<Name, ptr<PseudoOperandNode>> flagged_vars{};
+
+			// Bytes taken by the stack slots
+			uint32_t stack_size{ 0 };
+
+			// Some array index is checked, so the function ends with the trap the checks jump to
+			bool bounds_checked{ false };
 		};
 
 		ErrorHandler* m_error_handler;
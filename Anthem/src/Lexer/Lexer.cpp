@@ -3,58 +3,56 @@
 // Copyright (c) 2024-present, Stylianos Kementzetzidis
 
 #include "Lexer.h"
+#include "Scanner.h"
 #include <iostream>
+#include <charconv>
+#include <algorithm>
 
 namespace Anthem {
-	Lexer::Lexer(ErrorHandler* error_handler) : m_error_handler{ error_handler } {}
+	Lexer::Lexer(ErrorHandler* error_handler, SourceManager* source_manager) 
+		: m_error_handler{ error_handler }, m_source_manager{ source_manager } {}
 
 	const std::vector<Token>& Lexer::get_tokens() {
 		return m_tokens;
 	}
 
 	void Lexer::pretty_print() {
-		pretty_print(m_tokens);
+		pretty_print(m_tokens, *m_source_manager);
 	}
 
-	void Lexer::pretty_print(const std::vector<Token>& tokens) {
+	void Lexer::pretty_print(const std::vector<Token>& tokens, const SourceManager& source_manager) {
 		// Pretty prints in this format: "<Line>     | <TokenType>     | <TokenValue>"
 		std::cout << "Line:\t  TokenType:\t  Value:\n";
 		
 		// First line is set to an impossible number in order to be updated immediately at the start of the loop
 		int current_line = -1;
+
 		for (auto& token : tokens) {
+			int line = int(source_manager.get_line(token.position()));
+
 			// Output 'Repeating' Symbol '|' if the line did not change since the previous token
-			if (token.position.src_line != current_line) {
-				current_line = token.position.src_line;
+			if (line != current_line) {
+				current_line = line;
 				std::cout << current_line;
 			}
 			else
 				std::cout << '|';
-			std::cout << "\t| " << token.type << "\t\t| " << token.value << "\n";
+			std::cout << "\t| " << int(token.type) << "\t\t| " << source_manager.get_text(token.file_id, token.offset, token.size()) << "\n";
 		}
 	}
 
 	void Lexer::advance(uint32_t times) {
-		// If new index does not exceed the length of the source file then set the current character
-		// to the one of the source string at the new index, else set it to a null character, indicating End of File
-		for (uint32_t i = 0; i < times; i++) {
-			m_current_source_index++;
-			if (m_current_source_index < m_source_code.size())
-				m_current_char = m_source_code[m_current_source_index];
-			else
-				m_current_char = '\0';
-			m_current_position.src_start_index = m_current_source_index;
-			m_current_position.src_end_index = m_current_source_index;
-		}
+		// The source buffer ends with a null character sentinel (followed by zero padding), which stops every scanning
+		// loop before it could run past the end, so no bounds checks are needed here
+		m_current_source_index += times;
+		m_current_char = m_source_code.data()[m_current_source_index];
+		m_current_position.src_start_index = m_current_source_index;
+		m_current_position.src_end_index = m_current_source_index;
 	}
 
 	char Lexer::peek(uint32_t depth) {
-		// If current index + depth does not exceed the length of the source file then return the character
-		// of the source string at the desired index, else set return a null character
-		if (m_current_source_index + depth < m_source_code.size())
-			return m_source_code[m_current_source_index + depth];
-		else
-			return '\0';
+		// Reading past the end of the source lands in the zero padding of the buffer, returning a null character
+		return m_source_code.data()[m_current_source_index + depth];
 	}
 
 	bool Lexer::match(char character) {
@@ -65,55 +63,47 @@ namespace Anthem {
 		return false;
 	}
 
+	Token Lexer::make_token(TokenType type, uint32_t start_index) {
+		Token token{ type, m_file_id, start_index, m_current_source_index - start_index + 1 };
+		advance();
+		return token;
+	}
+
 	char Lexer::current_character() {
 		// Accessing current character through a function in case other functionality is needed here
 		return m_current_char;
 	}
 
 	void Lexer::handle_whitespace() {
-		// While current character is whitespace, skip it
+		// Most tokens directly follow another one, so avoid calling into the scanner for them
+		char character = current_character();
+		if (character != ' ' && character != '\t' && character != '\n' && character != '/')
+			return;
+
+		// Whitespace and comment bodies are skipped in runs by the vectorized scanner, only the position
+		// they end at is stored, instead of advancing one character at a time
+		const char* start = m_source_code.data() + m_current_source_index;
+		const char* current = start;
 		while (true) {
-			switch (current_character())
-			{
-			// If character is space or tab just advance
-			case ' ':
-			case '\t':
-				advance();
+			current = scan_whitespace(current);
+			if (current[0] != '/')
 				break;
-			// In case of a newline, increase the current line index
-			case '\n':
-				m_current_line++;
-				m_current_position.src_line = m_current_line;
-				advance();
-				break;
-			case '/':
-				// Handle Single-Line comments
-				if (peek() == '/') {
-					while (current_character() != '\n' || current_character() == '\0')
-						advance();
-					advance();
-					continue;
-				}
-				// Handle Multi-Line comments
-				else if (peek() == '*') {
-					while (true) {
-						if (current_character() == '\0')
-							return;
-						if (current_character() == '*' && peek() == '/') {
-							advance(2);
-							break;
-						}
-						advance();
-					}
-					continue;
-				}
-				// If the slash turned out to not be a comment, stop checking for whitespace
-				else
-					return;
-			default:
-				return;
+
+			// Handle Single-Line comments, the newline is skipped as whitespace on the next iteration
+			if (current[1] == '/')
+				current = find_line_end(current + 2);
+			// Handle Multi-Line comments, the search starts at the '*' of "/*" so "/*/" closes the comment
+			else if (current[1] == '*') {
+				current = find_comment_end(current + 1);
+				if (*current == '\0')
+					break;
+				current += 2;
 			}
+			// If the slash turned out to not be a comment, stop checking for whitespace
+			else
+				break;
 		}
+		advance(uint32_t(current - start));
 	}
 
 	Token Lexer::lex() {
@@ -124,98 +114,145 @@ namespace Anthem {
 		if (is_letter(current_character())) return make_name_token();
 
 		Position position = m_current_position;
-
-		// Position that has the end index increased, in case the Token will be of double characters
-		Position next_position = position;
-		next_position.src_end_index++;
-
-		Token to_return;
+		uint32_t start = m_current_source_index;
 
 		switch (current_character())
 		{
-		case '(':	advance(); return Token{ LEFT_PARENTHESIS, "(", position };
-		case ')':	advance(); return Token{ RIGHT_PARENTHESIS, ")", position };
-		case '{':	advance(); return Token{ LEFT_BRACE, "{", position };
-		case '}':	advance(); return Token{ RIGHT_BRACE, "}", position };
-		case '[':	advance(); return Token{ LEFT_BRACKET, "[", position };
-		case ']':	advance(); return Token{ RIGHT_BRACKET, "]", position };
-		case ';':	advance(); return Token{ SEMICOLON, ";", position };
-		case ',':	advance(); return Token{ COMMA, ",", position };
-		case '.':	advance(); return Token{ DOT, ".", position };
-		case '^':	advance(); return Token{ CAP, "^", position };
-		case '&':	advance(); return Token{ AMPERSAND, "&", position };
-		case '~':	advance(); return Token{ TILDE, "~", position };
-		case '%':	advance(); return Token{ PERCENT, "%", position };
-		case ':':	advance(); return Token{ COLON, ":", position };
+		case '(':	return make_token(LEFT_PARENTHESIS, start);
+		case ')':	return make_token(RIGHT_PARENTHESIS, start);
+		case '{':	return make_token(LEFT_BRACE, start);
+		case '}':	return make_token(RIGHT_BRACE, start);
+		case '[':	return make_token(LEFT_BRACKET, start);
+		case ']':	return make_token(RIGHT_BRACKET, start);
+		case ';':	return make_token(SEMICOLON, start);
+		case ',':	return make_token(COMMA, start);
+		case '.':	return make_token(DOT, start);
+		case '^':	return make_token(CAP, start);
+		case '&':	return make_token(AMPERSAND, start);
+		case '~':	return make_token(TILDE, start);
+		case '%':	return make_token(PERCENT, start);
+		case ':':	return make_token(COLON, start);
 		// Check for double character tokens
-		case '+':	to_return = match('=') ? Token{ PLUS_EQUAL, "+=", next_position } : Token{ PLUS, "+", position }; advance(); return to_return;
-		case '-':	/* Match Arrow */ if (match('>')) { advance(); return Token{ARROW, "->", next_position}; }
-					to_return = match('=') ? Token{ MINUS_EQUAL, "-=", next_position } : Token{ MINUS, "-", position }; advance(); return to_return;
-		case '*':	to_return = match('=') ? Token{ STAR_EQUAL, "*=", next_position } : Token{ STAR, "*", position }; advance(); return to_return;
-		case '/':	to_return = match('=') ? Token{ SLASH_EQUAL, "/=", next_position } : Token{ SLASH, "/", position }; advance(); return to_return;
-		case '!':	to_return = match('=') ? Token{ BANG_EQUAL, "!=", next_position } : Token{ BANG, "!", position }; advance(); return to_return;
-		case '=':	to_return = match('=') ? Token{ EQUAL_EQUAL, "==", next_position } : Token{ EQUAL, "=", position }; advance(); return to_return;
-		case '<':	to_return = match('=') ? Token{ LESS_EQUAL, "<=", next_position } : Token{ LESS, "<", position }; advance(); return to_return;
-		case '>':	to_return = match('=') ? Token{ GREATER_EQUAL, ">=", next_position } : Token{ GREATER, ">", position }; advance(); return to_return;
+		case '+':	return make_token(match('=') ? PLUS_EQUAL : PLUS, start);
+		case '-':	/* Match Arrow */ if (match('>')) return make_token(ARROW, start);
+					return make_token(match('=') ? MINUS_EQUAL : MINUS, start);
+		case '*':	return make_token(match('=') ? STAR_EQUAL : STAR, start);
+		case '/':	return make_token(match('=') ? SLASH_EQUAL : SLASH, start);
+		case '!':	return make_token(match('=') ? BANG_EQUAL : BANG, start);
+		case '=':	return make_token(match('=') ? EQUAL_EQUAL : EQUAL, start);
+		case '<':	return make_token(match('=') ? LESS_EQUAL : LESS, start);
+		case '>':	return make_token(match('=') ? GREATER_EQUAL : GREATER, start);
 		case '"':	return make_string_token();
-		case '\0':	return Token{ SPECIAL_EOF, "EOF", position };
+		case '\0':	return Token{ SPECIAL_EOF, m_file_id, start, 0 };
 		default:
 			break;
 		}
 
 		// If this part of the code is reached, then the current character does not match any known one, report an error
 		m_error_handler->report_error(Error{ std::format("Unkown Character '{0}'", current_character()), position });
-		return Token{SPECIAL_ERROR, "", position};
+		return Token{ SPECIAL_ERROR, m_file_id, start, 1 };
 	}
 
 	Token Lexer::make_number_token() {
-		std::string number_value{ "" };
-		bool is_floating_point{ false };
+		// Store start index
+		uint32_t start = m_current_source_index;
+
+		// Accumulate the integer part while skipping over its digits, remembering if it stops fitting in 64 bits
+		uint64_t mantissa = 0;
+		uint32_t mantissa_digits = 0;
+		bool overflow = false;
+		while (is_digit(current_character())) {
+			uint64_t digit = current_character() - '0';
+			if (mantissa > (INT64_MAX - digit) / 10)
+				overflow = true;
+			else
+				mantissa = mantissa * 10 + digit;
 
-		// Store position for start index
-		Position position = m_current_position;
+			// Leading zeros do not count towards the precision of floating point literals
+			if (mantissa)
+				mantissa_digits++;
+			advance();
+		}
 
-		// Make a number from all digits next to eachother in the string
-		while (is_digit(current_character()) || current_character() == '.') {
-			if (current_character() == '.') {
-				// If there was already a dot in this number, report an unexpected dot error
-				if (is_floating_point) {
-					m_error_handler->report_error(Error{ "Unexpected '.'", m_current_position });
-					return Token{SPECIAL_ERROR, "Unexpected '.'", m_current_position };
-				}
-				else {
-					is_floating_point = true;
-					number_value += current_character();
-					advance();
+		bool is_floating_point = current_character() == '.';
+		uint32_t fraction_digits = 0;
+		if (is_floating_point) {
+			advance();
+			while (is_digit(current_character())) {
+				if (mantissa_digits < 19) {
+					mantissa = mantissa * 10 + (current_character() - '0');
+					if (mantissa)
+						mantissa_digits++;
+					fraction_digits++;
 				}
-			}
-			else {
-				number_value += current_character();
+				else
+					mantissa_digits++;
 				advance();
 			}
+
+			// If there was already a dot in this number, report an unexpected dot error
+			if (current_character() == '.') {
+				m_error_handler->report_error(Error{ "Unexpected '.'", m_current_position });
+				return Token{ SPECIAL_ERROR, m_file_id, uint32_t(m_current_source_index), 1 };
+			}
 		}
 
-		position.src_end_index = m_current_source_index - 1;
+		// Floating point literals with an 'f' suffix are f32
+		bool is_single = is_floating_point && current_character() == 'f';
+		if (is_single)
+			advance();
 
-		return is_floating_point ? Token{ TYPE_F32, number_value, position } : Token{ TYPE_I32, number_value, position };
-	}
+		uint32_t length = m_current_source_index - start;
+		Position position{ m_file_id, start, uint32_t(m_current_source_index - 1) };
+		if (length > Token::MAX_LITERAL_LENGTH) {
+			m_error_handler->report_error(Error{ "Numeric literal is too long", position });
+			return Token{ SPECIAL_ERROR, m_file_id, start, length };
+		}
 
-	Token Lexer::make_name_token() {
-		std::string name_string{ "" };
+		if (!is_floating_point) {
+			if (overflow) {
+				m_error_handler->report_error(Error{ "Integer literal is too large to fit in 64 bits", position });
+				return Token{ SPECIAL_ERROR, m_file_id, start, length };
+			}
+			// Literals get the smallest width that holds them
+			TokenType type = mantissa <= INT32_MAX ? TYPE_I32 : TYPE_I64;
+			return Token::make_integer(type, m_file_id, start, uint8_t(length), int64_t(mantissa));
+		}
 
-		// Store position for start index
-		Position position = m_current_position;
+		// f32 literals are rounded to the nearest f32 from their text, rounding through the nearest f64 could be off by one
+		if (is_single) {
+			float single = 0;
+			std::string_view text = m_source_code.substr(start, length - 1);
+			std::from_chars(text.data(), text.data() + text.size(), single);
+			return Token::make_floating(TYPE_F32, m_file_id, start, uint8_t(length), single);
+		}
 
-		// Make name from all characters next to eachother in the string
-		while (is_alphanumeric(current_character())) {
-			name_string += current_character();
-			advance();
+		// Fast path: the mantissa and the power of ten are both exact doubles, so a single division is correctly rounded
+		static constexpr double powers_of_ten[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+		double value = 0;
+		if (!overflow && mantissa_digits <= 15 && fraction_digits <= 22)
+			value = double(mantissa) / powers_of_ten[fraction_digits];
+		else {
+			std::string_view text = m_source_code.substr(start, length);
+			std::from_chars(text.data(), text.data() + text.size(), value);
 		}
+		return Token::make_floating(TYPE_F64, m_file_id, start, uint8_t(length), value);
+	}
+
+	Token Lexer::make_name_token() {
+		// Store start index
+		uint32_t start = m_current_source_index;
 
-		position.src_end_index = m_current_source_index;
+		// Make name from all characters next to eachother in the string
+		const char* name = m_source_code.data() + start;
+		uint32_t length = uint32_t(scan_identifier(name) - name);
+		advance(length);
 
-		TokenType keyword_type = get_keyword(name_string);
-		return keyword_type == NO_TYPE ? Token{ IDENTIFIER, name_string, position } : Token{ keyword_type, name_string, position};
+		TokenType keyword_type = get_keyword(m_source_code.substr(start, length));
+		return Token{ keyword_type == NO_TYPE ? IDENTIFIER : keyword_type, m_file_id, start, length };
 	}
 
 	Token Lexer::make_string_token() {
@@ -223,21 +260,135 @@ namespace Anthem {
 		return Token{};
 	}
 
-	const std::vector<Token>& Lexer::analyze(const std::string& source, const std::filesystem::path& file_path) {
+	void Lexer::begin(FileID file_id, uint32_t start_index) {
 		// Reset internal values
-		m_current_source_index = -1;
-		m_source_code = source;
-		m_current_line = 0;
-		m_current_position.src_file_path = file_path;
-		m_tokens.clear();
+		m_current_source_index = int(start_index) - 1;
+		m_finished = false;
+		m_file_id = file_id;
+		m_source_code = m_source_manager->get_source(file_id);
+		m_current_position = Position{ file_id };
 
 		advance();
+	}
+
+	Token Lexer::next_token() {
+		if (m_finished || current_character() == '\0') {
+			m_finished = true;
+			return Token{ SPECIAL_EOF, m_file_id, uint32_t(m_current_source_index), 0 };
+		}
+
+		// Lexing stops at the first error, like the rest of the compilation phases
+		Token token = lex();
+		if (token.type == SPECIAL_EOF || token.type == SPECIAL_ERROR)
+			m_finished = true;
+		return token;
+	}
+
+	const std::vector<Token>& Lexer::analyze(FileID file_id) {
+		begin(file_id);
+		m_tokens.clear();
 
 		// Lex until End of File
-		while (current_character() != '\0' && !m_error_handler->has_errors())
-			m_tokens.push_back(lex());
-		
-		m_tokens.push_back(Token{SPECIAL_EOF, "EOF", m_current_position});
+		do
+			m_tokens.push_back(next_token());
+		while (!m_finished);
+
+		if (m_tokens.back().type != SPECIAL_EOF)
+			m_tokens.push_back(next_token());
+
+		return m_tokens;
+	}
+
+	void Lexer::lex_chunk(FileID file_id, Chunk& chunk) {
+		ErrorHandler chunk_error_handler{ m_source_manager };
+		ErrorHandler* error_handler = m_error_handler;
+		m_error_handler = &chunk_error_handler;
+
+		begin(file_id, chunk.start_index);
+		chunk.tokens.clear();
+
+		// The previous chunk skips the whitespace and comments at its end past the boundary, e.g. the indentation of the next line
+		handle_whitespace();
+		chunk.first_token_index = m_current_source_index;
+		while (true) {
+			// Whitespace and comments are skipped first, so a Token starting right after the chunk is left to the next one
+			handle_whitespace();
+			if (uint32_t(m_current_source_index) >= chunk.end_index)
+				break;
+
+			chunk.tokens.push_back(next_token());
+			if (m_finished)
+				break;
+		}
+		chunk.resume_index = m_current_source_index;
+		chunk.finished = m_finished;
+		chunk.errors = chunk_error_handler.get_errors();
+
+		m_error_handler = error_handler;
+	}
+
+	const std::vector<Token>& Lexer::analyze_parallel(FileID file_id, ThreadPool& thread_pool) {
+		std::string_view source = m_source_manager->get_source(file_id);
+		m_relexed_chunks = 0;
+
+		// A few chunks per thread even out the differences in how long each chunk takes
+		size_t chunk_count = std::min(thread_pool.size() * 4, source.size() / MIN_CHUNK_SIZE);
+		if (thread_pool.size() < 2 || chunk_count < 2)
+			return analyze(file_id);
+
+		// Chunks end right after a newline, where lexing is almost always in its starting state
+		std::vector<Chunk> chunks;
+		uint32_t chunk_start = 0;
+		for (size_t i = 1; i <= chunk_count && chunk_start < source.size(); i++) {
+			uint32_t chunk_end = uint32_t(source.size());
+			if (i < chunk_count) {
+				size_t newline = source.find('\n', std::max<size_t>(source.size() * i / chunk_count, chunk_start));
+				if (newline != std::string_view::npos)
+					chunk_end = uint32_t(newline + 1);
+			}
+			Chunk chunk;
+			chunk.start_index = chunk_start;
+			chunk.end_index = chunk_end;
+			chunks.push_back(std::move(chunk));
+			chunk_start = chunk_end;
+		}
+
+		// Every chunk speculates that it starts outside of any comment or Token
+		thread_pool.parallel_for(chunks.size(), [&](size_t i) {
+			Lexer chunk_lexer(nullptr, m_source_manager);
+			chunk_lexer.lex_chunk(file_id, chunks[i]);
+			});
+
+		// Join the chunks in order. A chunk speculated right if the previous one stopped at its start or after the whitespace
+		// and comments it starts with, otherwise (e.g. a comment spanning the boundary) it is lexed again from where the previous one stopped
+		m_tokens.clear();
+		size_t token_count = 0;
+		for (const Chunk& chunk : chunks)
+			token_count += chunk.tokens.size();
+		m_tokens.reserve(token_count + 1);
+
+		uint32_t resume_index = 0;
+		for (Chunk& chunk : chunks) {
+			if (chunk.start_index != resume_index && chunk.first_token_index != resume_index) {
+				if (resume_index >= chunk.end_index)
+					continue;
+				chunk.start_index = resume_index;
+				lex_chunk(file_id, chunk);
+				m_relexed_chunks++;
+			}
+
+			m_tokens.insert(m_tokens.end(), chunk.tokens.begin(), chunk.tokens.end());
+			for (const Error& error : chunk.errors)
+				m_error_handler->report_error(error);
+			resume_index = chunk.resume_index;
+
+			// Chunks after the End of File or an error are never reached by the serial Lexer either
+			if (chunk.finished)
+				break;
+		}
+
+		if (m_tokens.empty() || m_tokens.back().type != SPECIAL_EOF)
+			m_tokens.push_back(Token{ SPECIAL_EOF, file_id, resume_index, 0 });
 
 		return m_tokens;
 	}
@@ -5,19 +5,34 @@
 #pragma once
 #include <string>
 #include "Utilities/Error.h"
+#include "Utilities/SourceManager.h"
+#include "Utilities/ThreadPool.h"
 #include "Token.h"
 
 namespace Anthem {
 	class Lexer {
 	public:
-		Lexer(ErrorHandler* handler);
+		Lexer(ErrorHandler* handler, SourceManager* source_manager);
 		
-		// Tokenize whole source code
-		const std::vector<Token>& analyze(const std::string& source, const std::filesystem::path& file_path = "");
+		// Tokenize the whole source code of a file registered in the SourceManager
+		const std::vector<Token>& analyze(FileID file_id);
+
+		// Tokenize a file by splitting it into chunks that are lexed on the ThreadPool.
+		// Produces exactly the same Tokens and errors as analyze, small files are lexed serially
+		const std::vector<Token>& analyze_parallel(FileID file_id, ThreadPool& thread_pool);
+
+		// Number of chunks the last analyze_parallel call had to lex again, because they did not start where the previous one stopped
+		size_t relexed_chunks() const { return m_relexed_chunks; }
+
+		// Prepare to tokenize a file one Token at a time through next_token, starting at <start_index>
+		void begin(FileID file_id, uint32_t start_index = 0);
+
+		// Lex and return the next Token of the file, once the End of File or an error is reached, SPECIAL_EOF is returned indefinitely
+		Token next_token();
 
 		// Print the list of tokens to the console (in an almost readable way)
 		void pretty_print();
-		static void pretty_print(const std::vector<Token>& tokens);
+		static void pretty_print(const std::vector<Token>& tokens, const SourceManager& source_manager);
 
 		const std::vector<Token>& get_tokens();
 	private:
@@ -38,6 +53,9 @@ namespace Anthem {
 		// Returns the character of the source string at the current index
 		char current_character();
 
+		// Create a token that starts at <start_index> and ends at the current character, then move past it
+		Token make_token(TokenType type, uint32_t start_index);
+
 
 		// -- Lexical Analysis --
 
@@ -57,16 +75,47 @@ namespace Anthem {
 		// Create a keyword or identifier token
 		Token make_name_token();
 
+
+		// -- Parallel Lexing --
+
+
+		// Files smaller than this many bytes per chunk are not worth splitting
+		static constexpr uint32_t MIN_CHUNK_SIZE = 256 * 1024;
+
+		// Tokens and errors of a part of the file, lexed by its own Lexer
+		struct Chunk {
+			uint32_t start_index{ 0 };
+			uint32_t end_index{ 0 };
+			std::vector<Token> tokens;
+			std::vector<Error> errors;
+
+			// Index the Lexer stopped at, the start of the first Token after the chunk when it was not finished
+			uint32_t resume_index{ 0 };
+
+			// Index after the whitespace and comments the chunk starts with, where the previous chunk stops if they span the boundary
+			uint32_t first_token_index{ 0 };
+
+			// Set if the End of File or an error was reached inside the chunk
+			bool finished{ false };
+		};
+
+		// Lex every Token starting in [chunk.start_index, chunk.end_index), Tokens may extend past the end of the chunk
+		void lex_chunk(FileID file_id, Chunk& chunk);
+
 	private:
 		int m_current_source_index{ -1 };
 		char m_current_char{ '\0' };
-		uint32_t m_current_line{ 0 };
 
 		Position m_current_position;
 		
-		std::filesystem::path m_file_path{ "" };
-		std::string m_source_code{ "" };
+		// Set once the End of File or an error is reached
+		bool m_finished{ false };
+
+		FileID m_file_id{ INVALID_FILE };
+		std::string_view m_source_code{ "" };
 		std::vector<Token> m_tokens;
+		size_t m_relexed_chunks{ 0 };
 		ErrorHandler* m_error_handler{ nullptr };
+		SourceManager* m_source_manager{ nullptr };
 	};
 }
\ No newline at end of file
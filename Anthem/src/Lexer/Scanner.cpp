@@ -0,0 +1,291 @@
+// Scanner.cpp
+// Contains the scalar, SSE2 and AVX2 implementations of the scanning functions and their runtime dispatch
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#include "Scanner.h"
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+	#define ANTHEM_SCAN_X86
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#endif
+#endif
+
+// GCC and Clang only allow AVX2 intrinsics in functions compiled for it, MSVC allows them everywhere
+#if defined(ANTHEM_SCAN_X86) && !defined(_MSC_VER)
+	#define ANTHEM_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define ANTHEM_TARGET_AVX2
+#endif
+
+namespace Anthem {
+	// -- Scalar --
+
+	enum CharacterClass : uint8_t {
+		CLASS_WHITESPACE = 1 << 0,
+		CLASS_IDENTIFIER = 1 << 1
+	};
+
+	static constexpr std::array<uint8_t, 256> character_classes = [] {
+		std::array<uint8_t, 256> classes{};
+		classes[' '] = classes['\t'] = classes['\n'] = CLASS_WHITESPACE;
+		for (int c = 'a'; c <= 'z'; c++) classes[c] = CLASS_IDENTIFIER;
+		for (int c = 'A'; c <= 'Z'; c++) classes[c] = CLASS_IDENTIFIER;
+		for (int c = '0'; c <= '9'; c++) classes[c] = CLASS_IDENTIFIER;
+		classes['_'] = CLASS_IDENTIFIER;
+		return classes;
+	}();
+
+	static bool has_class(char character, CharacterClass character_class) {
+		return character_classes[(unsigned char)character] & character_class;
+	}
+
+	static const char* scan_whitespace_scalar(const char* source) {
+		while (has_class(*source, CLASS_WHITESPACE))
+			source++;
+		return source;
+	}
+
+	static const char* scan_identifier_scalar(const char* source) {
+		while (has_class(*source, CLASS_IDENTIFIER))
+			source++;
+		return source;
+	}
+
+	static const char* find_either_scalar(const char* source, char first, char second) {
+		while (*source != first && *source != second)
+			source++;
+		return source;
+	}
+
+	static size_t count_newlines_scalar(const char* source, size_t size) {
+		size_t count = 0;
+		for (size_t i = 0; i < size; i++)
+			count += source[i] == '\n';
+		return count;
+	}
+
+#ifdef ANTHEM_SCAN_X86
+	// -- SSE2 --
+	// Every function builds a mask with one bit per byte and stops at the first byte whose bit is set,
+	// the null character is never part of a class so every loop ends at the sentinel at the latest
+
+	static uint32_t whitespace_mask(__m128i characters) {
+		__m128i space = _mm_cmpeq_epi8(characters, _mm_set1_epi8(' '));
+		__m128i tab = _mm_cmpeq_epi8(characters, _mm_set1_epi8('\t'));
+		__m128i newline = _mm_cmpeq_epi8(characters, _mm_set1_epi8('\n'));
+		return (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(space, tab), newline));
+	}
+
+	static uint32_t identifier_mask(__m128i characters) {
+		// Setting bit 5 maps upper case letters to lower case ones, bytes above 127 are negative and fail the comparisons
+		__m128i lower = _mm_or_si128(characters, _mm_set1_epi8(0x20));
+		__m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+		__m128i digit = _mm_and_si128(_mm_cmpgt_epi8(characters, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(characters, _mm_set1_epi8('9' + 1)));
+		__m128i underscore = _mm_cmpeq_epi8(characters, _mm_set1_epi8('_'));
+		return (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(letter, digit), underscore));
+	}
+
+	static const char* scan_whitespace_sse2(const char* source) {
+		while (true) {
+			uint32_t stop = ~whitespace_mask(_mm_loadu_si128((const __m128i*)source)) & 0xFFFF;
+			if (stop)
+				return source + std::countr_zero(stop);
+			source += 16;
+		}
+	}
+
+	static const char* scan_identifier_sse2(const char* source) {
+		while (true) {
+			uint32_t stop = ~identifier_mask(_mm_loadu_si128((const __m128i*)source)) & 0xFFFF;
+			if (stop)
+				return source + std::countr_zero(stop);
+			source += 16;
+		}
+	}
+
+	static const char* find_either_sse2(const char* source, char first, char second) {
+		__m128i first_vector = _mm_set1_epi8(first);
+		__m128i second_vector = _mm_set1_epi8(second);
+		while (true) {
+			__m128i characters = _mm_loadu_si128((const __m128i*)source);
+			uint32_t found = (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(characters, first_vector), _mm_cmpeq_epi8(characters, second_vector)));
+			if (found)
+				return source + std::countr_zero(found);
+			source += 16;
+		}
+	}
+
+	static size_t count_newlines_sse2(const char* source, size_t size) {
+		size_t count = 0;
+		__m128i newline = _mm_set1_epi8('\n');
+		for (size_t i = 0; i < size; i += 16) {
+			uint32_t found = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(source + i)), newline));
+
+			// Ignore the bytes past the end of the last block
+			if (size - i < 16)
+				found &= (1u << (size - i)) - 1;
+			count += std::popcount(found);
+		}
+		return count;
+	}
+
+	// -- AVX2 --
+
+	ANTHEM_TARGET_AVX2 static uint32_t whitespace_mask(__m256i characters) {
+		__m256i space = _mm256_cmpeq_epi8(characters, _mm256_set1_epi8(' '));
+		__m256i tab = _mm256_cmpeq_epi8(characters, _mm256_set1_epi8('\t'));
+		__m256i newline = _mm256_cmpeq_epi8(characters, _mm256_set1_epi8('\n'));
+		return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(space, tab), newline));
+	}
+
+	ANTHEM_TARGET_AVX2 static uint32_t identifier_mask(__m256i characters) {
+		__m256i lower = _mm256_or_si256(characters, _mm256_set1_epi8(0x20));
+		__m256i letter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+		__m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(characters, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), characters));
+		__m256i underscore = _mm256_cmpeq_epi8(characters, _mm256_set1_epi8('_'));
+		return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(letter, digit), underscore));
+	}
+
+	ANTHEM_TARGET_AVX2 static const char* scan_whitespace_avx2(const char* source) {
+		while (true) {
+			uint32_t stop = ~whitespace_mask(_mm256_loadu_si256((const __m256i*)source));
+			if (stop)
+				return source + std::countr_zero(stop);
+			source += 32;
+		}
+	}
+
+	ANTHEM_TARGET_AVX2 static const char* scan_identifier_avx2(const char* source) {
+		while (true) {
+			uint32_t stop = ~identifier_mask(_mm256_loadu_si256((const __m256i*)source));
+			if (stop)
+				return source + std::countr_zero(stop);
+			source += 32;
+		}
+	}
+
+	ANTHEM_TARGET_AVX2 static const char* find_either_avx2(const char* source, char first, char second) {
+		__m256i first_vector = _mm256_set1_epi8(first);
+		__m256i second_vector = _mm256_set1_epi8(second);
+		while (true) {
+			__m256i characters = _mm256_loadu_si256((const __m256i*)source);
+			uint32_t found = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(characters, first_vector), _mm256_cmpeq_epi8(characters, second_vector)));
+			if (found)
+				return source + std::countr_zero(found);
+			source += 32;
+		}
+	}
+
+	ANTHEM_TARGET_AVX2 static size_t count_newlines_avx2(const char* source, size_t size) {
+		size_t count = 0;
+		__m256i newline = _mm256_set1_epi8('\n');
+		for (size_t i = 0; i < size; i += 32) {
+			uint32_t found = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(source + i)), newline));
+			if (size - i < 32)
+				found &= (1u << (size - i)) - 1;
+			count += std::popcount(found);
+		}
+		return count;
+	}
+
+	static bool cpu_supports_avx2() {
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+
+		// The OS must save the YMM registers on context switches (OSXSAVE + AVX, XCR0 bits 1 and 2)
+		__cpuid(info, 1);
+		bool os_saves_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+		__cpuidex(info, 7, 0);
+		return os_saves_avx && (info[1] & (1 << 5));
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+#endif
+
+	// -- Dispatch --
+
+	struct ScanFunctions {
+		const char* (*scan_whitespace)(const char*);
+		const char* (*scan_identifier)(const char*);
+		const char* (*find_either)(const char*, char, char);
+		size_t (*count_newlines)(const char*, size_t);
+	};
+
+	static ScanFunctions get_scan_functions(ScanLevel level) {
+		switch (level)
+		{
+#ifdef ANTHEM_SCAN_X86
+		case ScanLevel::AVX2:	return { scan_whitespace_avx2, scan_identifier_avx2, find_either_avx2, count_newlines_avx2 };
+		case ScanLevel::SSE2:	return { scan_whitespace_sse2, scan_identifier_sse2, find_either_sse2, count_newlines_sse2 };
+#endif
+		default:				return { scan_whitespace_scalar, scan_identifier_scalar, find_either_scalar, count_newlines_scalar };
+		}
+	}
+
+	ScanLevel detect_scan_level() {
+#ifdef ANTHEM_SCAN_X86
+		// SSE2 is part of x86-64 itself
+		static const ScanLevel level = cpu_supports_avx2() ? ScanLevel::AVX2 : ScanLevel::SSE2;
+		return level;
+#else
+		return ScanLevel::Scalar;
+#endif
+	}
+
+	static ScanLevel s_scan_level = detect_scan_level();
+	static ScanFunctions s_scan_functions = get_scan_functions(s_scan_level);
+
+	ScanLevel get_scan_level() {
+		return s_scan_level;
+	}
+
+	void set_scan_level(ScanLevel level) {
+		if (level > detect_scan_level())
+			level = detect_scan_level();
+		s_scan_level = level;
+		s_scan_functions = get_scan_functions(level);
+	}
+
+	const char* get_scan_level_name(ScanLevel level) {
+		switch (level)
+		{
+		case ScanLevel::AVX2:	return "AVX2";
+		case ScanLevel::SSE2:	return "SSE2";
+		default:				return "Scalar";
+		}
+	}
+
+	const char* scan_whitespace(const char* source) {
+		return s_scan_functions.scan_whitespace(source);
+	}
+
+	const char* scan_identifier(const char* source) {
+		return s_scan_functions.scan_identifier(source);
+	}
+
+	const char* find_line_end(const char* source) {
+		return s_scan_functions.find_either(source, '\n', '\0');
+	}
+
+	const char* find_comment_end(const char* source) {
+		while (true) {
+			source = s_scan_functions.find_either(source, '*', '\0');
+			if (*source == '\0' || source[1] == '/')
+				return source;
+			source++;
+		}
+	}
+
+	size_t count_newlines(const char* source, size_t size) {
+		return s_scan_functions.count_newlines(source, size);
+	}
+}
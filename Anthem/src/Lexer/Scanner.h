@@ -0,0 +1,47 @@
+// Scanner.h
+// Contains the vectorized character scanning functions used by the Lexer
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#pragma once
+#include <cstddef>
+
+namespace Anthem {
+	/*
+	*  The scanning functions skip over whole runs of a character class at once, 16 (SSE2) or 32 (AVX2) bytes at a time.
+	*  The best implementation supported by the CPU is picked at runtime, with a scalar fallback for every other platform.
+	*  They read up to 32 bytes past the character they stop at, so they must only be used on a SourceBuffer,
+	*  whose null character sentinel stops every scan and whose padding makes these reads safe.
+	*/
+
+	enum class ScanLevel {
+		Scalar,
+		SSE2,
+		AVX2
+	};
+
+	// Get the best implementation supported by the CPU
+	ScanLevel detect_scan_level();
+
+	// Get the implementation currently in use
+	ScanLevel get_scan_level();
+
+	// Force a specific implementation (used for benchmarking), clamped to what the CPU supports
+	void set_scan_level(ScanLevel level);
+
+	const char* get_scan_level_name(ScanLevel level);
+
+	// Returns a pointer to the first character that is not a space, tab or newline
+	const char* scan_whitespace(const char* source);
+
+	// Returns a pointer to the first character that is not a letter, digit or underscore
+	const char* scan_identifier(const char* source);
+
+	// Returns a pointer to the first newline or null character
+	const char* find_line_end(const char* source);
+
+	// Returns a pointer to the '*' of the first "*/", or to the null character if the comment is never closed
+	const char* find_comment_end(const char* source);
+
+	// Count the newlines in [source, source + size), the buffer must be followed by at least 32 readable bytes
+	size_t count_newlines(const char* source, size_t size);
+}
@@ -4,13 +4,13 @@
 
 #pragma once
 #include <string>
+#include <string_view>
 #include <filesystem>
 #include "Utilities/Utilities.h"
-#include <unordered_map>
 
 namespace Anthem {
 	
-	enum TokenType {
+	enum TokenType : uint8_t {
 		// -- Single Character Tokens --
 			// Grouped Tokens
 			LEFT_PARENTHESIS,
@@ -88,6 +88,7 @@ namespace Anthem {
 			EXTERNAL,
 			GLOBAL,
 			INTERNAL,
+			CONST,
 			KEY_I8,
 			KEY_I16,
 			KEY_I32,
@@ -113,14 +114,63 @@ namespace Anthem {
 			NO_TYPE,
 	};
 
+	// Tokens only refer to their text through the file and byte range, which is resolved by the SourceManager.
+	// Numeric literals also carry their value, converted by the Lexer, in place of the 32 bit length
 	struct Token {
+		TokenType type{ NO_TYPE };
+
+		// Length of numeric literals, which are limited to MAX_LITERAL_LENGTH characters
+		uint8_t literal_length{ 0 };
+
+		FileID file_id{ INVALID_FILE };
+		uint32_t offset{ 0 };
+
+		union {
+			// Length of every other Token, use size() to get the length of any Token
+			uint32_t length{ 0 };
+
+			// Value of TYPE_I32 and TYPE_I64 literals
+			int64_t integer;
+
+			// Value of TYPE_F32 and TYPE_F64 literals
+			double floating;
+		};
+
+		static constexpr uint32_t MAX_LITERAL_LENGTH = UINT8_MAX;
+
+		Token() = default;
+		Token(TokenType type, FileID file_id, uint32_t offset, uint32_t length) 
+			: type{ type }, file_id{ file_id }, offset{ offset }, length{ length } {}
+
+		static Token make_integer(TokenType type, FileID file_id, uint32_t offset, uint8_t length, int64_t value) {
+			Token token{ type, file_id, offset, 0 };
+			token.literal_length = length;
+			token.integer = value;
+			return token;
+		}
+
+		static Token make_floating(TokenType type, FileID file_id, uint32_t offset, uint8_t length, double value) {
+			Token token{ type, file_id, offset, 0 };
+			token.literal_length = length;
+			token.floating = value;
+			return token;
+		}
+
+		bool is_numeric_literal() const { return type == TYPE_I32 || type == TYPE_I64 || type == TYPE_F32 || type == TYPE_F64; }
+
+		uint32_t size() const { return is_numeric_literal() ? literal_length : length; }
+
+		Position position() const { return Position{ file_id, offset, size() ? offset + size() - 1 : offset }; }
+	};
+
+	static_assert(sizeof(Token) <= 16, "Token is expected to stay small, it is copied around by value");
+
+	struct Keyword {
+		std::string_view spelling;
 		TokenType type;
-		std::string value;
-		
-		Position position;
 	};
 
-	const std::unordered_map<std::string, TokenType> keyword_map = {
+	constexpr Keyword keyword_table[] = {
 		{ "let"		, LET		},
 		{ "and"		, AND		},
 		{ "or"		, OR		},
@@ -136,6 +186,7 @@ namespace Anthem {
 		{ "external", EXTERNAL	},
 		{ "internal", INTERNAL	},
 		{ "global"	, GLOBAL	},
+		{ "const"	, CONST		},
 		{ "do"		, DO		},
 		{ "break"	, BREAK		},
 		{ "continue", CONTINUE	},
@@ -151,11 +202,130 @@ namespace Anthem {
 		{ "bool"	, KEY_BOOL	},
 	};
 
-	// Get Keyword TokenType from string if it exists
-	inline TokenType get_keyword(const std::string& name) {
-		if (keyword_map.find(name) != keyword_map.end())
-			return keyword_map.at(name);
-		return NO_TYPE;
+	// Get Keyword TokenType from string if it exists.
+	// Dispatches on the length and first character, so at most one or two string compares are made per identifier
+	constexpr TokenType get_keyword(std::string_view name) {
+		if (name.size() < 2)
+			return NO_TYPE;
+
+		// Returns the TokenType if the name matches the keyword
+		auto is = [name](std::string_view keyword, TokenType type) { return name == keyword ? type : NO_TYPE; };
+
+		switch (name.size())
+		{
+		case 2:
+			switch (name[0])
+			{
+			case 'o': return is("or", OR);
+			case 'i': return name[1] == 'f' ? is("if", IF) : is("i8", KEY_I8);
+			case 'f': return is("fn", FUNCTION);
+			case 'd': return is("do", DO);
+			default: return NO_TYPE;
+			}
+		case 3:
+			switch (name[0])
+			{
+			case 'l': return is("let", LET);
+			case 'a': return is("and", AND);
+			case 'f':
+				if (name[1] == 'o') return is("for", FOR);
+				return name[1] == '3' ? is("f32", KEY_F32) : is("f64", KEY_F64);
+			case 'i':
+				if (name[1] == '1') return is("i16", KEY_I16);
+				return name[1] == '3' ? is("i32", KEY_I32) : is("i64", KEY_I64);
+			default: return NO_TYPE;
+			}
+		case 4:
+			switch (name[0])
+			{
+			case 't': return name[1] == 'r' ? is("true", TRUE) : is("this", THIS);
+			case 'e': return name[1] == 'l' ? is("else", ELSE) : is("enum", ENUM);
+			case 'l': return is("loop", LOOP);
+			case 'b': return is("bool", KEY_BOOL);
+			default: return NO_TYPE;
+			}
+		case 5:
+			switch (name[0])
+			{
+			case 'f': return is("false", FALSE);
+			case 'w': return is("while", WHILE);
+			case 'b': return is("break", BREAK);
+			case 'c': return name[1] == 'l' ? is("class", CLASS) : is("const", CONST);
+			default: return NO_TYPE;
+			}
+		case 6:
+			switch (name[0])
+			{
+			case 'r': return is("return", RETURN);
+			case 'g': return is("global", GLOBAL);
+			default: return NO_TYPE;
+			}
+		case 8:
+			switch (name[0])
+			{
+			case 'e': return is("external", EXTERNAL);
+			case 'i': return is("internal", INTERNAL);
+			case 'c': return is("continue", CONTINUE);
+			default: return NO_TYPE;
+			}
+		default:
+			return NO_TYPE;
+		}
+	}
+
+	// Make sure the dispatch above recognizes every keyword of the table
+	static_assert([] {
+		for (const Keyword& keyword : keyword_table)
+			if (get_keyword(keyword.spelling) != keyword.type)
+				return false;
+		return get_keyword("iff") == NO_TYPE && get_keyword("i") == NO_TYPE && get_keyword("f16") == NO_TYPE;
+	}(), "get_keyword does not match keyword_table");
+
+	// Get the fixed spelling of a punctuation or keyword TokenType, empty for tokens with variable text
+	inline std::string_view get_spelling(TokenType type) {
+		switch (type)
+		{
+		case LEFT_PARENTHESIS:	return "(";
+		case RIGHT_PARENTHESIS:	return ")";
+		case LEFT_BRACE:		return "{";
+		case RIGHT_BRACE:		return "}";
+		case LEFT_BRACKET:		return "[";
+		case RIGHT_BRACKET:		return "]";
+		case PLUS:				return "+";
+		case MINUS:				return "-";
+		case STAR:				return "*";
+		case SLASH:				return "/";
+		case CAP:				return "^";
+		case PERCENT:			return "%";
+		case AMPERSAND:			return "&";
+		case TILDE:				return "~";
+		case PIPE:				return "|";
+		case BANG:				return "!";
+		case GREATER:			return ">";
+		case LESS:				return "<";
+		case DOT:				return ".";
+		case COMMA:				return ",";
+		case SEMICOLON:			return ";";
+		case COLON:				return ":";
+		case EQUAL:				return "=";
+		case BANG_EQUAL:		return "!=";
+		case EQUAL_EQUAL:		return "==";
+		case GREATER_EQUAL:		return ">=";
+		case LESS_EQUAL:		return "<=";
+		case PLUS_EQUAL:		return "+=";
+		case MINUS_EQUAL:		return "-=";
+		case STAR_EQUAL:		return "*=";
+		case SLASH_EQUAL:		return "/=";
+		case ARROW:				return "->";
+		case SPECIAL_EOF:		return "EOF";
+		default:
+			break;
+		}
+
+		for (const Keyword& keyword : keyword_table)
+			if (keyword.type == type)
+				return keyword.spelling;
+		return "";
 	}
 
 	// Check if a token is of type Type
@@ -178,19 +348,43 @@ namespace Anthem {
 	inline ReturnType get_type(const Token& token) {
 		switch (token.type)
 		{
-		case KEY_I8:
-		case KEY_I16:
+		case KEY_I8:	return ReturnType::I8;
+		case KEY_I16:	return ReturnType::I16;
+		case KEY_I64:	return ReturnType::I64;
+		case KEY_F32:	return ReturnType::F32;
+		case KEY_F64:	return ReturnType::F64;
+		case KEY_BOOL:	return ReturnType::BOOL;
 		case KEY_I32:
-			return ReturnType::I32;
-		case KEY_I64:
-			return ReturnType::I64;
-		case KEY_F32:
-		case KEY_F64:
-		case KEY_BOOL:
 		default:
 			return ReturnType::I32;
 		}
 	}
 
+	// Operation of a binary operator or compound assignment Token
+	inline BinaryOperation token_to_bin_op(const Token& token) {
+		switch (token.type) {
+		case MINUS: return BinaryOperation::SUBTRACTION;
+		case PLUS: return BinaryOperation::ADDITION;
+		case STAR: return BinaryOperation::MULTIPLICATION;
+		case SLASH: return BinaryOperation::DIVISION;
+		case PERCENT: return BinaryOperation::REMAINDER;
+		case GREATER: return BinaryOperation::GREATER;
+		case GREATER_EQUAL: return BinaryOperation::GREATER_EQUAL;
+		case LESS: return BinaryOperation::LESS;
+		case LESS_EQUAL: return BinaryOperation::LESS_EQUAL;
+		case EQUAL_EQUAL: return BinaryOperation::EQUAL;
+		case BANG_EQUAL: return BinaryOperation::NOT_EQUAL;
+		case AND: return BinaryOperation::AND;
+		case OR: return BinaryOperation::OR;
+
+		// Compound assignments apply their operation before assigning
+		case PLUS_EQUAL: return BinaryOperation::ADDITION;
+		case MINUS_EQUAL: return BinaryOperation::SUBTRACTION;
+		case STAR_EQUAL: return BinaryOperation::MULTIPLICATION;
+		case SLASH_EQUAL: return BinaryOperation::DIVISION;
+		default: return BinaryOperation::NONE;
+		}
+	}
+
 	using TokenList = std::vector<Token>;
 }
\ No newline at end of file
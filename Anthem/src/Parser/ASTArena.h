@@ -0,0 +1,63 @@
+// ASTArena.h
+// Contains the ASTArena Class definition
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#pragma once
+#include <memory_resource>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <cstddef>
+
+namespace Anthem {
+	// Bump-pointer allocator owning every AST Node of a compilation.
+	// Nodes are referenced by raw pointers and are never destroyed one by one, all the memory is freed at once
+	// when the arena is released or goes out of scope. Node destructors are not run, so Nodes may only own
+	// memory that also comes from the arena (lists inside Nodes use its resource())
+	class ASTArena {
+	public:
+		ASTArena(size_t initial_size = INITIAL_SIZE) : m_resource{ initial_size } {}
+
+		ASTArena(const ASTArena&) = delete;
+		ASTArena& operator=(const ASTArena&) = delete;
+
+		// Construct a Node of type <T> inside the arena
+		template<typename T, typename... Args>
+		T* make(Args&&... args) {
+			m_node_count++;
+			return new (m_resource.allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		}
+
+		// Memory resource for the lists stored inside Nodes
+		std::pmr::memory_resource* resource() { return &m_resource; }
+
+		// Make an arena owned by this one, for Nodes made on another thread (arenas are not thread safe).
+		// Its Nodes live exactly as long as the ones of this arena
+		ASTArena* make_arena() {
+			m_arenas.push_back(std::make_unique<ASTArena>());
+			return m_arenas.back().get();
+		}
+
+		// Free every Node at once, all pointers to them become dangling
+		void release() {
+			m_resource.release();
+			m_arenas.clear();
+			m_node_count = 0;
+		}
+
+		// Number of Nodes made in this arena and the arenas it owns
+		size_t get_node_count() const {
+			size_t node_count = m_node_count;
+			for (const auto& arena : m_arenas)
+				node_count += arena->get_node_count();
+			return node_count;
+		}
+	private:
+		// Size of the first block, later blocks grow geometrically
+		static constexpr size_t INITIAL_SIZE = 64 * 1024;
+
+		std::pmr::monotonic_buffer_resource m_resource;
+		std::vector<std::unique_ptr<ASTArena>> m_arenas;
+		size_t m_node_count{ 0 };
+	};
+}
@@ -6,12 +6,13 @@
 #include "Utilities/Utilities.h"
 #include "Lexer/Token.h"
 #include <variant>
+#include <memory_resource>
 
 namespace Anthem {
 // Macro to simplify basic setup for all node classes
 #define NODE_TYPE(x) NodeType get_type() const override { return NodeType::x; }
 
-	enum class NodeType {
+	enum class NodeType : uint8_t {
 		// Groups
 			DECLARATION,
 			STATEMENT,
@@ -25,10 +26,13 @@ namespace Anthem {
 			UNARY_OPERATION,
 			BINARY_OPERATION,
 			INT_LITERAL,
+			FLOAT_LITERAL,
+			BOOL_LITERAL,
 			ASSIGNMENT,
 			VARIABLE,
 			NAME_ACCESS,
 			FUNCTION_CALL,
+			INDEX,
 
 		// Statements
 			GROUP_STATEMENT,
@@ -47,6 +51,7 @@ namespace Anthem {
 
 	// General Nodes
 
+	// Nodes are allocated in an ASTArena and never destroyed one by one, lists inside Nodes must use the arena's memory resource
 	class ASTNode {
 	public:
 		virtual NodeType get_type() const = 0;
@@ -55,6 +60,9 @@ namespace Anthem {
 	class ExpressionNode : public ASTNode {
 	public:
 		NODE_TYPE(EXPRESSION)
+	public:
+		// Id of the expression, given in the semantic analysis pass. The TypeChecker keeps the type of the value by it
+		ExprId expression_id;
 	};
 
 	class DeclarationNode : public ASTNode {
@@ -62,12 +70,11 @@ namespace Anthem {
 		NODE_TYPE(DECLARATION)
 	};
 
-	using DeclarationList = std::vector<ptr<DeclarationNode>>;
+	using DeclarationList = std::pmr::vector<DeclarationNode*>;
 
 	class ProgramNode : public ASTNode {
 	public:
-		ProgramNode() = default;
-		ProgramNode(const DeclarationList& list) : declarations{ list } {}
+		ProgramNode(DeclarationList&& list) : declarations{ std::move(list) } {}
 
 		NODE_TYPE(PROGRAM)
 	public:
@@ -82,93 +89,136 @@ namespace Anthem {
 	struct Parameter {
 		Name name{ "" };
 		ReturnType type;
-		ptr<ExpressionNode> default_value{ nullptr };
+		ExpressionNode* default_value{ nullptr };
+
+		// Id of the parameter as a local variable, given in the semantic analysis pass
+		VarId id;
 	};
 
+	using ParameterList = std::pmr::vector<Parameter>;
+
 	// Declaration Nodes
 
 	class FunctionDeclarationNode : public DeclarationNode {
 	public:
-		FunctionDeclarationNode(const Name& name, ptr<StatementNode> body, const std::vector<Parameter>& parameters, ReturnType type = ReturnType::I32)
-			: name{ name }, body{ body }, parameters{ parameters }, return_type{ type } {}
+		FunctionDeclarationNode(const Name& name, StatementNode* body, ParameterList&& parameters, ReturnType type = ReturnType::I32)
+			: name{ name }, body{ body }, parameters{ std::move(parameters) }, return_type{ type } {}
 
 		NODE_TYPE(FUNCTION_DECLARATION)
 	public:
 		Name name;
-		std::vector<Parameter> parameters;
-		ptr<StatementNode> body;
+		ParameterList parameters;
+		StatementNode* body;
 		ReturnType return_type;
 		VarFlag flag;
+
+		// Declared with 'const', so calls to it can be evaluated at compile time
+		bool is_const{ false };
 	};
 
 	class ExternalFunctionNode : public DeclarationNode {
 	public:
-		ExternalFunctionNode(const Name& name, const std::vector<Parameter>& parameters, ReturnType type = ReturnType::I32)
-			: name{ name }, parameters{ parameters }, return_type{ type } {}
+		ExternalFunctionNode(const Name& name, ParameterList&& parameters, ReturnType type = ReturnType::I32)
+			: name{ name }, parameters{ std::move(parameters) }, return_type{ type } {}
 
 		NODE_TYPE(EXTERNAL_DECLARATION)
 	public:
 		Name name;
-		std::vector<Parameter> parameters;
+		ParameterList parameters;
 		ReturnType return_type;
 	};
 
 	class VariableNode : public DeclarationNode {
 	public:
-		VariableNode(Token variable_token, ReturnType type = ReturnType::I32, ptr<ExpressionNode> expression = nullptr, VarFlag flag = VarFlag::Local)
+		VariableNode(Token variable_token, ReturnType type = ReturnType::I32, ExpressionNode* expression = nullptr, VarFlag flag = VarFlag::Local)
 			: variable_token{ variable_token }, expression{ expression }, type{ type }, flag{ flag } {}
 
 		NODE_TYPE(VARIABLE)
 	public:
 		Token variable_token;
-		ptr<ExpressionNode> expression;
+
+		// Identifier as written in the source, a view into the SourceManager's buffer
+		std::string_view identifier;
+
+		// Name given in the semantic analysis pass, the identifier itself for locals and the symbol for all other variables
+		Name name;
+
+		// Id of a local variable, given in the semantic analysis pass
+		VarId id;
+		ExpressionNode* expression;
 		ReturnType type;
 		VarFlag flag;
+
+		// Number of elements of an array declaration ('[type; length]'), nullptr for other variables.
+		// The length is evaluated by the TypeChecker
+		ExpressionNode* length_expression{ nullptr };
+		uint32_t array_length{ 0 };
 	};
 
 	// Expression Nodes
 
 	class UnaryOperationNode : public ExpressionNode {
 	public:
-		UnaryOperationNode(Token operator_token, ptr<ExpressionNode> expression) 
+		UnaryOperationNode(Token operator_token, ExpressionNode* expression) 
 			: operator_token{ operator_token }, expression{ expression } {}
 
 		NODE_TYPE(UNARY_OPERATION)
 	public:
 		Token operator_token;
-		ptr<ExpressionNode> expression;
+		ExpressionNode* expression;
 	};
 
 	class BinaryOperationNode : public ExpressionNode {
 	public:
-		BinaryOperationNode(const Token& operator_token, ptr<ExpressionNode> left_expression, ptr<ExpressionNode> right_expression)
+		BinaryOperationNode(const Token& operator_token, ExpressionNode* left_expression, ExpressionNode* right_expression)
 			: operator_token{ operator_token }, left_expression{ left_expression }, right_expression{ right_expression } {}
 
 		NODE_TYPE(BINARY_OPERATION)
 	public:
 		Token operator_token;
-		ptr<ExpressionNode> left_expression;
-		ptr<ExpressionNode> right_expression;
+		ExpressionNode* left_expression;
+		ExpressionNode* right_expression;
 	};
 
 	class IntegerLiteralNode : public ExpressionNode {
 	public:
-		IntegerLiteralNode(int number) : integer{number} {}
+		IntegerLiteralNode(int64_t number) : integer{number} {}
 
 		NODE_TYPE(INT_LITERAL)
 	public:
-		int integer;
+		int64_t integer;
+	};
+
+	class FloatLiteralNode : public ExpressionNode {
+	public:
+		FloatLiteralNode(double number, ReturnType type) : floating{ number }, type{ type } {}
+
+		NODE_TYPE(FLOAT_LITERAL)
+	public:
+		double floating;
+
+		// F32 for literals written with an 'f' suffix, F64 otherwise
+		ReturnType type;
+	};
+
+	class BoolLiteralNode : public ExpressionNode {
+	public:
+		BoolLiteralNode(bool value) : value{ value } {}
+
+		NODE_TYPE(BOOL_LITERAL)
+	public:
+		bool value;
 	};
 
 	class AssignmentNode : public ExpressionNode {
 	public:
-		AssignmentNode(ptr<ExpressionNode> lvalue, ptr<ExpressionNode> expression, const Token& equals_token) 
-			: lvalue{ lvalue }, expression{ expression }, token{ token } {}
+		AssignmentNode(ExpressionNode* lvalue, ExpressionNode* expression, const Token& equals_token) 
+			: lvalue{ lvalue }, expression{ expression }, token{ equals_token } {}
 
 		NODE_TYPE(ASSIGNMENT)
 	public:
-		ptr<ExpressionNode> lvalue;
-		ptr<ExpressionNode> expression;
+		ExpressionNode* lvalue;
+		ExpressionNode* expression;
 		Token token;
 	};
 
@@ -179,40 +229,71 @@ namespace Anthem {
 		NODE_TYPE(NAME_ACCESS)
 	public:
 		Token variable_token;
+
+		// Identifier as written in the source, a view into the SourceManager's buffer
+		std::string_view identifier;
+
+		// Name of the accessed variable, resolved in the semantic analysis pass
+		Name name;
+
+		// Id of the accessed variable if it is a local one
+		VarId id;
 	};
 
-	using ArgList = std::vector<ptr<ExpressionNode>>;
+	using ArgList = std::pmr::vector<ExpressionNode*>;
 
 	class FunctionCallNode : public ExpressionNode {
 	public:
-		FunctionCallNode(Token variable_token, const ArgList& argument_list) 
-			: variable_token{ variable_token }, argument_list{ argument_list } {}
+		FunctionCallNode(Token variable_token, ArgList&& argument_list) 
+			: variable_token{ variable_token }, argument_list{ std::move(argument_list) } {}
 
 		NODE_TYPE(FUNCTION_CALL)
 	public:
 		Token variable_token;
+
+		// Identifier as written in the source, a view into the SourceManager's buffer
+		std::string_view identifier;
+
+		// Name of the called function, resolved in the semantic analysis pass
+		Name name;
 		ArgList argument_list;
 		bool is_external = false;
 	};
 
+	// Element of an array, 'array[index]'
+	class IndexNode : public ExpressionNode {
+	public:
+		IndexNode(AccessNode* array, const Token& bracket_token) : array{ array }, bracket_token{ bracket_token } {}
+
+		NODE_TYPE(INDEX)
+	public:
+		// Resolved like a variable access, but not an expression of its own
+		AccessNode* array;
+		ExpressionNode* index{ nullptr };
+		Token bracket_token;
+
+		// Number of elements of the array, set in the type checking pass
+		uint32_t length{ 0 };
+	};
+
 	// Statement Nodes
 
 	class ReturnStatementNode : public StatementNode {
 	public:
-		ReturnStatementNode(ptr<ExpressionNode> expr) : expression{ expr } {}
+		ReturnStatementNode(ExpressionNode* expr) : expression{ expr } {}
 
 		NODE_TYPE(RETURN_STATEMENT)
 	public:
-		ptr<ExpressionNode> expression;
+		ExpressionNode* expression;
 	};
 
 	class ExprStatementNode : public StatementNode {
 	public:
-		ExprStatementNode(ptr<ExpressionNode> expr) : expression{ expr } {}
+		ExprStatementNode(ExpressionNode* expr) : expression{ expr } {}
 
 		NODE_TYPE(EXPR_STATEMENT)
 	public:
-		ptr<ExpressionNode> expression;
+		ExpressionNode* expression;
 	};
 
 	class VoidStatementNode : public StatementNode {
@@ -220,13 +301,12 @@ namespace Anthem {
 		NODE_TYPE(VOID_STATEMENT)
 	};
 
-	using BlockItem = std::variant<ptr<DeclarationNode>, ptr<StatementNode>>;
-	using BlockItems = std::vector<BlockItem>;
+	using BlockItem = std::variant<DeclarationNode*, StatementNode*>;
+	using BlockItems = std::pmr::vector<BlockItem>;
 
 	class BlockStatementNode : public StatementNode {
 	public:
-		BlockStatementNode() = default;
-		BlockStatementNode(const BlockItems& items) : items{ items } {}
+		BlockStatementNode(BlockItems&& items) : items{ std::move(items) } {}
 
 		NODE_TYPE(BLOCK_STATEMENT)
 	public:
@@ -236,26 +316,26 @@ namespace Anthem {
 	class IfStatementNode : public StatementNode {
 	public:
 		IfStatementNode() = default;
-		IfStatementNode(ptr<ExpressionNode> condition, ptr<StatementNode> body, ptr<StatementNode> else_body)
+		IfStatementNode(ExpressionNode* condition, StatementNode* body, StatementNode* else_body)
 			: condition{ condition }, body{ body }, else_body{ else_body } {}
 
 		NODE_TYPE(IF_STATEMENT)
 	public:
-		ptr<ExpressionNode> condition;
-		ptr<StatementNode> body;
+		ExpressionNode* condition;
+		StatementNode* body;
 
 		// If there is no else statement, set to nullptr
-		ptr<StatementNode> else_body = nullptr;
+		StatementNode* else_body = nullptr;
 	};
 
 	class LoopStatementNode : public StatementNode {
 	public:
 		LoopStatementNode() = default;
-		LoopStatementNode(ptr<StatementNode> body) : body{ body } {}
+		LoopStatementNode(StatementNode* body) : body{ body } {}
 
 		NODE_TYPE(LOOP_STATEMENT)
 	public:
-		ptr<StatementNode> body;
+		StatementNode* body;
 
 		// ID will be provided in the semantic analysis pass
 		uint64_t id;
@@ -264,12 +344,12 @@ namespace Anthem {
 	class WhileStatementNode : public StatementNode {
 	public:
 		WhileStatementNode() = default;
-		WhileStatementNode(ptr<ExpressionNode> condition, ptr<StatementNode> body) : condition{ condition }, body { body } {}
+		WhileStatementNode(ExpressionNode* condition, StatementNode* body) : condition{ condition }, body { body } {}
 
 		NODE_TYPE(WHILE_STATEMENT)
 	public:
-		ptr<ExpressionNode> condition;
-		ptr<StatementNode> body;
+		ExpressionNode* condition;
+		StatementNode* body;
 
 		// ID will be provided in the semantic analysis pass
 		uint64_t id;
@@ -278,15 +358,15 @@ namespace Anthem {
 	class ForStatementNode : public StatementNode {
 	public:
 		ForStatementNode() = default;
-		ForStatementNode(ptr<ExpressionNode> init, ptr<ExpressionNode> condition, ptr<ExpressionNode> post_loop, ptr<StatementNode> body)
+		ForStatementNode(ExpressionNode* init, ExpressionNode* condition, ExpressionNode* post_loop, StatementNode* body)
 			: condition{ condition }, body{ body }, init{ init }, post_loop{ post_loop } {}
 
 		NODE_TYPE(FOR_STATEMENT)
 	public:
-		ptr<ExpressionNode> init;
-		ptr<ExpressionNode> post_loop;
-		ptr<ExpressionNode> condition;
-		ptr<StatementNode> body;
+		ExpressionNode* init;
+		ExpressionNode* post_loop;
+		ExpressionNode* condition;
+		StatementNode* body;
 
 		// ID will be provided in the semantic analysis pass
 		uint64_t id;
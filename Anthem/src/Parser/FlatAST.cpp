@@ -0,0 +1,361 @@
+// FlatAST.cpp
+// Contains the FlatAST Class method implementations
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#include "FlatAST.h"
+#include <iostream>
+
+namespace Anthem {
+	FlatAST::FlatAST(const ProgramNode* program) {
+		NodeIndex root = add_node(NodeType::PROGRAM);
+		uint32_t slot = add_children(root, uint32_t(program->declarations.size()));
+		for (auto declaration = program->declarations.rbegin(); declaration != program->declarations.rend(); ++declaration)
+			schedule(FlattenItem::DECLARATION, *declaration, slot + uint32_t(program->declarations.rend() - declaration - 1));
+
+		// Nodes are added when they are popped, so the arrays are filled in pre-order without recursion
+		while (!m_work_stack.empty()) {
+			FlattenItem item = m_work_stack.back();
+			m_work_stack.pop_back();
+			switch (item.kind)
+			{
+			case FlattenItem::DECLARATION:
+				m_children[item.target] = flatten_declaration(static_cast<const DeclarationNode*>(item.node));
+				break;
+			case FlattenItem::STATEMENT:
+				m_children[item.target] = flatten_statement(static_cast<const StatementNode*>(item.node));
+				break;
+			case FlattenItem::EXPRESSION:
+				m_children[item.target] = flatten_expression(static_cast<const ExpressionNode*>(item.node));
+				break;
+			case FlattenItem::FINISH:
+				m_subtree_ends[item.target] = NodeIndex(m_kinds.size());
+				break;
+			}
+		}
+	}
+
+	NodeIndex FlatAST::add_node(NodeType kind, uint32_t data) {
+		m_kinds.push_back(kind);
+		m_data.push_back(data);
+		m_subtree_ends.push_back(INVALID_NODE);
+		m_child_ranges.push_back({});
+		return NodeIndex(m_kinds.size() - 1);
+	}
+
+	uint32_t FlatAST::add_children(NodeIndex node, uint32_t count) {
+		uint32_t first = uint32_t(m_children.size());
+		m_child_ranges[node] = { first, count };
+		m_children.resize(m_children.size() + count, INVALID_NODE);
+
+		// A leaf is finished right away, otherwise once every node scheduled after this point is added
+		if (count == 0)
+			m_subtree_ends[node] = NodeIndex(m_kinds.size());
+		else
+			schedule(FlattenItem::FINISH, nullptr, node);
+		return first;
+	}
+
+	void FlatAST::schedule(FlattenItem::Kind kind, const ASTNode* node, uint32_t target) {
+		m_work_stack.push_back({ kind, node, target });
+	}
+
+	uint32_t FlatAST::add_symbol(const Symbol& symbol) {
+		m_symbols.push_back(symbol);
+		return uint32_t(m_symbols.size() - 1);
+	}
+
+	uint32_t FlatAST::flatten_parameters(const ParameterList& parameters) {
+		uint32_t first = uint32_t(m_parameters.size());
+		for (const Parameter& parameter : parameters)
+			m_parameters.push_back({ parameter.name, parameter.type });
+		return first;
+	}
+
+	NodeIndex FlatAST::flatten_declaration(const DeclarationNode* declaration) {
+		switch (declaration->get_type())
+		{
+		case NodeType::VARIABLE: {
+			auto variable = static_cast<const VariableNode*>(declaration);
+			Symbol symbol{ variable->variable_token, variable->name, variable->type, variable->flag };
+			symbol.array_length = variable->array_length;
+			NodeIndex node = add_node(NodeType::VARIABLE, add_symbol(symbol));
+			if (variable->expression)
+				schedule(FlattenItem::EXPRESSION, variable->expression, add_children(node, 1));
+			else
+				add_children(node, 0);
+			return node;
+		}
+		case NodeType::FUNCTION_DECLARATION: {
+			auto function = static_cast<const FunctionDeclarationNode*>(declaration);
+			Symbol symbol{ {}, function->name, function->return_type, function->flag };
+			symbol.first_parameter = flatten_parameters(function->parameters);
+			symbol.parameter_count = uint32_t(function->parameters.size());
+
+			NodeIndex node = add_node(NodeType::FUNCTION_DECLARATION, add_symbol(symbol));
+			schedule(FlattenItem::STATEMENT, function->body, add_children(node, 1));
+			return node;
+		}
+		case NodeType::EXTERNAL_DECLARATION: {
+			auto external = static_cast<const ExternalFunctionNode*>(declaration);
+			Symbol symbol{ {}, external->name, external->return_type, VarFlag::External, true };
+			symbol.first_parameter = flatten_parameters(external->parameters);
+			symbol.parameter_count = uint32_t(external->parameters.size());
+
+			NodeIndex node = add_node(NodeType::EXTERNAL_DECLARATION, add_symbol(symbol));
+			add_children(node, 0);
+			return node;
+		}
+		default:
+			return INVALID_NODE;
+		}
+	}
+
+	// Children are scheduled last to first, so they are added in source order
+	NodeIndex FlatAST::flatten_statement(const StatementNode* statement) {
+		NodeType kind = statement->get_type();
+		switch (kind)
+		{
+		case NodeType::RETURN_STATEMENT: {
+			NodeIndex node = add_node(kind);
+			schedule(FlattenItem::EXPRESSION, static_cast<const ReturnStatementNode*>(statement)->expression, add_children(node, 1));
+			return node;
+		}
+		case NodeType::EXPR_STATEMENT: {
+			NodeIndex node = add_node(kind);
+			schedule(FlattenItem::EXPRESSION, static_cast<const ExprStatementNode*>(statement)->expression, add_children(node, 1));
+			return node;
+		}
+		case NodeType::BLOCK_STATEMENT: {
+			auto block = static_cast<const BlockStatementNode*>(statement);
+			NodeIndex node = add_node(kind);
+			uint32_t slot = add_children(node, uint32_t(block->items.size()));
+			for (size_t i = block->items.size(); i-- > 0;) {
+				const BlockItem& item = block->items[i];
+				if (std::holds_alternative<StatementNode*>(item))
+					schedule(FlattenItem::STATEMENT, std::get<StatementNode*>(item), slot + uint32_t(i));
+				else
+					schedule(FlattenItem::DECLARATION, std::get<DeclarationNode*>(item), slot + uint32_t(i));
+			}
+			return node;
+		}
+		case NodeType::IF_STATEMENT: {
+			auto if_statement = static_cast<const IfStatementNode*>(statement);
+			NodeIndex node = add_node(kind);
+			uint32_t slot = add_children(node, if_statement->else_body ? 3 : 2);
+			if (if_statement->else_body)
+				schedule(FlattenItem::STATEMENT, if_statement->else_body, slot + 2);
+			schedule(FlattenItem::STATEMENT, if_statement->body, slot + 1);
+			schedule(FlattenItem::EXPRESSION, if_statement->condition, slot);
+			return node;
+		}
+		case NodeType::LOOP_STATEMENT: {
+			auto loop_statement = static_cast<const LoopStatementNode*>(statement);
+			NodeIndex node = add_node(kind, uint32_t(loop_statement->id));
+			schedule(FlattenItem::STATEMENT, loop_statement->body, add_children(node, 1));
+			return node;
+		}
+		case NodeType::WHILE_STATEMENT: {
+			auto while_statement = static_cast<const WhileStatementNode*>(statement);
+			NodeIndex node = add_node(kind, uint32_t(while_statement->id));
+			uint32_t slot = add_children(node, 2);
+			schedule(FlattenItem::STATEMENT, while_statement->body, slot + 1);
+			schedule(FlattenItem::EXPRESSION, while_statement->condition, slot);
+			return node;
+		}
+		case NodeType::FOR_STATEMENT: {
+			auto for_statement = static_cast<const ForStatementNode*>(statement);
+			NodeIndex node = add_node(kind, uint32_t(for_statement->id));
+			uint32_t slot = add_children(node, 4);
+			schedule(FlattenItem::STATEMENT, for_statement->body, slot + 3);
+			schedule(FlattenItem::EXPRESSION, for_statement->post_loop, slot + 2);
+			schedule(FlattenItem::EXPRESSION, for_statement->condition, slot + 1);
+			schedule(FlattenItem::EXPRESSION, for_statement->init, slot);
+			return node;
+		}
+		case NodeType::BREAK_STATEMENT: {
+			NodeIndex node = add_node(kind, uint32_t(static_cast<const BreakStatementNode*>(statement)->id));
+			add_children(node, 0);
+			return node;
+		}
+		case NodeType::CONTINUE_STATEMENT: {
+			NodeIndex node = add_node(kind, uint32_t(static_cast<const ContinueStatementNode*>(statement)->id));
+			add_children(node, 0);
+			return node;
+		}
+		case NodeType::VOID_STATEMENT:
+		default: {
+			NodeIndex node = add_node(NodeType::VOID_STATEMENT);
+			add_children(node, 0);
+			return node;
+		}
+		}
+	}
+
+	NodeIndex FlatAST::flatten_expression(const ExpressionNode* expression) {
+		NodeType kind = expression->get_type();
+		switch (kind)
+		{
+		case NodeType::INT_LITERAL: {
+			m_literals.push_back(static_cast<const IntegerLiteralNode*>(expression)->integer);
+			NodeIndex node = add_node(kind, uint32_t(m_literals.size() - 1));
+			add_children(node, 0);
+			return node;
+		}
+		case NodeType::FLOAT_LITERAL: {
+			m_literals.push_back(std::bit_cast<int64_t>(static_cast<const FloatLiteralNode*>(expression)->floating));
+			NodeIndex node = add_node(kind, uint32_t(m_literals.size() - 1));
+			add_children(node, 0);
+			return node;
+		}
+		case NodeType::BOOL_LITERAL: {
+			m_literals.push_back(static_cast<const BoolLiteralNode*>(expression)->value);
+			NodeIndex node = add_node(kind, uint32_t(m_literals.size() - 1));
+			add_children(node, 0);
+			return node;
+		}
+		case NodeType::UNARY_OPERATION: {
+			auto unary_op = static_cast<const UnaryOperationNode*>(expression);
+			m_operators.push_back(unary_op->operator_token);
+			NodeIndex node = add_node(kind, uint32_t(m_operators.size() - 1));
+			schedule(FlattenItem::EXPRESSION, unary_op->expression, add_children(node, 1));
+			return node;
+		}
+		case NodeType::BINARY_OPERATION: {
+			auto binary_op = static_cast<const BinaryOperationNode*>(expression);
+			m_operators.push_back(binary_op->operator_token);
+			NodeIndex node = add_node(kind, uint32_t(m_operators.size() - 1));
+			uint32_t slot = add_children(node, 2);
+			schedule(FlattenItem::EXPRESSION, binary_op->right_expression, slot + 1);
+			schedule(FlattenItem::EXPRESSION, binary_op->left_expression, slot);
+			return node;
+		}
+		case NodeType::ASSIGNMENT: {
+			auto assignment = static_cast<const AssignmentNode*>(expression);
+			m_operators.push_back(assignment->token);
+			NodeIndex node = add_node(kind, uint32_t(m_operators.size() - 1));
+			uint32_t slot = add_children(node, 2);
+			schedule(FlattenItem::EXPRESSION, assignment->expression, slot + 1);
+			schedule(FlattenItem::EXPRESSION, assignment->lvalue, slot);
+			return node;
+		}
+		case NodeType::NAME_ACCESS: {
+			auto access = static_cast<const AccessNode*>(expression);
+			// Unresolved names keep the identifier written in the source
+			Name name = access->name.empty() ? Name(access->identifier) : access->name;
+			NodeIndex node = add_node(kind, add_symbol({ access->variable_token, name }));
+			add_children(node, 0);
+			return node;
+		}
+		case NodeType::INDEX: {
+			auto index = static_cast<const IndexNode*>(expression);
+			Name name = index->array->name.empty() ? Name(index->array->identifier) : index->array->name;
+			NodeIndex node = add_node(kind, add_symbol({ index->array->variable_token, name }));
+			schedule(FlattenItem::EXPRESSION, index->index, add_children(node, 1));
+			return node;
+		}
+		case NodeType::FUNCTION_CALL: {
+			auto call = static_cast<const FunctionCallNode*>(expression);
+			Name name = call->name.empty() ? Name(call->identifier) : call->name;
+			NodeIndex node = add_node(kind, add_symbol({ call->variable_token, name, ReturnType::I32, VarFlag::Global, call->is_external }));
+			uint32_t slot = add_children(node, uint32_t(call->argument_list.size()));
+			for (size_t i = call->argument_list.size(); i-- > 0;)
+				schedule(FlattenItem::EXPRESSION, call->argument_list[i], slot + uint32_t(i));
+			return node;
+		}
+		default:
+			return INVALID_NODE;
+		}
+	}
+
+	void FlatAST::pretty_print() const {
+		// Subtree ends of the enclosing nodes, its size is the depth of the current node
+		std::vector<NodeIndex> open_nodes;
+
+		for (NodeIndex node = 0; node < size(); node++) {
+			while (!open_nodes.empty() && open_nodes.back() <= node)
+				open_nodes.pop_back();
+			std::cout << std::string(open_nodes.size(), '\t');
+			open_nodes.push_back(subtree_end(node));
+
+			switch (kind(node))
+			{
+			case NodeType::PROGRAM:
+				std::cout << "Program";
+				break;
+			case NodeType::FUNCTION_DECLARATION:
+			case NodeType::EXTERNAL_DECLARATION:
+				std::cout << (kind(node) == NodeType::FUNCTION_DECLARATION ? "Function " : "External Function ")
+					<< int(symbol(node).type) << " " << symbol(node).name << " (";
+				for (const FlatParameter& parameter : parameters(node))
+					std::cout << parameter.name << ", " << int(parameter.type) << " ";
+				std::cout << ")";
+				break;
+			case NodeType::VARIABLE:
+				std::cout << "Variable Declaration " << symbol(node).name << " " << int(symbol(node).type);
+				if (symbol(node).array_length)
+					std::cout << " [" << symbol(node).array_length << "]";
+				break;
+			case NodeType::RETURN_STATEMENT:
+				std::cout << "Return";
+				break;
+			case NodeType::EXPR_STATEMENT:
+				std::cout << "Expression";
+				break;
+			case NodeType::VOID_STATEMENT:
+				std::cout << "Void";
+				break;
+			case NodeType::BLOCK_STATEMENT:
+				std::cout << "Block";
+				break;
+			case NodeType::IF_STATEMENT:
+				std::cout << "If";
+				break;
+			case NodeType::LOOP_STATEMENT:
+				std::cout << "Loop " << loop_id(node);
+				break;
+			case NodeType::WHILE_STATEMENT:
+				std::cout << "While " << loop_id(node);
+				break;
+			case NodeType::FOR_STATEMENT:
+				std::cout << "For " << loop_id(node);
+				break;
+			case NodeType::BREAK_STATEMENT:
+				std::cout << "Break " << loop_id(node);
+				break;
+			case NodeType::CONTINUE_STATEMENT:
+				std::cout << "Continue " << loop_id(node);
+				break;
+			case NodeType::INT_LITERAL:
+				std::cout << literal(node);
+				break;
+			case NodeType::FLOAT_LITERAL:
+				std::cout << floating_literal(node);
+				break;
+			case NodeType::BOOL_LITERAL:
+				std::cout << (literal(node) ? "true" : "false");
+				break;
+			case NodeType::UNARY_OPERATION:
+			case NodeType::BINARY_OPERATION:
+				std::cout << get_spelling(operator_token(node).type);
+				break;
+			case NodeType::ASSIGNMENT:
+				std::cout << "Assign";
+				if (operator_token(node).type != EQUAL)
+					std::cout << " (" << get_spelling(operator_token(node).type) << ")";
+				break;
+			case NodeType::NAME_ACCESS:
+				std::cout << "Access(" << symbol(node).name << ")";
+				break;
+			case NodeType::INDEX:
+				std::cout << "Element(" << symbol(node).name << ")";
+				break;
+			case NodeType::FUNCTION_CALL:
+				std::cout << "Call: " << symbol(node).name;
+				break;
+			default:
+				break;
+			}
+			std::cout << "\n";
+		}
+	}
+}
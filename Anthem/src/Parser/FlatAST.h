@@ -0,0 +1,134 @@
+// FlatAST.h
+// Contains the FlatAST Class definition, a flat struct-of-arrays layout of the Abstract Syntax Tree
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#pragma once
+#include <span>
+#include <bit>
+#include "ASTNodes.h"
+
+namespace Anthem {
+	using NodeIndex = uint32_t;
+	constexpr NodeIndex INVALID_NODE = UINT32_MAX;
+
+	// Flat representation of a whole program. Nodes are numbered in pre-order, so a node's subtree is the range
+	// [index, subtree_end(index)) and walking the arrays front to back visits the tree in source order.
+	// Every node has a byte-sized kind and a 32-bit data word, whose meaning depends on the kind:
+	//	- UNARY_OPERATION, BINARY_OPERATION, ASSIGNMENT: index into the operator table
+	//	- INT_LITERAL, FLOAT_LITERAL, BOOL_LITERAL: index into the literal table, which holds the bit pattern of floating point literals
+	//	- VARIABLE, NAME_ACCESS, INDEX, FUNCTION_CALL, FUNCTION_DECLARATION, EXTERNAL_DECLARATION: index into the symbol table,
+	//	  an INDEX node has the symbol of its array and the index as its only child
+	//	- LOOP_STATEMENT, WHILE_STATEMENT, FOR_STATEMENT, BREAK_STATEMENT, CONTINUE_STATEMENT: loop id
+	class FlatAST {
+	public:
+		// Declaration information that does not fit in a node's data word
+		struct Symbol {
+			// Identifier Token, empty for function declarations
+			Token token;
+			Name name;
+			ReturnType type{ ReturnType::I32 };
+			VarFlag flag{ VarFlag::Local };
+
+			// Set on calls to external functions
+			bool is_external{ false };
+
+			// Range of the parameter table, for function declarations
+			uint32_t first_parameter{ 0 };
+			uint32_t parameter_count{ 0 };
+
+			// Number of elements of an array declaration, once it is type checked
+			uint32_t array_length{ 0 };
+		};
+
+		struct FlatParameter {
+			Name name;
+			ReturnType type;
+		};
+
+		FlatAST() = default;
+
+		// Flatten a parsed (and possibly analyzed) AST, the root PROGRAM node gets index 0
+		explicit FlatAST(const ProgramNode* program);
+
+		size_t size() const { return m_kinds.size(); }
+
+		NodeType kind(NodeIndex node) const { return m_kinds[node]; }
+
+		// Index one past the last node of the subtree starting at <node>
+		NodeIndex subtree_end(NodeIndex node) const { return m_subtree_ends[node]; }
+
+		// Direct children in source order. An if statement without an else body has 2 children,
+		// a variable declaration without an initializer has none
+		std::span<const NodeIndex> children(NodeIndex node) const {
+			return { m_children.data() + m_child_ranges[node].first, m_child_ranges[node].count };
+		}
+
+		const Token& operator_token(NodeIndex node) const { return m_operators[m_data[node]]; }
+		int64_t literal(NodeIndex node) const { return m_literals[m_data[node]]; }
+		double floating_literal(NodeIndex node) const { return std::bit_cast<double>(m_literals[m_data[node]]); }
+		const Symbol& symbol(NodeIndex node) const { return m_symbols[m_data[node]]; }
+		uint64_t loop_id(NodeIndex node) const { return m_data[node]; }
+
+		std::span<const FlatParameter> parameters(NodeIndex node) const {
+			const Symbol& function = symbol(node);
+			return { m_parameters.data() + function.first_parameter, function.parameter_count };
+		}
+
+		// Print the tree with one node per line, without recursion
+		void pretty_print() const;
+	private:
+		struct ChildRange {
+			uint32_t first{ 0 };
+			uint32_t count{ 0 };
+		};
+
+		// Pending work of the flattening, which walks the pointer AST with an explicit stack instead of recursion
+		struct FlattenItem {
+			enum Kind : uint8_t {
+				DECLARATION,
+				STATEMENT,
+				EXPRESSION,
+
+				// Set the subtree end of a node once all of its descendants were added
+				FINISH
+			};
+
+			Kind kind;
+			const ASTNode* node;
+
+			// Slot of m_children the flattened node is written to, or the node to finish
+			uint32_t target;
+		};
+
+		NodeIndex add_node(NodeType kind, uint32_t data = 0);
+
+		// Reserve <count> child slots for <node> and return the first one, the slots are filled by the scheduled children
+		uint32_t add_children(NodeIndex node, uint32_t count);
+
+		void schedule(FlattenItem::Kind kind, const ASTNode* node, uint32_t target);
+
+		uint32_t add_symbol(const Symbol& symbol);
+
+		NodeIndex flatten_declaration(const DeclarationNode* declaration);
+		NodeIndex flatten_statement(const StatementNode* statement);
+		NodeIndex flatten_expression(const ExpressionNode* expression);
+		uint32_t flatten_parameters(const ParameterList& parameters);
+	private:
+		// One entry per node
+		std::vector<NodeType> m_kinds;
+		std::vector<uint32_t> m_data;
+		std::vector<NodeIndex> m_subtree_ends;
+		std::vector<ChildRange> m_child_ranges;
+
+		// Child indices of all nodes, each node owns a contiguous range
+		std::vector<NodeIndex> m_children;
+
+		// Side tables
+		std::vector<Token> m_operators;
+		std::vector<int64_t> m_literals;
+		std::vector<Symbol> m_symbols;
+		std::vector<FlatParameter> m_parameters;
+
+		std::vector<FlattenItem> m_work_stack;
+	};
+}
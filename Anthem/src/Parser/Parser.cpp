@@ -6,258 +6,431 @@
 #include <iostream>
 
 namespace Anthem {
-	// Simple Utility
-	bool is_binary_operator(Token tok) {
-		switch (tok.type)
-		{
-		case PLUS:
-		case MINUS:
-		case STAR:
-		case SLASH:
-		case PERCENT:
-		case GREATER:
-		case GREATER_EQUAL:
-		case LESS:
-		case LESS_EQUAL:
-		case EQUAL:
-		case EQUAL_EQUAL:
-		case BANG_EQUAL:
-		case AND:
-		case OR:
-			return true;
-		default:
-			return false;
-		}
-	}
-
-	// Operator precedence, higher precedence = will get resolved first
-	uint8_t get_precedence(TokenType token_type) {
-		switch (token_type)
-		{
-		case PLUS:
-		case MINUS:
-			return 5;
-
-		case STAR:
-		case SLASH:
-		case PERCENT:
-			return 6;
-
-		case LESS:
-		case GREATER:
-		case LESS_EQUAL:
-		case GREATER_EQUAL:
-			return 4;
-
-		case EQUAL_EQUAL:
-		case BANG_EQUAL:
-			return 3;
-
-		case AND:
-			return 2;
-		case OR:
-			return 1;
-		case EQUAL:
-			return 0;
-		default:
-			break;
-		}
-	}
+	// How strongly an infix operator binds to the expressions around it, higher power = will get resolved first.
+	// An operator continues an expression if its left power is at least the expression's minimum power,
+	// its right operand is then parsed with the right power (equal powers make the operator right associative)
+	struct BindingPower {
+		uint8_t left{ 0 };
+		uint8_t right{ 0 };
+		bool is_assignment{ false };
+	};
+
+	// Indexed by TokenType, Tokens that are not infix operators have a left power of 0 and always end an expression
+	constexpr std::array<BindingPower, 256> binding_powers = [] {
+		std::array<BindingPower, 256> table{};
+		for (TokenType type : { EQUAL, PLUS_EQUAL, MINUS_EQUAL, STAR_EQUAL, SLASH_EQUAL })
+			table[type] = { 1, 1, true };
+
+		table[OR] = { 2, 3 };
+		table[AND] = { 3, 4 };
+
+		table[EQUAL_EQUAL] = table[BANG_EQUAL] = { 4, 5 };
+		table[LESS] = table[GREATER] = table[LESS_EQUAL] = table[GREATER_EQUAL] = { 5, 6 };
+
+		table[PLUS] = table[MINUS] = { 6, 7 };
+		table[STAR] = table[SLASH] = table[PERCENT] = { 7, 8 };
+		return table;
+	}();
 
 	// Boilerplate Consume Semicolon on every Statement
 #define CONSUME_SEMICOLON() if(!consume(SEMICOLON, "Expected ';'")) return nullptr;
 
 
-	Parser::Parser(ErrorHandler* error_handler) : m_error_handler{ error_handler } {}
+	Parser::Parser(ErrorHandler* error_handler, SourceManager* source_manager, ASTArena* arena) 
+		: m_error_handler{ error_handler }, m_source_manager{ source_manager }, m_arena{ arena } {}
 
-	ptr<ProgramNode> Parser::parse(const TokenList& token_list) {
-		m_current_token_index = -1;
-		m_tokens = token_list;
-		advance();
-		return parse_program();
+	ProgramNode* Parser::parse(Lexer& lexer, FileID file_id) {
+		m_lexer = &lexer;
+		m_token_list = nullptr;
+		m_lexer->begin(file_id);
+		return start_parsing();
 	}
 
-	void Parser::pretty_print(ptr<ASTNode> node, const std::string& padding) {
-		switch (node->get_type())
-		{
-			case NodeType::PROGRAM: {
-				ptr<ProgramNode> program_node = std::static_pointer_cast<ProgramNode>(node);
-				std::cout << "Program (\n";
-				for (auto& statement : program_node->declarations) {
-					pretty_print(statement, "\t");
-				}
-				std::cout << ")";
-				break;
-			}
-			case NodeType::FUNCTION_DECLARATION: {
-				ptr<FunctionDeclarationNode> function_node = std::static_pointer_cast<FunctionDeclarationNode>(node);
-				std::cout << padding << "Function " << int(function_node->return_type) << " " << function_node->name << " (";
-				for (auto& i : function_node->parameters) {
-					std::cout << i.name << ", " << int(i.type) << " ";
-				}
-				std::cout << ") (\n";
-				pretty_print(function_node->body, padding + "\t");
-				std::cout << padding << ")\n";
-				break;
+	ProgramNode* Parser::parse(const TokenList& tokens) {
+		return parse_range(tokens, 0, tokens.size());
+	}
+
+	ProgramNode* Parser::parse_range(const TokenList& tokens, size_t begin, size_t end) {
+		m_lexer = nullptr;
+		m_token_list = &tokens;
+		m_token_list_index = begin;
+		m_token_list_end = end;
+		return start_parsing();
+	}
+
+	ProgramNode* Parser::parse_parallel(const TokenList& tokens, ThreadPool& thread_pool) {
+		// A few chunks per thread even out the differences in how long each chunk takes
+		size_t chunk_count = std::min(thread_pool.size() * 4, tokens.size() / MIN_CHUNK_TOKENS);
+		std::vector<uint32_t> declaration_starts;
+		if (thread_pool.size() < 2 || chunk_count < 2 || m_error_handler->has_errors() || !find_declarations(tokens, declaration_starts))
+			return parse(tokens);
+
+		// Every chunk gets whole declarations and about the same number of Tokens, each is parsed by its own Parser into its own arena
+		struct Chunk {
+			size_t begin{ 0 };
+			size_t end{ 0 };
+			ASTArena* arena{ nullptr };
+			ErrorHandler error_handler;
+			ProgramNode* program{ nullptr };
+		};
+
+		std::vector<Chunk> chunks;
+		for (size_t i = 0; i + 1 < declaration_starts.size(); i++) {
+			if (chunks.empty() || declaration_starts[i] >= tokens.size() * chunks.size() / chunk_count) {
+				if (!chunks.empty())
+					chunks.back().end = declaration_starts[i];
+				chunks.push_back({ declaration_starts[i], 0, m_arena->make_arena(), ErrorHandler{ m_source_manager } });
 			}
-			case NodeType::EXTERNAL_DECLARATION: {
-				ptr<ExternalFunctionNode> external_node = std::static_pointer_cast<ExternalFunctionNode>(node);
-				std::cout << padding << "External Function " << external_node->name << " (";
-				for (auto& i : external_node->parameters) {
-					std::cout << i.name << ", ";
-				}
-				std::cout << ")\n";
-				break;
+		}
+		if (chunks.size() < 2)
+			return parse(tokens);
+		chunks.back().end = declaration_starts.back();
+
+		thread_pool.parallel_for(chunks.size(), [&](size_t i) {
+			Parser chunk_parser(&chunks[i].error_handler, m_source_manager, chunks[i].arena);
+			chunks[i].program = chunk_parser.parse_range(tokens, chunks[i].begin, chunks[i].end);
+			});
+
+		// A chunk Parser that recovers from an error may read past the end of its chunk, and the error limit counts the errors of
+		// the whole file. Errors are rare, so the file is parsed again serially to report the same errors in the same order
+		size_t declaration_count = 0;
+		for (Chunk& chunk : chunks) {
+			if (chunk.error_handler.has_errors())
+				return parse(tokens);
+			declaration_count += chunk.program->declarations.size();
+		}
+
+		DeclarationList declarations{ m_arena->resource() };
+		declarations.reserve(declaration_count);
+		for (const Chunk& chunk : chunks)
+			declarations.insert(declarations.end(), chunk.program->declarations.begin(), chunk.program->declarations.end());
+		return m_arena->make<ProgramNode>(std::move(declarations));
+	}
+
+	bool Parser::find_declarations(const TokenList& tokens, std::vector<uint32_t>& declaration_starts) {
+		declaration_starts.clear();
+		int depth = 0;
+		bool at_declaration_start = true;
+
+		// Set between 'fn' and the end of its parameter list, where the Parser interns every identifier
+		bool in_function_header = false;
+
+		uint32_t index = 0;
+		for (; index < tokens.size() && tokens[index].type != SPECIAL_EOF; index++) {
+			const Token& token = tokens[index];
+			if (at_declaration_start) {
+				declaration_starts.push_back(index);
+				at_declaration_start = false;
 			}
-			case NodeType::RETURN_STATEMENT: {
-				ptr<ReturnStatementNode> return_node = std::static_pointer_cast<ReturnStatementNode>(node);
-				std::cout << padding << "Return ";
-				pretty_print(return_node->expression);
-				std::cout << "\n";
+
+			switch (token.type)
+			{
+			case SPECIAL_ERROR:
+				return false;
+			case FUNCTION:
+				in_function_header = depth == 0;
 				break;
-			}
-			case NodeType::INT_LITERAL: {
-				std::cout << std::static_pointer_cast<IntegerLiteralNode>(node)->integer;
+			case IDENTIFIER:
+				// Interning the names here keeps their order (and so the generated code) independent of the thread timing
+				if (in_function_header)
+					Name(get_text(token));
 				break;
-			}
-			case NodeType::UNARY_OPERATION: {
-				ptr<UnaryOperationNode> unary_op = std::static_pointer_cast<UnaryOperationNode>(node);
-				std::cout << unary_op->operator_token.value << '(';
-				pretty_print(unary_op->expression);
-				std::cout << ')';
+			case RIGHT_PARENTHESIS:
+				in_function_header = false;
 				break;
-			}
-			case NodeType::BINARY_OPERATION: {
-				ptr<BinaryOperationNode> binary_op = std::static_pointer_cast<BinaryOperationNode>(node);
-				std::cout << '(';
-				pretty_print(binary_op->left_expression);
-				std::cout << ' ';
-				std::cout << binary_op->operator_token.value;
-				std::cout << ' ';
-				pretty_print(binary_op->right_expression);
-				std::cout << ')';
+			case LEFT_BRACE:
+				depth++;
 				break;
-			}
-			case NodeType::NAME_ACCESS: {
-				ptr<AccessNode> access = std::static_pointer_cast<AccessNode>(node);
-				std::cout << "Access(" << access->variable_token.value << ")";
+			case RIGHT_BRACE:
+			case SEMICOLON:
+				if (token.type == RIGHT_BRACE && --depth < 0)
+					return false;
+
+				// A declaration may only end where the next one starts, e.g. not between an if body and its else
+				if (depth == 0 && index + 1 < tokens.size()) {
+					switch (tokens[index + 1].type)
+					{
+					case FUNCTION:
+					case EXTERNAL:
+					case INTERNAL:
+					case GLOBAL:
+					case CONST:
+					case SPECIAL_EOF:
+						at_declaration_start = true;
+						break;
+					default:
+						break;
+					}
+				}
 				break;
-			}
-			case NodeType::EXPR_STATEMENT: {
-				ptr<ExprStatementNode> expression = std::static_pointer_cast<ExprStatementNode>(node);
-				std::cout << padding << "Expression ";
-				pretty_print(expression->expression);
-				std::cout << "\n";
+			default:
 				break;
 			}
-			case NodeType::VOID_STATEMENT: {
-				std::cout << padding << "Void\n";
-				break;
+		}
+
+		if (depth != 0 || index == tokens.size())
+			return false;
+		declaration_starts.push_back(index);
+		return true;
+	}
+
+	ProgramNode* Parser::start_parsing() {
+		m_panic_mode = false;
+		m_stopped = false;
+
+		// Pull the first Token
+		m_lookahead_start = 0;
+		m_lexer_failed = false;
+		m_lookahead[0] = pull_token();
+		m_lookahead_count = 1;
+
+		return parse_program();
+	}
+
+	void Parser::pretty_print(ASTNode* root, const std::string& root_padding) {
+		// Something left to print, either a node or a piece of text (preceded by <padding>)
+		struct PrintItem {
+			const ASTNode* node{ nullptr };
+			std::string padding;
+			std::string text;
+		};
+
+		// Items are printed from an explicit stack instead of recursing into the children, each node pushes
+		// its children and the text between them in reverse, so they are printed in order
+		std::vector<PrintItem> stack{ { root, root_padding, "" } };
+		std::vector<PrintItem> parts;
+		auto node = [&](const ASTNode* child, const std::string& padding = "") { parts.push_back({ child, padding, "" }); };
+		auto text = [&](const std::string& piece, const std::string& padding = "") { parts.push_back({ nullptr, padding, piece }); };
+
+		while (!stack.empty()) {
+			PrintItem item = std::move(stack.back());
+			stack.pop_back();
+			if (!item.node) {
+				std::cout << item.padding << item.text;
+				continue;
 			}
-			case NodeType::VARIABLE: {
-				ptr<VariableNode> variable = std::static_pointer_cast<VariableNode>(node);
-				std::cout << padding << "Variable Declaration " << variable->variable_token.value << " " << int(variable->type);
-				if (variable->expression) {
-					pretty_print(variable->expression);
-					std::cout << "\n";
+
+			const std::string& padding = item.padding;
+			parts.clear();
+			switch (item.node->get_type())
+			{
+				case NodeType::PROGRAM: {
+					auto program_node = static_cast<const ProgramNode*>(item.node);
+					std::cout << "Program (\n";
+					for (auto& statement : program_node->declarations) {
+						node(statement, "\t");
+					}
+					text(")");
+					break;
 				}
-				break;
-			}
-			case NodeType::ASSIGNMENT: {
-				ptr<AssignmentNode> assignment = std::static_pointer_cast<AssignmentNode>(node);
-				std::cout << "Assign ";
-				pretty_print(assignment->expression);
-				std::cout << " to ";
-				pretty_print(assignment->lvalue);
-				break;
-			}
-			case NodeType::BLOCK_STATEMENT: {
-				ptr<BlockStatementNode> block = std::static_pointer_cast<BlockStatementNode>(node);
-				for(auto& item : block->items) {
-					if (std::holds_alternative<ptr<StatementNode>>(item))
-						pretty_print(std::get<ptr<StatementNode>>(item), padding);
-					else 
-						pretty_print(std::get<ptr<DeclarationNode>>(item), padding);
+				case NodeType::FUNCTION_DECLARATION: {
+					auto function_node = static_cast<const FunctionDeclarationNode*>(item.node);
+					std::cout << padding << (function_node->is_const ? "Const Function " : "Function ") << int(function_node->return_type) << " " << function_node->name << " (";
+					for (auto& i : function_node->parameters) {
+						std::cout << i.name << ", " << int(i.type) << " ";
+					}
+					std::cout << ") (\n";
+					node(function_node->body, padding + "\t");
+					text(")\n", padding);
+					break;
 				}
-				break;
-			}
-			case NodeType::IF_STATEMENT: {
-				ptr<IfStatementNode> if_statement = std::static_pointer_cast<IfStatementNode>(node);
-				std::cout << padding << "If: ";
-				pretty_print(if_statement->condition);
-				std::cout << " then:\n";
-				pretty_print(if_statement->body, padding + "\t");
-				std::cout << "\n";
-				if (if_statement->else_body) {
-					std::cout << padding << "Else:\n";
-					pretty_print(if_statement->else_body, padding + "\t");
-					std::cout << "\n";
+				case NodeType::EXTERNAL_DECLARATION: {
+					auto external_node = static_cast<const ExternalFunctionNode*>(item.node);
+					std::cout << padding << "External Function " << external_node->name << " (";
+					for (auto& i : external_node->parameters) {
+						std::cout << i.name << ", ";
+					}
+					std::cout << ")\n";
+					break;
 				}
-				break;
-			}
-			case NodeType::LOOP_STATEMENT: {
-				ptr<LoopStatementNode> loop_statement = std::static_pointer_cast<LoopStatementNode>(node);
-				std::cout << padding << "Loop:\n";
-				pretty_print(loop_statement->body, padding + "\t");
-				break;
-			}
-			case NodeType::WHILE_STATEMENT: {
-				ptr<WhileStatementNode> while_statement = std::static_pointer_cast<WhileStatementNode>(node);
-				std::cout << padding << "While: ";
-				pretty_print(while_statement->condition);
-				std::cout << " do:\n";
-				pretty_print(while_statement->body, padding + "\t");
-				break;
-			}
-			case NodeType::FOR_STATEMENT: {
-				ptr<ForStatementNode> for_statement = std::static_pointer_cast<ForStatementNode>(node);
-				std::cout << padding << "For: Init: ";
-				pretty_print(for_statement->init);
-				std::cout << " While ";
-				pretty_print(for_statement->condition);
-				std::cout << " Post ";
-				pretty_print(for_statement->post_loop);
-				std::cout << " do:\n";
-				pretty_print(for_statement->body, padding + "\t");
-				break;
-			}
-			case NodeType::FUNCTION_CALL: {
-				ptr<FunctionCallNode> call = std::static_pointer_cast<FunctionCallNode>(node);
-				std::cout << padding << "Call: " << call->variable_token.value << " (";
-				for (auto& expr : call->argument_list) {
-					pretty_print(expr);
-					std::cout << ", ";
+				case NodeType::RETURN_STATEMENT: {
+					auto return_node = static_cast<const ReturnStatementNode*>(item.node);
+					std::cout << padding << "Return ";
+					node(return_node->expression);
+					text("\n");
+					break;
+				}
+				case NodeType::INT_LITERAL: {
+					std::cout << static_cast<const IntegerLiteralNode*>(item.node)->integer;
+					break;
+				}
+				case NodeType::FLOAT_LITERAL: {
+					auto float_literal = static_cast<const FloatLiteralNode*>(item.node);
+					std::cout << float_literal->floating << (float_literal->type == ReturnType::F32 ? "f" : "");
+					break;
+				}
+				case NodeType::BOOL_LITERAL: {
+					std::cout << (static_cast<const BoolLiteralNode*>(item.node)->value ? "true" : "false");
+					break;
+				}
+				case NodeType::UNARY_OPERATION: {
+					auto unary_op = static_cast<const UnaryOperationNode*>(item.node);
+					std::cout << get_spelling(unary_op->operator_token.type) << '(';
+					node(unary_op->expression);
+					text(")");
+					break;
+				}
+				case NodeType::BINARY_OPERATION: {
+					auto binary_op = static_cast<const BinaryOperationNode*>(item.node);
+					std::cout << '(';
+					node(binary_op->left_expression);
+					text(" " + std::string(get_spelling(binary_op->operator_token.type)) + " ");
+					node(binary_op->right_expression);
+					text(")");
+					break;
+				}
+				case NodeType::NAME_ACCESS: {
+					auto access = static_cast<const AccessNode*>(item.node);
+					std::cout << "Access(" << access->identifier << ")";
+					break;
 				}
-				std::cout << ")";
+				case NodeType::INDEX: {
+					auto index = static_cast<const IndexNode*>(item.node);
+					std::cout << "Element(" << index->array->identifier << ", ";
+					node(index->index);
+					text(")");
+					break;
+				}
+				case NodeType::EXPR_STATEMENT: {
+					auto expression = static_cast<const ExprStatementNode*>(item.node);
+					std::cout << padding << "Expression ";
+					node(expression->expression);
+					text("\n");
+					break;
+				}
+				case NodeType::VOID_STATEMENT: {
+					std::cout << padding << "Void\n";
+					break;
+				}
+				case NodeType::VARIABLE: {
+					auto variable = static_cast<const VariableNode*>(item.node);
+					std::cout << padding << "Variable Declaration " << variable->identifier << " " << int(variable->type);
+					if (variable->length_expression) {
+						text("[");
+						node(variable->length_expression);
+						text("]");
+					}
+					if (variable->expression) {
+						node(variable->expression);
+						text("\n");
+					}
+					break;
+				}
+				case NodeType::ASSIGNMENT: {
+					auto assignment = static_cast<const AssignmentNode*>(item.node);
+					std::cout << "Assign ";
+					if (assignment->token.type != EQUAL)
+						std::cout << "(" << get_spelling(assignment->token.type) << ") ";
+					node(assignment->expression);
+					text(" to ");
+					node(assignment->lvalue);
+					break;
+				}
+				case NodeType::BLOCK_STATEMENT: {
+					auto block = static_cast<const BlockStatementNode*>(item.node);
+					for(auto& block_item : block->items) {
+						if (std::holds_alternative<StatementNode*>(block_item))
+							node(std::get<StatementNode*>(block_item), padding);
+						else 
+							node(std::get<DeclarationNode*>(block_item), padding);
+					}
+					break;
+				}
+				case NodeType::IF_STATEMENT: {
+					auto if_statement = static_cast<const IfStatementNode*>(item.node);
+					std::cout << padding << "If: ";
+					node(if_statement->condition);
+					text(" then:\n");
+					node(if_statement->body, padding + "\t");
+					text("\n");
+					if (if_statement->else_body) {
+						text("Else:\n", padding);
+						node(if_statement->else_body, padding + "\t");
+						text("\n");
+					}
+					break;
+				}
+				case NodeType::LOOP_STATEMENT: {
+					auto loop_statement = static_cast<const LoopStatementNode*>(item.node);
+					std::cout << padding << "Loop:\n";
+					node(loop_statement->body, padding + "\t");
+					break;
+				}
+				case NodeType::WHILE_STATEMENT: {
+					auto while_statement = static_cast<const WhileStatementNode*>(item.node);
+					std::cout << padding << "While: ";
+					node(while_statement->condition);
+					text(" do:\n");
+					node(while_statement->body, padding + "\t");
+					break;
+				}
+				case NodeType::FOR_STATEMENT: {
+					auto for_statement = static_cast<const ForStatementNode*>(item.node);
+					std::cout << padding << "For: Init: ";
+					node(for_statement->init);
+					text(" While ");
+					node(for_statement->condition);
+					text(" Post ");
+					node(for_statement->post_loop);
+					text(" do:\n");
+					node(for_statement->body, padding + "\t");
+					break;
+				}
+				case NodeType::FUNCTION_CALL: {
+					auto call = static_cast<const FunctionCallNode*>(item.node);
+					std::cout << padding << "Call: " << call->identifier << " (";
+					for (auto& expr : call->argument_list) {
+						node(expr);
+						text(", ");
+					}
+					text(")");
+					break;
+				}
+			default:
 				break;
 			}
-		default:
-			break;
+			stack.insert(stack.end(), std::make_move_iterator(parts.rbegin()), std::make_move_iterator(parts.rend()));
 		}
 	}
 
 	void Parser::advance() {
-		m_current_token_index++;
-		if (m_current_token_index < m_tokens.size())
-			m_current_token = &m_tokens[m_current_token_index];
+		// Drop the current Token, the Lexer keeps returning End of File Tokens after the end
+		m_lookahead_start = (m_lookahead_start + 1) % LOOKAHEAD;
+		if (--m_lookahead_count == 0) {
+			m_lookahead[m_lookahead_start] = pull_token();
+			m_lookahead_count = 1;
+		}
+	}
+
+	Token Parser::pull_token() {
+		Token token;
+		if (m_stopped)
+			return m_end_token;
+		if (m_lexer)
+			token = m_lexer->next_token();
+		// Keep returning the End of File Token at the end of the list, like the Lexer does
 		else
-			m_current_token = &m_tokens[m_tokens.size() - 1];
-			
+			token = m_token_list_index < m_token_list_end ? (*m_token_list)[m_token_list_index++] : m_token_list->back();
+		if (token.type == SPECIAL_ERROR)
+			m_lexer_failed = true;
+		return token;
 	}
 
 	const Token& Parser::current_token() const {
-		return *m_current_token;
+		return m_lookahead[m_lookahead_start];
 	}
 
-	const Token& Parser::peek(uint32_t depth) const {
-		int index = m_current_token_index + depth;
-		if (index < m_tokens.size())
-			return m_tokens[index];
+	const Token& Parser::peek(uint32_t depth) {
+		while (m_lookahead_count <= depth) {
+			m_lookahead[(m_lookahead_start + m_lookahead_count) % LOOKAHEAD] = pull_token();
+			m_lookahead_count++;
+		}
+		return m_lookahead[(m_lookahead_start + depth) % LOOKAHEAD];
 	}
 
 	bool Parser::consume(TokenType token_type, const std::string& error_message) {
 		if (match(token_type)) return true;
-		report_error(error_message + ", got " + current_token().value + " Token");
+		report_error(error_message + ", got " + std::string(get_text(current_token())) + " Token");
 		return false;
 	}
 
@@ -273,45 +446,94 @@ namespace Anthem {
 		return current_token().type == token_type;
 	}
 
+	std::string_view Parser::get_text(const Token& token) const {
+		if (token.type == SPECIAL_EOF)
+			return get_spelling(SPECIAL_EOF);
+		return m_source_manager->get_text(token.file_id, token.offset, token.size());
+	}
+
 	void Parser::report_error(const std::string& error_message) {
-		m_error_handler->report_error(Error{ error_message, current_token().position });
-		m_error_occured = true;
+		// Once the Lexer reported an error, any error that follows is caused by the missing Tokens.
+		// In panic mode the error is most likely caused by the previous one, so it is only reported once the Parser synchronized
+		if (!m_lexer_failed && !m_panic_mode)
+			m_error_handler->report_error(Error{ error_message, current_token().position() });
+		m_panic_mode = true;
+		if (m_error_handler->error_limit_reached())
+			stop_parsing();
 		stabilize();
 	}
 
 	void Parser::stabilize() {
-		while (current_token().type != TokenType::SPECIAL_EOF) {
-			const Token& tok = current_token();
-
-			// Stop skipping tokens if a semicolon or certain keyword is found
-			if (tok.type == TokenType::SEMICOLON) {
+		while (current_token().type != SPECIAL_EOF) {
+			// Stop skipping tokens after a semicolon or before a Token that starts a statement, ends a block or starts a declaration
+			switch (current_token().type)
+			{
+			case SEMICOLON:
 				advance();
 				return;
-			}
-			if (tok.value == "if" || tok.value == "fn" || tok.value == "let"
-				|| tok.value == "while" || tok.value == "for" || tok.value == "loop" || tok.type == TokenType::LEFT_BRACE)
+			case IF:
+			case LET:
+			case WHILE:
+			case FOR:
+			case LOOP:
+			case RETURN:
+			case BREAK:
+			case CONTINUE:
+			case LEFT_BRACE:
+			case RIGHT_BRACE:
+			case FUNCTION:
+			case EXTERNAL:
+			case INTERNAL:
+			case GLOBAL:
+			case CONST:
 				return;
+			default:
+				break;
+			}
 			advance();
 		}
 	}
 
-	ptr<ProgramNode> Parser::parse_program() {
-		ptr<ProgramNode> program_node = std::make_shared<ProgramNode>();
-
-		while (current_token().type != SPECIAL_EOF && !m_error_occured) {
-			program_node->declarations.push_back(parse_declaration());
+	bool Parser::is_declaration_start() const {
+		switch (current_token().type)
+		{
+		case FUNCTION:
+		case EXTERNAL:
+		case INTERNAL:
+		case GLOBAL:
+		case CONST:
+			return true;
+		default:
+			return false;
 		}
+	}
 
-		return program_node;
+	void Parser::stop_parsing() {
+		m_stopped = true;
+		m_end_token = Token{ SPECIAL_EOF, current_token().file_id, current_token().offset, 0 };
+		m_lookahead[m_lookahead_start] = m_end_token;
+		m_lookahead_count = 1;
 	}
 
-	BlockItem Parser::parse_block_item() {
-		if (is_current(LET))
-			return parse_variable_declaration();
-		return parse_statement();
+	ProgramNode* Parser::parse_program() {
+		DeclarationList declarations{ m_arena->resource() };
+
+		while (current_token().type != SPECIAL_EOF) {
+			m_panic_mode = false;
+			if (DeclarationNode* declaration = parse_declaration())
+				declarations.push_back(declaration);
+
+			// A declaration that could not be recovered inside is skipped up to the start of the next one
+			if (m_panic_mode) {
+				while (!is_declaration_start() && !is_current(SPECIAL_EOF))
+					advance();
+			}
+		}
+
+		return m_arena->make<ProgramNode>(std::move(declarations));
 	}
 
-	ptr<DeclarationNode> Parser::parse_declaration() {
+	DeclarationNode* Parser::parse_declaration() {
 		switch (current_token().type) {
 		case FUNCTION:
 			advance();
@@ -332,20 +554,26 @@ namespace Anthem {
 			return parse_variable_declaration(VarFlag::Internal);
 		case GLOBAL:
 			return parse_variable_declaration(VarFlag::Global);
+		case CONST:
+			// Constant functions can also be evaluated at compile time
+			advance();
+			if (!consume(FUNCTION, "Expected 'fn' after 'const'")) return nullptr;
+			return parse_function_declaration(VarFlag::Global, true);
 		default:
 			report_error("Expected a declaration");
 		}
 		return nullptr;
 	}
 
-	ptr<DeclarationNode> Parser::parse_function_declaration(VarFlag flag) {
+	DeclarationNode* Parser::parse_function_declaration(VarFlag flag, bool is_const) {
 		// Save identifier
 		Token identifier = current_token();
 		if (!consume(IDENTIFIER, "Expected Function Identifier")) return nullptr;
+		Name name(get_text(identifier));
 
 		// Handle Arguments
 		if (!consume(LEFT_PARENTHESIS, "Expected '('")) return nullptr;
-		std::vector<Parameter> parameter_list;
+		ParameterList parameter_list{ m_arena->resource() };
 
 		while (!is_current(RIGHT_PARENTHESIS) && !is_current(SPECIAL_EOF)) {
 			Token current_tok = current_token();
@@ -361,7 +589,7 @@ namespace Anthem {
 				report_error("Expected Type after ':'");
 			advance();
 
-			parameter_list.push_back({ current_tok.value, type });
+			parameter_list.push_back({ Name(get_text(current_tok)), type, nullptr, {} });
 
 			if (is_current(COMMA))
 				advance();
@@ -382,23 +610,25 @@ namespace Anthem {
 		advance();
 
 		// Parse Function Body - Can be a single statement
-		ptr<StatementNode> body = parse_statement();
+		StatementNode* body = parse_statement();
 
-		ptr<FunctionDeclarationNode> func = std::make_shared<FunctionDeclarationNode>(identifier.value, body, parameter_list);
+		FunctionDeclarationNode* func = m_arena->make<FunctionDeclarationNode>(name, body, std::move(parameter_list));
 		func->return_type = type;
 		func->flag = flag;
+		func->is_const = is_const;
 
 		return func;
 	}
 
-	ptr<DeclarationNode> Parser::parse_external() {
+	DeclarationNode* Parser::parse_external() {
 		// Save identifier
 		Token identifier = current_token();
 		if (!consume(IDENTIFIER, "Expected Function Identifier")) return nullptr;
+		Name name(get_text(identifier));
 
 		// Handle Arguments
 		if (!consume(LEFT_PARENTHESIS, "Expected '('")) return nullptr;
-		std::vector<Parameter> parameter_list;
+		ParameterList parameter_list{ m_arena->resource() };
 
 		while (!is_current(RIGHT_PARENTHESIS) && !is_current(SPECIAL_EOF)) {
 			Token current_tok = current_token();
@@ -414,7 +644,7 @@ namespace Anthem {
 				report_error("Expected Type after ':'");
 			advance();
 
-			parameter_list.push_back({ current_tok.value, type });
+			parameter_list.push_back({ Name(get_text(current_tok)), type, nullptr, {} });
 
 			if (is_current(COMMA))
 				advance();
@@ -436,17 +666,20 @@ namespace Anthem {
 
 		CONSUME_SEMICOLON();
 
-		return std::make_shared<ExternalFunctionNode>(identifier.value, parameter_list, type);
+		return m_arena->make<ExternalFunctionNode>(name, std::move(parameter_list), type);
 	}
 
-	ptr<DeclarationNode> Parser::parse_variable_declaration(VarFlag flag) {
+	DeclarationNode* Parser::parse_variable_declaration(VarFlag flag) {
 		advance();
 		Token identifier_token = current_token();
 		consume(IDENTIFIER, "Expected identifier");
-		ptr<VariableNode> variable = nullptr;
+		VariableNode* variable = nullptr;
 		ReturnType type;
 		if (!match(COLON))
 			report_error("Expected ':'");
+
+		// Arrays are declared as '[type; length]'
+		bool is_array = match(LEFT_BRACKET);
 		if (is_type_token(current_token()))
 			type = get_type(current_token());
 		else
@@ -454,194 +687,365 @@ namespace Anthem {
 
 		advance();
 
+		ExpressionNode* length = nullptr;
+		if (is_array) {
+			consume(SEMICOLON, "Expected ';' after the element type of the array");
+			length = parse_expression();
+			consume(RIGHT_BRACKET, "Expected ']'");
+		}
+
 		// If there is assignment parse the expression given
 		if (match(EQUAL))
-			variable = std::make_shared<VariableNode>(identifier_token, type, parse_expression());
+			variable = m_arena->make<VariableNode>(identifier_token, type, parse_expression());
 		else
-			variable = std::make_shared<VariableNode>(identifier_token, type);
+			variable = m_arena->make<VariableNode>(identifier_token, type);
 
+		variable->identifier = get_text(identifier_token);
 		variable->flag = flag;
+		variable->length_expression = length;
 
 		CONSUME_SEMICOLON();
 
 		return variable;
 	}
 
-	ptr<StatementNode> Parser::parse_statement() {
+	StatementNode* Parser::parse_statement() {
+		// Statements nested in blocks, ifs and loops are kept on an explicit stack instead of the call stack,
+		// so the nesting depth is only limited by memory
+		size_t base = m_statement_stack.size();
+		StatementNode* statement = nullptr;
+		while (true) {
+			// Descend into nested statements until one without nested statements is parsed
+			if (!begin_statement(statement))
+				continue;
+
+			// Hand it to the enclosing statements, until one of them needs another nested statement
+			while (m_statement_stack.size() > base && complete_statement(statement)) {}
+			if (m_statement_stack.size() == base)
+				return statement;
+		}
+	}
+
+	bool Parser::begin_statement(StatementNode*& statement) {
+		// Errors are reported again from the start of the next statement
+		m_panic_mode = false;
 		switch (current_token().type)
 		{
 		case RETURN:
-			return parse_return_statement();
+			statement = parse_return_statement();
+			return true;
 		case IF:
-			return parse_if_statement();
+			parse_if_statement();
+			return false;
 		case WHILE:
-			return parse_while_statement();
+			parse_while_statement();
+			return false;
 		case FOR:
-			return parse_for_statement();
+			parse_for_statement();
+			return false;
 		case LOOP:
-			return parse_loop_statement();
+			parse_loop_statement();
+			return false;
 		case BREAK:
-			advance();
-			CONSUME_SEMICOLON();
-			return std::make_shared<BreakStatementNode>();
+			statement = parse_jump_statement<BreakStatementNode>();
+			return true;
 		case CONTINUE:
-			advance();
-			CONSUME_SEMICOLON();
-			return std::make_shared<ContinueStatementNode>();
+			statement = parse_jump_statement<ContinueStatementNode>();
+			return true;
 		case LEFT_BRACE:
-			return parse_block_statement();
+			parse_block_statement();
+			return continue_block(statement);
 		case SEMICOLON:
 			advance();
-			return std::make_shared<VoidStatementNode>();
+			statement = m_arena->make<VoidStatementNode>();
+			return true;
 		// If nothing matches, then it probably will be an expression statement
 		default:
-			return parse_expr_statement();
+			statement = parse_expr_statement();
+			return true;
+		}
+	}
+
+	bool Parser::complete_statement(StatementNode*& statement) {
+		StatementFrame& frame = m_statement_stack.back();
+		switch (frame.type)
+		{
+		case NodeType::BLOCK_STATEMENT:
+			static_cast<BlockStatementNode*>(frame.node)->items.push_back(statement);
+			return continue_block(statement);
+		case NodeType::IF_STATEMENT: {
+			auto if_statement = static_cast<IfStatementNode*>(frame.node);
+			if (frame.in_else_body)
+				if_statement->else_body = statement;
+			else {
+				if_statement->body = statement;
+				// Parse the else body before the if statement is done
+				if (match(ELSE)) {
+					frame.in_else_body = true;
+					return false;
+				}
+			}
+			break;
+		}
+		case NodeType::LOOP_STATEMENT:
+			static_cast<LoopStatementNode*>(frame.node)->body = statement;
+			break;
+		case NodeType::WHILE_STATEMENT:
+			static_cast<WhileStatementNode*>(frame.node)->body = statement;
+			break;
+		case NodeType::FOR_STATEMENT:
+			static_cast<ForStatementNode*>(frame.node)->body = statement;
+			break;
+		default:
+			break;
+		}
+
+		statement = frame.node;
+		m_statement_stack.pop_back();
+		return true;
+	}
+
+	bool Parser::continue_block(StatementNode*& statement) {
+		auto block = static_cast<BlockStatementNode*>(m_statement_stack.back().node);
+		// A top level declaration can not be inside a block, so the block is missing its '}'
+		while (!is_current(RIGHT_BRACE) && !is_current(SPECIAL_EOF) && !is_declaration_start()) {
+			// Declarations do not contain statements, so they are parsed right away
+			if (!is_current(LET))
+				return false;
+			m_panic_mode = false;
+			if (DeclarationNode* declaration = parse_variable_declaration())
+				block->items.push_back(declaration);
 		}
+
+		consume(RIGHT_BRACE, "Expected '}'");
+
+		statement = block;
+		m_statement_stack.pop_back();
+		return true;
 	}
 
-	ptr<ReturnStatementNode> Parser::parse_return_statement() {
+	ReturnStatementNode* Parser::parse_return_statement() {
 		advance();
 		// Parse the expression inside the return statement
-		ptr<ExpressionNode> expression = parse_expression();
+		ExpressionNode* expression = parse_expression();
 		
 		CONSUME_SEMICOLON()
 
-		return std::make_shared<ReturnStatementNode>(expression);
+		return m_arena->make<ReturnStatementNode>(expression);
 	}
 
-	ptr<BlockStatementNode> Parser::parse_block_statement() {
+	template<typename T>
+	T* Parser::parse_jump_statement() {
 		advance();
-		auto block_statement = std::make_shared<BlockStatementNode>();
-		// Parse the expression inside the return statement
-		while(!is_current(RIGHT_BRACE) && !is_current(SPECIAL_EOF))
-			block_statement->items.push_back(parse_block_item());
-
-		consume(RIGHT_BRACE, "Expected '}'");
+		CONSUME_SEMICOLON();
+		return m_arena->make<T>();
+	}
 
-		return block_statement;
+	void Parser::parse_block_statement() {
+		advance();
+		BlockStatementNode* block = m_arena->make<BlockStatementNode>(BlockItems{ m_arena->resource() });
+		m_statement_stack.push_back({ block, NodeType::BLOCK_STATEMENT });
 	}
 
-	ptr<ExprStatementNode> Parser::parse_expr_statement() {
-		ptr<ExpressionNode> expression = parse_expression();
+	ExprStatementNode* Parser::parse_expr_statement() {
+		ExpressionNode* expression = parse_expression();
 
 		CONSUME_SEMICOLON();
 
-		return std::make_shared<ExprStatementNode>(expression);
+		return m_arena->make<ExprStatementNode>(expression);
 	}
 
-	ptr<IfStatementNode> Parser::parse_if_statement() {
+	void Parser::parse_if_statement() {
 		advance();
-		ptr<ExpressionNode> condition = parse_expression();
+		ExpressionNode* condition = parse_expression();
 
 		consume(ARROW, "Expected '->' after if condition");
 
-		ptr<StatementNode> if_body = parse_statement();
-		ptr<StatementNode> else_body = nullptr;
-
-		if (match(ELSE))
-			else_body = parse_statement();
-
-		return std::make_shared<IfStatementNode>(condition, if_body, else_body);
+		m_statement_stack.push_back({ m_arena->make<IfStatementNode>(condition, nullptr, nullptr), NodeType::IF_STATEMENT });
 	}
 
-	ptr<LoopStatementNode> Parser::parse_loop_statement() {
+	void Parser::parse_loop_statement() {
 		advance();
-		return std::make_shared<LoopStatementNode>(parse_statement());
+		m_statement_stack.push_back({ m_arena->make<LoopStatementNode>(nullptr), NodeType::LOOP_STATEMENT });
 	}
 
-	ptr<WhileStatementNode> Parser::parse_while_statement() {
+	void Parser::parse_while_statement() {
 		advance();
-		ptr<ExpressionNode> condition = parse_expression();
+		ExpressionNode* condition = parse_expression();
 
 		consume(ARROW, "Expected '->' after if condition");
 
-		ptr<StatementNode> while_body = parse_statement();
-
-		return std::make_shared<WhileStatementNode>(condition, while_body);
+		m_statement_stack.push_back({ m_arena->make<WhileStatementNode>(condition, nullptr), NodeType::WHILE_STATEMENT });
 	}
 
-	ptr<ForStatementNode> Parser::parse_for_statement() {
+	void Parser::parse_for_statement() {
 		advance();
-		ptr<ExpressionNode> init = parse_expression();
+		ExpressionNode* init = parse_expression();
 		consume(SEMICOLON, "Expected ';'");
 
-		ptr<ExpressionNode> condition = parse_expression();
+		ExpressionNode* condition = parse_expression();
 		consume(SEMICOLON, "Expected ';'");
 
-		ptr<ExpressionNode> post_loop = parse_expression();
+		ExpressionNode* post_loop = parse_expression();
 
 		consume(ARROW, "Expected '->'");
 
-		ptr<StatementNode> for_body = parse_statement();
+		m_statement_stack.push_back({ m_arena->make<ForStatementNode>(init, condition, post_loop, nullptr), NodeType::FOR_STATEMENT });
+	}
 
-		return std::make_shared<ForStatementNode>(init, condition, post_loop, for_body);
+	ExpressionNode* Parser::parse_expression(uint8_t minimum_power) {
+		// Operators and calls whose operands are still being parsed are kept on an explicit stack instead of the call stack,
+		// so the nesting depth is only limited by memory
+		size_t base = m_expression_stack.size();
+		ExpressionNode* expression = nullptr;
+		while (true) {
+			// Descend through prefix operators, groups and calls until an operand without nested expressions is parsed
+			if (!parse_prefix(expression, minimum_power))
+				continue;
+
+			// Hand it to the enclosing expressions, until one of them needs another operand
+			if (complete_expression(expression, minimum_power, base))
+				return expression;
+		}
 	}
 
-	ptr<ExpressionNode> Parser::parse_expression(uint8_t mininum_precedence) {
-		// Parse expression as left side of a binary operation, even if it won't be one
-		ptr<ExpressionNode> left_expression = parse_factor();
-		Token operator_token;
-		while (is_binary_operator(current_token()) && get_precedence(current_token().type) >= mininum_precedence) {
-			operator_token = current_token();
-			advance();
-			if (operator_token.type == EQUAL) {
-				ptr<ExpressionNode> right_expression = parse_expression(get_precedence(operator_token.type));
-				left_expression = std::make_shared<AssignmentNode>(left_expression, right_expression, operator_token);
+	bool Parser::complete_expression(ExpressionNode*& expression, uint8_t& minimum_power, size_t base) {
+		while (true) {
+			// Unary operators only apply to the operand right after them
+			while (m_expression_stack.size() > base && m_expression_stack.back().kind == ExpressionFrame::UNARY) {
+				expression = m_arena->make<UnaryOperationNode>(m_expression_stack.back().token, expression);
+				m_expression_stack.pop_back();
 			}
-			else {
-				ptr<ExpressionNode> right_expression = parse_expression(get_precedence(operator_token.type) + 1);
-				left_expression = std::make_shared<BinaryOperationNode>(operator_token, left_expression, right_expression);
+
+			// An infix operator that binds strongly enough takes the expression as its left operand
+			const BindingPower& power = binding_powers[current_token().type];
+			if (power.left >= minimum_power) {
+				m_expression_stack.push_back({ ExpressionFrame::INFIX, minimum_power, current_token(), expression });
+				advance();
+				minimum_power = power.right;
+				return false;
+			}
+
+			if (m_expression_stack.size() == base)
+				return true;
+
+			// The innermost operand is done
+			ExpressionFrame& frame = m_expression_stack.back();
+			switch (frame.kind)
+			{
+			case ExpressionFrame::INFIX:
+				if (binding_powers[frame.token.type].is_assignment)
+					expression = m_arena->make<AssignmentNode>(frame.left, expression, frame.token);
+				else
+					expression = m_arena->make<BinaryOperationNode>(frame.token, frame.left, expression);
+				break;
+			case ExpressionFrame::GROUP:
+				consume(RIGHT_PARENTHESIS, "Expected ')'");
+				break;
+			case ExpressionFrame::CALL: {
+				auto call = static_cast<FunctionCallNode*>(frame.left);
+				call->argument_list.push_back(expression);
+				if (is_current(COMMA)) {
+					advance();
+					if (!is_current(RIGHT_PARENTHESIS) && !is_current(SPECIAL_EOF))
+						return false;
+				}
+				expression = finish_call(call);
+				break;
+			}
+			case ExpressionFrame::INDEX: {
+				auto index = static_cast<IndexNode*>(frame.left);
+				index->index = expression;
+				consume(RIGHT_BRACKET, "Expected ']'");
+				expression = index;
+				break;
 			}
+			default:
+				break;
+			}
+			minimum_power = frame.minimum_power;
+			m_expression_stack.pop_back();
 		}
-		return left_expression;
 	}
 
-	ptr<ExpressionNode> Parser::parse_factor() {
-		Token token = current_token();
+	bool Parser::parse_prefix(ExpressionNode*& expression, uint8_t& minimum_power) {
+		const Token& token = current_token();
 		switch (token.type) {
 		case TYPE_I32:
-			// Make Integer Literal from current token value
+		case TYPE_I64: {
+			// Make Integer Literal from the value the Lexer converted
+			int64_t integer = token.integer;
 			advance();
-			return std::make_shared<IntegerLiteralNode>(stoi(token.value));
+			expression = m_arena->make<IntegerLiteralNode>(integer);
+			return true;
+		}
+		case TYPE_F32:
+		case TYPE_F64: {
+			double floating = token.floating;
+			ReturnType type = token.type == TYPE_F32 ? ReturnType::F32 : ReturnType::F64;
+			advance();
+			expression = m_arena->make<FloatLiteralNode>(floating, type);
+			return true;
+		}
+		case TRUE:
+		case FALSE: {
+			bool value = token.type == TRUE;
+			advance();
+			expression = m_arena->make<BoolLiteralNode>(value);
+			return true;
+		}
 
-		// All these Tokens when in parse_factor make up unary operations
+		// All these Tokens when in parse_prefix make up unary operations
 		case MINUS:
 		case PLUS:
 		case TILDE:
 		case BANG:
+			m_expression_stack.push_back({ ExpressionFrame::UNARY, minimum_power, token });
 			advance();
-			return std::make_shared<UnaryOperationNode>(token, parse_factor());
-		case LEFT_PARENTHESIS: {
+			return false;
+		case LEFT_PARENTHESIS:
+			m_expression_stack.push_back({ ExpressionFrame::GROUP, minimum_power, token });
 			advance();
-			ptr<ExpressionNode> expression = parse_expression();
-			consume(RIGHT_PARENTHESIS, "Expected ')'");
-			return expression;
-		}
+			minimum_power = MINIMUM_POWER;
+			return false;
 		case IDENTIFIER: {
+			Token identifier = token;
 			advance();
 			
 			if (match(LEFT_PARENTHESIS)) {
-				ArgList argument_list;
-				while (!is_current(RIGHT_PARENTHESIS) && !is_current(SPECIAL_EOF)) {
-					argument_list.push_back(parse_expression());
-
-					if (is_current(COMMA))
-						advance();
-					else
-						break;
+				FunctionCallNode* call = m_arena->make<FunctionCallNode>(identifier, ArgList{ m_arena->resource() });
+				call->identifier = get_text(identifier);
+				if (is_current(RIGHT_PARENTHESIS) || is_current(SPECIAL_EOF)) {
+					expression = finish_call(call);
+					return true;
 				}
 
-				if (!consume(RIGHT_PARENTHESIS, "Expected ')'")) return nullptr;
-
-
-				return std::make_shared<FunctionCallNode>(token, argument_list);
+				// Arguments are parsed as operands of the call
+				m_expression_stack.push_back({ ExpressionFrame::CALL, minimum_power, identifier, call });
+				minimum_power = MINIMUM_POWER;
+				return false;
+			}
+			AccessNode* access = m_arena->make<AccessNode>(identifier);
+			access->identifier = get_text(identifier);
+			if (is_current(LEFT_BRACKET)) {
+				// The index is parsed as the operand of the element access
+				m_expression_stack.push_back({ ExpressionFrame::INDEX, minimum_power, current_token(), m_arena->make<IndexNode>(access, current_token()) });
+				advance();
+				minimum_power = MINIMUM_POWER;
+				return false;
 			}
-			return std::make_shared<AccessNode>(token);
+			expression = access;
+			return true;
 		}
 		default:
 			report_error("Expected Expression");
-			return nullptr;
+			expression = nullptr;
+			return true;
 		}
-		
 	}
-}
\ No newline at end of file
+
+	ExpressionNode* Parser::finish_call(FunctionCallNode* call) {
+		if (!consume(RIGHT_PARENTHESIS, "Expected ')'")) return nullptr;
+		return call;
+	}
+}
@@ -4,27 +4,48 @@
 
 #pragma once
 #include "Utilities/Error.h"
+#include "Utilities/SourceManager.h"
 #include "ASTNodes.h"
-#include "Lexer/Token.h"
+#include "ASTArena.h"
+#include "Lexer/Lexer.h"
+#include <array>
 
 namespace Anthem {
 	class Parser {
 	public:
-		Parser(ErrorHandler* handler);
+		// Nodes are allocated in <arena>, which has to outlive the returned AST
+		Parser(ErrorHandler* handler, SourceManager* source_manager, ASTArena* arena);
 
-		ptr<ProgramNode> parse(const TokenList& tokens);
-		static void pretty_print(ptr<ASTNode> node, const std::string& padding = "");
+		// Parse a whole file, pulling Tokens from the Lexer only as they are needed
+		ProgramNode* parse(Lexer& lexer, FileID file_id);
+
+		// Parse Tokens that were already lexed (e.g. in parallel), the list must end with an End of File Token
+		ProgramNode* parse(const TokenList& tokens);
+
+		// Parse Tokens that were already lexed, splitting the top level declarations between the threads of <thread_pool>.
+		// The declarations are merged in source order, the AST and errors are the same as the ones of parse
+		ProgramNode* parse_parallel(const TokenList& tokens, ThreadPool& thread_pool);
+		static void pretty_print(ASTNode* root, const std::string& root_padding = "");
 	private:
 		// Utility
 
-		// Advance to next token if it exists
+		// Advance to next token, pulling it from the Lexer if it was not peeked at yet
 		void advance();
 
+		// Get the next Token from the Lexer or the Token list
+		Token pull_token();
+
+		// Reset the parsing state, pull the first Token and parse the program
+		ProgramNode* start_parsing();
+
+		// Parse the Tokens in [begin, end) of a list as a whole program, followed by the End of File Token of the list
+		ProgramNode* parse_range(const TokenList& tokens, size_t begin, size_t end);
+
 		// Get Token at current Index
 		const Token& current_token() const;
 
-		// Get Token at <depth> amount after current Index
-		const Token& peek(uint32_t depth = 1) const;
+		// Get Token at <depth> amount after current Index, <depth> must be less than LOOKAHEAD
+		const Token& peek(uint32_t depth = 1);
 
 		// Advance if current Token is of desired type, else report an Error for Unexpected Token
 		bool consume(TokenType token_type, const std::string& error_message);
@@ -35,49 +56,145 @@ namespace Anthem {
 		// Return true if current token matches the specified type
 		bool is_current(TokenType token_type) const;
 
-		// Called if an error occurs, skips Tokens in order to get to an Error-Free state
+		// Get the source text of a Token
+		std::string_view get_text(const Token& token) const;
+
+		// Called if an error occurs, skips Tokens up to the end of the statement or the start of another one
 		void stabilize();
 
+		// Return true if the current Token starts a top level declaration
+		bool is_declaration_start() const;
+
 		// Error Handling
+
+		// Report an error, unless the Parser is in panic mode after a previous error, and stabilize
 		void report_error(const std::string& error_message);
+
+		// End the Token stream early, once the error limit is reached
+		void stop_parsing();
+
+		// Parallel Parsing
+
+		// Find the first Token of every top level declaration by matching braces, followed by the index of the End of File Token.
+		// The names of functions and parameters are interned on the way, in the order the serial Parser would intern them.
+		// Returns false if the declarations can not be told apart (unbalanced braces or a Lexer error)
+		bool find_declarations(const TokenList& tokens, std::vector<uint32_t>& declaration_starts);
 	private:
 		// Program Parsing
 		
-		ptr<ProgramNode> parse_program();
-
-		// Miscellaneous
-
-		BlockItem parse_block_item();
+		ProgramNode* parse_program();
 
 		// Declaration Parsing
 
-		ptr<DeclarationNode> parse_declaration();
-		ptr<DeclarationNode> parse_function_declaration(VarFlag flag = VarFlag::Global);
-		ptr<DeclarationNode> parse_variable_declaration(VarFlag flag = VarFlag::Local);
-		ptr<DeclarationNode> parse_external();
+		DeclarationNode* parse_declaration();
+		DeclarationNode* parse_function_declaration(VarFlag flag = VarFlag::Global, bool is_const = false);
+		DeclarationNode* parse_variable_declaration(VarFlag flag = VarFlag::Local);
+		DeclarationNode* parse_external();
 
 		// Statement Parsing
 
-		ptr<StatementNode> parse_statement();
-		ptr<ReturnStatementNode> parse_return_statement();
-		ptr<BlockStatementNode> parse_block_statement();
-		ptr<ExprStatementNode> parse_expr_statement();
-		ptr<IfStatementNode> parse_if_statement();
-		ptr<WhileStatementNode> parse_while_statement();
-		ptr<LoopStatementNode> parse_loop_statement();
-		ptr<ForStatementNode> parse_for_statement();
+		StatementNode* parse_statement();
+
+		// Parse a statement without nested statements and return true, or parse the start of one with nested statements
+		// and push it to the statement stack
+		bool begin_statement(StatementNode*& statement);
+
+		// Give a finished nested <statement> to the innermost statement on the stack. Returns true and replaces <statement>
+		// with that statement if it is finished too, or false if it needs another nested statement
+		bool complete_statement(StatementNode*& statement);
+
+		// Parse the declarations of the innermost block until a nested statement starts, or finish the block (like complete_statement)
+		bool continue_block(StatementNode*& statement);
+
+		ReturnStatementNode* parse_return_statement();
+		ExprStatementNode* parse_expr_statement();
+
+		// Break and continue
+		template<typename T>
+		T* parse_jump_statement();
+
+		// Parse the part of the statement before its nested statements and push it to the statement stack
+		void parse_block_statement();
+		void parse_if_statement();
+		void parse_while_statement();
+		void parse_loop_statement();
+		void parse_for_statement();
 		
 		// Expression Parsing
 
-		ptr<ExpressionNode> parse_expression(uint8_t mininum_precedence = 0);
-		ptr<ExpressionNode> parse_factor();
+		// Pratt parser, binding powers of the infix operators come from a table indexed by TokenType
+		ExpressionNode* parse_expression(uint8_t minimum_power = MINIMUM_POWER);
+
+		// Parse a literal or variable access and return true, or parse a unary operator, '(', the start of a call or of an element access
+		// and push it to the expression stack, then the next operand is parsed with <minimum_power>
+		bool parse_prefix(ExpressionNode*& expression, uint8_t& minimum_power);
+
+		// Give a finished operand to the expressions on the stack above <base>, applying infix operators as they come.
+		// Returns true once the whole expression is finished, or false if another operand needs to be parsed
+		bool complete_expression(ExpressionNode*& expression, uint8_t& minimum_power, size_t base);
+
+		// Consume the ')' of a call, returns nullptr if it is missing
+		ExpressionNode* finish_call(FunctionCallNode* call);
 	private:
-		int m_current_token_index{ 0 };
-		ErrorHandler* m_error_handler{ nullptr };
-		Token* m_current_token{ nullptr };
+		// Size of the lookahead ring buffer, the current Token plus the deepest peek the Parser needs (with room to spare)
+		static constexpr uint32_t LOOKAHEAD = 4;
+
+		// Lowest binding power of an expression, every infix operator binds at least this strongly
+		static constexpr uint8_t MINIMUM_POWER = 1;
 
-		bool m_error_occured{ false };
+		// Files with fewer Tokens than this per chunk are parsed serially
+		static constexpr size_t MIN_CHUNK_TOKENS = 16 * 1024;
 
-		TokenList m_tokens;
+		// A statement whose nested statements are still being parsed
+		struct StatementFrame {
+			StatementNode* node{ nullptr };
+			NodeType type{ NodeType::STATEMENT };
+
+			// Set once the body of an if statement is done and its else body is parsed
+			bool in_else_body{ false };
+		};
+
+		// An operator, group or call whose operand is still being parsed
+		struct ExpressionFrame {
+			enum Kind : uint8_t { INFIX, UNARY, GROUP, CALL, INDEX };
+
+			Kind kind;
+
+			// Minimum binding power of the enclosing expression, restored once the frame is done
+			uint8_t minimum_power;
+
+			// Operator Token, the identifier of a call or the '[' of an element access
+			Token token;
+
+			// Left operand of an infix operator, the FunctionCallNode of a call or the IndexNode of an element access
+			ExpressionNode* left{ nullptr };
+		};
+
+		ErrorHandler* m_error_handler{ nullptr };
+		SourceManager* m_source_manager{ nullptr };
+		ASTArena* m_arena{ nullptr };
+		// Tokens come from exactly one of these
+		Lexer* m_lexer{ nullptr };
+		const TokenList* m_token_list{ nullptr };
+		size_t m_token_list_index{ 0 };
+		size_t m_token_list_end{ 0 };
+
+		// Set from an error until the start of the next statement or declaration, where the Parser is synchronized again
+		bool m_panic_mode{ false };
+		bool m_lexer_failed{ false };
+
+		// Set once the error limit is reached, from then on only <m_end_token> is returned
+		bool m_stopped{ false };
+		Token m_end_token{};
+
+		// Ring buffer holding the current Token at <m_lookahead_start> followed by the Tokens already peeked at,
+		// so only a few Tokens are alive at any time instead of the whole file
+		std::array<Token, LOOKAHEAD> m_lookahead{};
+		uint32_t m_lookahead_start{ 0 };
+		uint32_t m_lookahead_count{ 0 };
+
+		// Explicit stacks replacing recursion for nested statements and expressions, kept to reuse their memory
+		std::vector<StatementFrame> m_statement_stack;
+		std::vector<ExpressionFrame> m_expression_stack;
 	};
 }
\ No newline at end of file
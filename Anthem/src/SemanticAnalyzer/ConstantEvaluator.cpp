@@ -0,0 +1,269 @@
+// ConstantEvaluator.cpp
+// Contains the ConstantEvaluator Class method implementations
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#include "ConstantEvaluator.h"
+
+namespace Anthem {
+	// Truncate a floating point value to an integer the way the generated code does, values out of range give the
+	// smallest value of the width the conversion is done in (i32 for narrower types)
+	static int64_t truncate_floating(double value, ReturnType type) {
+		if (type == ReturnType::I64)
+			return (value >= -0x1p63 && value < 0x1p63) ? int64_t(value) : INT64_MIN;
+		return (value > -0x1p31 - 1 && value < 0x1p31) ? int64_t(value) : INT32_MIN;
+	}
+
+	Constant convert_constant(const Constant& value, ReturnType type) {
+		if (value.type == type)
+			return value;
+
+		Constant result{ type };
+		if (is_floating(value.type)) {
+			if (type == ReturnType::F32)
+				result.floating = float(value.floating);
+			else if (type == ReturnType::F64)
+				result.floating = value.floating;
+			else if (type == ReturnType::BOOL)
+				result.integer = value.floating != 0.0;
+			else
+				result.integer = wrap_integer(truncate_floating(value.floating, type), type);
+		}
+		// Integers are rounded to f32 directly, like the conversion instruction does
+		else if (type == ReturnType::F32)
+			result.floating = float(value.integer);
+		else if (type == ReturnType::F64)
+			result.floating = double(value.integer);
+		else
+			result.integer = wrap_integer(value.integer, type);
+		return result;
+	}
+
+	std::optional<Constant> fold_binary(BinaryOperation operation, const Constant& a, const Constant& b, ReturnType type) {
+		if (is_relational(operation)) {
+			ReturnType operand_type = common_type(a.type, b.type);
+			Constant left = convert_constant(a, operand_type);
+			Constant right = convert_constant(b, operand_type);
+
+			// Comparisons of NaN are false except '!=', which is what the C++ operators do as well
+			bool result = false;
+			if (is_floating(operand_type)) {
+				switch (operation) {
+				case BinaryOperation::GREATER:			result = left.floating > right.floating; break;
+				case BinaryOperation::LESS:				result = left.floating < right.floating; break;
+				case BinaryOperation::GREATER_EQUAL:	result = left.floating >= right.floating; break;
+				case BinaryOperation::LESS_EQUAL:		result = left.floating <= right.floating; break;
+				case BinaryOperation::EQUAL:			result = left.floating == right.floating; break;
+				default:								result = left.floating != right.floating; break;
+				}
+			}
+			else {
+				switch (operation) {
+				case BinaryOperation::GREATER:			result = left.integer > right.integer; break;
+				case BinaryOperation::LESS:				result = left.integer < right.integer; break;
+				case BinaryOperation::GREATER_EQUAL:	result = left.integer >= right.integer; break;
+				case BinaryOperation::LESS_EQUAL:		result = left.integer <= right.integer; break;
+				case BinaryOperation::EQUAL:			result = left.integer == right.integer; break;
+				default:								result = left.integer != right.integer; break;
+				}
+			}
+			return Constant{ ReturnType::BOOL, result };
+		}
+
+		Constant left = convert_constant(a, type);
+		Constant right = convert_constant(b, type);
+		Constant result{ type };
+
+		if (is_floating(type)) {
+			double x = left.floating;
+			double y = right.floating;
+			switch (operation) {
+			case BinaryOperation::ADDITION:			result.floating = x + y; break;
+			case BinaryOperation::SUBTRACTION:		result.floating = x - y; break;
+			case BinaryOperation::MULTIPLICATION:	result.floating = x * y; break;
+			case BinaryOperation::DIVISION:			result.floating = x / y; break;
+			default:								return std::nullopt;
+			}
+			// f32 operations round their result to f32, the operands are exact in both
+			if (type == ReturnType::F32)
+				result.floating = float(result.floating);
+			return result;
+		}
+
+		// Integers wrap around, so they are added and multiplied as unsigned values
+		uint64_t x = uint64_t(left.integer);
+		uint64_t y = uint64_t(right.integer);
+		switch (operation) {
+		case BinaryOperation::ADDITION:			result.integer = wrap_integer(int64_t(x + y), type); break;
+		case BinaryOperation::SUBTRACTION:		result.integer = wrap_integer(int64_t(x - y), type); break;
+		case BinaryOperation::MULTIPLICATION:	result.integer = wrap_integer(int64_t(x * y), type); break;
+		case BinaryOperation::DIVISION:
+		case BinaryOperation::REMAINDER: {
+			// i8 and i16 are divided in 32 bits, where their smallest value divided by -1 does not overflow
+			int64_t smallest = (type == ReturnType::I64) ? INT64_MIN : INT32_MIN;
+			if (right.integer == 0 || (left.integer == smallest && right.integer == -1))
+				return std::nullopt;
+			int64_t value = (operation == BinaryOperation::DIVISION) ? left.integer / right.integer : left.integer % right.integer;
+			result.integer = wrap_integer(value, type);
+			break;
+		}
+		default:
+			return std::nullopt;
+		}
+		return result;
+	}
+
+	Constant fold_unary(UnaryOperation operation, const Constant& value, ReturnType type) {
+		if (operation == UnaryOperation::NOT)
+			return Constant{ ReturnType::BOOL, !value.is_true() };
+
+		Constant result = convert_constant(value, type);
+		switch (operation) {
+		case UnaryOperation::NEGATE:
+			if (is_floating(type))
+				result.floating = -result.floating;
+			else
+				result.integer = wrap_integer(int64_t(0 - uint64_t(result.integer)), type);
+			break;
+		case UnaryOperation::COMPLEMENT:
+			result.integer = wrap_integer(~result.integer, type);
+			break;
+		default:
+			break;
+		}
+		return result;
+	}
+
+	ConstantEvaluator::ConstantEvaluator(ErrorHandler* error_handler, const SymbolTable& symbol_table, const ExpressionTypes& expression_types)
+		: m_error_handler{ error_handler }, m_symbol_table{ symbol_table }, m_expression_types{ expression_types } {}
+
+	std::optional<Constant> ConstantEvaluator::evaluate(ExpressionNode* expression, std::string_view non_constant_error) {
+		m_frames.clear();
+		m_values.clear();
+		m_failed = false;
+		m_non_constant_error = non_constant_error;
+		m_calls_functions = false;
+
+		m_frames.push_back({ expression });
+		while (!m_frames.empty() && !m_failed) {
+			ExpressionNode* operand = continue_evaluation(m_frames.back());
+			if (operand)
+				m_frames.push_back({ operand });
+			else
+				m_frames.pop_back();
+		}
+		if (m_failed)
+			return std::nullopt;
+		if (std::optional<Constant> value = pop_value())
+			return value;
+		return convert_constant({ ReturnType::I32 }, type_of(expression));
+	}
+
+	std::optional<Constant> ConstantEvaluator::pop_value() {
+		std::optional<Constant> value = m_values.back();
+		m_values.pop_back();
+		return value;
+	}
+
+	ExpressionNode* ConstantEvaluator::continue_evaluation(EvaluationFrame& frame) {
+		ExpressionNode* expression = frame.node;
+		switch (expression->get_type()) {
+		case NodeType::INT_LITERAL:
+			m_values.push_back(convert_constant({ ReturnType::I64, static_cast<IntegerLiteralNode*>(expression)->integer }, type_of(expression)));
+			return nullptr;
+		case NodeType::FLOAT_LITERAL:
+			m_values.push_back(Constant{ type_of(expression), 0, static_cast<FloatLiteralNode*>(expression)->floating });
+			return nullptr;
+		case NodeType::BOOL_LITERAL:
+			m_values.push_back(Constant{ ReturnType::BOOL, static_cast<BoolLiteralNode*>(expression)->value });
+			return nullptr;
+		case NodeType::UNARY_OPERATION: {
+			UnaryOperationNode* unary = static_cast<UnaryOperationNode*>(expression);
+			if (frame.stage++ == 0)
+				return unary->expression;
+
+			UnaryOperation operation = UnaryOperation::NONE;
+			switch (unary->operator_token.type) {
+			case MINUS: operation = UnaryOperation::NEGATE; break;
+			case TILDE: operation = UnaryOperation::COMPLEMENT; break;
+			case BANG: operation = UnaryOperation::NOT; break;
+			default: break;
+			}
+			std::optional<Constant> value = pop_value();
+			m_values.push_back(value ? std::optional{ fold_unary(operation, *value, type_of(unary)) } : std::nullopt);
+			return nullptr;
+		}
+		case NodeType::BINARY_OPERATION: {
+			BinaryOperationNode* binary = static_cast<BinaryOperationNode*>(expression);
+			BinaryOperation operation = token_to_bin_op(binary->operator_token);
+			bool logical = operation == BinaryOperation::AND || operation == BinaryOperation::OR;
+			switch (frame.stage++) {
+			case 0: return binary->left_expression;
+			case 1:
+				// Logical operations short-circuit, the right operand is not evaluated if the left one decides the result
+				if (logical && m_values.back()) {
+					bool left = pop_value()->is_true();
+					if (left == (operation == BinaryOperation::OR)) {
+						m_values.push_back(Constant{ ReturnType::BOOL, left });
+						return nullptr;
+					}
+					m_values.push_back(Constant{ ReturnType::BOOL, left });
+				}
+				return binary->right_expression;
+			default:
+				break;
+			}
+
+			std::optional<Constant> right = pop_value();
+			std::optional<Constant> left = pop_value();
+			if (!left || !right) {
+				m_values.push_back(std::nullopt);
+				return nullptr;
+			}
+			if (logical) {
+				m_values.push_back(Constant{ ReturnType::BOOL, right->is_true() });
+				return nullptr;
+			}
+
+			std::optional<Constant> result = fold_binary(operation, *left, *right, type_of(binary));
+			if (!result) {
+				m_error_handler->report_error(Error{ "Division by zero or overflow in constant expression", binary->operator_token.position() });
+				m_failed = true;
+				return nullptr;
+			}
+			m_values.push_back(result);
+			return nullptr;
+		}
+		case NodeType::FUNCTION_CALL: {
+			FunctionCallNode* call = static_cast<FunctionCallNode*>(expression);
+			if (frame.stage < call->argument_list.size())
+				return call->argument_list[frame.stage++];
+
+			auto symbol = m_symbol_table.find(call->name);
+			if (symbol == m_symbol_table.end() || !std::holds_alternative<FunctionType>(symbol->second) || !std::get<FunctionType>(symbol->second).is_const) {
+				m_error_handler->report_error(Error{ std::format("Only constant functions can be called in a constant expression, '{0}' is not one", call->name.view()), call->variable_token.position() });
+				m_failed = true;
+				return nullptr;
+			}
+
+			// The arguments only had to be constant, the call is evaluated once the function is generated
+			m_values.resize(m_values.size() - call->argument_list.size());
+			m_values.push_back(std::nullopt);
+			m_calls_functions = true;
+			return nullptr;
+		}
+		default: {
+			// Variables, array elements and assignments are only known at runtime
+			Position position;
+			if (expression->get_type() == NodeType::NAME_ACCESS)
+				position = static_cast<AccessNode*>(expression)->variable_token.position();
+			else if (expression->get_type() == NodeType::INDEX)
+				position = static_cast<IndexNode*>(expression)->array->variable_token.position();
+			else if (expression->get_type() == NodeType::ASSIGNMENT)
+				position = static_cast<AssignmentNode*>(expression)->token.position();
+			m_error_handler->report_error(Error{ std::string(m_non_constant_error), position });
+			m_failed = true;
+			return nullptr;
+		}
+		}
+	}
+}
@@ -0,0 +1,77 @@
+// ConstantEvaluator.h
+// Contains the ConstantEvaluator Class definition
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#pragma once
+#include <optional>
+#include "Utilities/Utilities.h"
+#include "Utilities/Error.h"
+#include "Parser/ASTNodes.h"
+
+namespace Anthem {
+	// A value known at compile time, integers and bools are kept in <integer> and floating point values in <floating>
+	struct Constant {
+		ReturnType type{ ReturnType::I32 };
+		int64_t integer{ 0 };
+		double floating{ 0.0 };
+
+		// Bit pattern the value is stored as
+		int64_t bits() const { return is_floating(type) ? floating_bits(floating, type) : integer; }
+		bool is_true() const { return is_floating(type) ? floating != 0.0 : integer != 0; }
+	};
+
+	// -- Folding, with the same results as the generated code --
+
+	Constant convert_constant(const Constant& value, ReturnType type);
+
+	// Result of an arithmetic or relational operation, the operands are converted to the type the operation is done in.
+	// There is no result if the operation traps at runtime (division by zero or of the smallest value by -1)
+	std::optional<Constant> fold_binary(BinaryOperation operation, const Constant& a, const Constant& b, ReturnType type);
+	Constant fold_unary(UnaryOperation operation, const Constant& value, ReturnType type);
+
+	/*
+	*  Evaluates expressions made of literals and operators at compile time, e.g. the initializers of global variables.
+	*  The expressions must have been typed by the TypeChecker, and are walked with an explicit stack like every other pass.
+	*  Calls to constant functions are allowed, but their value is only known once the functions are generated to AIR
+	*/
+	class ConstantEvaluator {
+	public:
+		ConstantEvaluator(ErrorHandler* error_handler, const SymbolTable& symbol_table, const ExpressionTypes& expression_types);
+
+		// Value of <expression> as its own type, reports an error and returns nothing if it is not constant.
+		// <non_constant_error> is reported if it reads or assigns a variable.
+		// If the expression calls constant functions the value is only a zero of its type, see calls_functions()
+		std::optional<Constant> evaluate(ExpressionNode* expression, std::string_view non_constant_error);
+
+		// Whether the last evaluated expression calls constant functions
+		bool calls_functions() const { return m_calls_functions; }
+	private:
+		// An expression whose operands are still being evaluated
+		struct EvaluationFrame {
+			ExpressionNode* node{ nullptr };
+
+			// Number of operands evaluated so far
+			uint32_t stage{ 0 };
+		};
+
+		// Evaluate the next part of an expression, returns the operand to evaluate before the expression is continued
+		// or nullptr once its value was pushed to the value stack
+		ExpressionNode* continue_evaluation(EvaluationFrame& frame);
+
+		// Values of operands, nothing if the operand calls a function
+		std::optional<Constant> pop_value();
+		ReturnType type_of(ExpressionNode* expression) const { return m_expression_types[expression->expression_id]; }
+	private:
+		ErrorHandler* m_error_handler;
+		const SymbolTable& m_symbol_table;
+		const ExpressionTypes& m_expression_types;
+
+		std::vector<EvaluationFrame> m_frames;
+		std::vector<std::optional<Constant>> m_values;
+
+		// Set once an expression turns out not to be constant, which stops the evaluation
+		bool m_failed{ false };
+		std::string_view m_non_constant_error;
+		bool m_calls_functions{ false };
+	};
+}
@@ -0,0 +1,73 @@
+// ScopedTable.h
+// Contains the ScopedTable Class definition
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include <optional>
+
+namespace Anthem {
+	/*
+	*  Hash map of the names visible in nested scopes. Every binding is made in a single map and recorded in an undo log,
+	*  leaving a scope undoes the bindings made inside it. Pushing a scope is O(1), popping one is linear in the number
+	*  of bindings made inside it and lookups see the bindings of every enclosing scope in O(1).
+	*/
+	template<typename Key, typename Value>
+	class ScopedTable {
+	public:
+		void push_scope() { m_scope_starts.push_back(m_undo_log.size()); }
+
+		// Undo the bindings of the innermost scope, restoring the ones they replaced
+		void pop_scope() {
+			size_t scope_start = m_scope_starts.back();
+			m_scope_starts.pop_back();
+			while (m_undo_log.size() > scope_start) {
+				UndoEntry& entry = m_undo_log.back();
+				if (entry.previous)
+					m_bindings[entry.key] = std::move(*entry.previous);
+				else
+					m_bindings.erase(entry.key);
+				m_undo_log.pop_back();
+			}
+		}
+
+		// Bind <key> in the innermost scope, replacing its binding from an enclosing scope until this scope is popped
+		void bind(const Key& key, const Value& value) {
+			auto [binding, inserted] = m_bindings.try_emplace(key, value);
+			if (inserted)
+				m_undo_log.push_back({ key, std::nullopt });
+			else {
+				m_undo_log.push_back({ key, std::move(binding->second) });
+				binding->second = value;
+			}
+		}
+
+		// Binding of <key> in the innermost scope that has one, or nullptr
+		const Value* find(const Key& key) const {
+			auto binding = m_bindings.find(key);
+			return binding == m_bindings.end() ? nullptr : &binding->second;
+		}
+
+		bool contains(const Key& key) const { return m_bindings.find(key) != m_bindings.end(); }
+
+		void clear() {
+			m_bindings.clear();
+			m_undo_log.clear();
+			m_scope_starts.clear();
+		}
+	private:
+		struct UndoEntry {
+			Key key;
+
+			// Binding replaced by the entry, empty if the key was not bound before
+			std::optional<Value> previous;
+		};
+
+		std::unordered_map<Key, Value> m_bindings;
+		std::vector<UndoEntry> m_undo_log;
+
+		// Size of the undo log when each open scope was pushed
+		std::vector<size_t> m_scope_starts;
+	};
+}
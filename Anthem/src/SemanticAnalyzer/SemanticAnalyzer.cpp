@@ -7,24 +7,75 @@
 namespace Anthem {
 	SemanticAnalyzer::SemanticAnalyzer(ErrorHandler* error_handler) : m_error_handler{ error_handler } {}
 
-	void SemanticAnalyzer::analyze_resolve(ptr<ProgramNode> program_node) {
-		m_local_map_stack.push_back({});
-		m_global_map.clear();
+	void SemanticAnalyzer::analyze_resolve(ProgramNode* program_node, TypeChecker& type_checker) {
+		m_type_checker = &type_checker;
+		m_check_types = false;
+		resolve_program(program_node);
+		m_type_checker = nullptr;
+	}
 
-		// First pass to find all global declarations and handle duplicates
-		for (auto& decl : program_node->declarations) {
+	void SemanticAnalyzer::analyze(ProgramNode* program_node, TypeChecker& type_checker) {
+		m_type_checker = &type_checker;
+		m_check_types = true;
+		m_type_checker->get_expression_types().clear();
+		resolve_program(program_node);
+		m_type_checker = nullptr;
+	}
+
+	void SemanticAnalyzer::resolve_program(ProgramNode* program_node) {
+		m_names.clear();
+		m_type_checker->get_symbols().clear();
+
+		// First pass to find all functions and handle duplicates, this only goes over the top level
+		for (auto& decl : program_node->declarations)
 			save_declaration(decl);
-		}
 		if (m_error_handler->has_errors())
 			return;
 
 		for (auto& decl : program_node->declarations) {
-			analyze_declaration(decl);
+			if (m_check_types)
+				m_type_checker->enter_declaration(decl);
+			schedule(AnalysisItem::DECLARATION, decl);
+			analyze_scheduled();
 		}
 	}
 
-	SemanticAnalyzer::VarMap& SemanticAnalyzer::current_map() {
-		return m_local_map_stack[m_local_map_stack.size() - 1];
+	void SemanticAnalyzer::schedule(AnalysisItem::Kind kind, ASTNode* node) {
+		m_work_stack.push_back({ kind, node });
+	}
+
+	void SemanticAnalyzer::analyze_scheduled() {
+		// Nodes schedule their children instead of recursing into them, so the nesting depth is only limited by memory.
+		// Children are scheduled in reverse, to be analyzed in source order
+		while (!m_work_stack.empty()) {
+			AnalysisItem item = m_work_stack.back();
+			m_work_stack.pop_back();
+			switch (item.kind)
+			{
+			case AnalysisItem::DECLARATION:
+				analyze_declaration(static_cast<DeclarationNode*>(item.node));
+				break;
+			case AnalysisItem::STATEMENT:
+				analyze_statement(static_cast<StatementNode*>(item.node));
+				break;
+			case AnalysisItem::EXPRESSION:
+				analyze_expression(static_cast<ExpressionNode*>(item.node));
+				break;
+			case AnalysisItem::BIND_VARIABLE:
+				bind_variable(static_cast<VariableNode*>(item.node));
+				break;
+			case AnalysisItem::TYPE_EXPRESSION:
+				m_type_checker->type_expression(static_cast<ExpressionNode*>(item.node));
+				break;
+			case AnalysisItem::POP_SCOPE:
+				m_names.pop_scope();
+				break;
+			case AnalysisItem::POP_LOOP:
+				// Set current loop to the outer loop (if there is one)
+				m_loop_stack.pop_back();
+				break;
+			}
+		}
 	}
 
 	uint64_t SemanticAnalyzer::new_loop() {
@@ -36,178 +87,165 @@ namespace Anthem {
 		return m_loop_stack[m_loop_stack.size() - 1];
 	}
 
-	void SemanticAnalyzer::save_declaration(ptr<DeclarationNode> declaration_node) {
-		switch (declaration_node->get_type())
-		{
-		case NodeType::VARIABLE: {
-			break;
+	void SemanticAnalyzer::save_declaration(DeclarationNode* declaration_node) {
+		// Check if function is already defined
+		if (declaration_node->get_type() == NodeType::FUNCTION_DECLARATION) {
+			FunctionDeclarationNode* function = static_cast<FunctionDeclarationNode*>(declaration_node);
+			if (m_type_checker->get_symbols().contains(function->name))
+				report_error("Function '" + function->name.str() + "' is already defined", {});
 		}
-		case NodeType::FUNCTION_DECLARATION: {
-			ptr<FunctionDeclarationNode> function = std::static_pointer_cast<FunctionDeclarationNode>(declaration_node);
-
-			// Check if function is already defined
-			if (m_global_map.find(function->name) != m_global_map.end())
-				report_error("Function '" + function->name + "' is already defined", {});
 
-			m_global_map[function->name] = function->name;
-			break;
-		}
-		default:
-			break;
-		}
+		// Functions and external functions are added to the symbol table with their types
+		m_type_checker->track_function(declaration_node);
 	}
 
-	void SemanticAnalyzer::analyze_declaration(ptr<DeclarationNode> declaration_node) {
+	void SemanticAnalyzer::analyze_declaration(DeclarationNode* declaration_node) {
 		switch (declaration_node->get_type())
 		{
 		case NodeType::VARIABLE: {
-			ptr<VariableNode> variable = std::static_pointer_cast<VariableNode>(declaration_node);
-			Name variable_name = variable->variable_token.value;
+			VariableNode* variable = static_cast<VariableNode*>(declaration_node);
+			Name variable_name = variable->identifier;
 
 			// Check if variable already exists in locally or globally
-			if (current_map().find(variable_name) != current_map().end()
-				|| m_global_map.find(variable_name) != m_global_map.end())
-				report_error("Variable '" + variable_name + "' is already defined", variable->variable_token);
+			if (m_names.contains(variable_name) || m_type_checker->get_symbols().contains(variable_name))
+				report_error("Variable '" + variable_name.str() + "' is already defined", variable->variable_token);
 
+			// The variable is only added to the map after its initializer is analyzed
+			schedule(AnalysisItem::BIND_VARIABLE, variable);
 			if (variable->expression)
-				analyze_expression(variable->expression);
-
-			if (variable->flag == VarFlag::Local) {
-				// Add variable to the current local variable map
-				Name new_var_name = make_unique(variable_name);
-				current_map()[variable_name] = new_var_name;
-				variable->variable_token.value = new_var_name;
-			}
-			// All other VarFlags are handled the same, as globals, except for internal which allows renaming
-			else {
-				// Add variable to the global variable map
-				Name new_var_name = variable->variable_token.value;
-				if(variable->flag == VarFlag::Internal)
-					new_var_name = make_unique(variable_name);
-				m_global_map[variable_name] = new_var_name;
-				variable->variable_token.value = new_var_name;
-			}
+				schedule(AnalysisItem::EXPRESSION, variable->expression);
+			if (variable->length_expression)
+				schedule(AnalysisItem::EXPRESSION, variable->length_expression);
 			break;
 		}
 							   
 		case NodeType::FUNCTION_DECLARATION: {
-			ptr<FunctionDeclarationNode> function = std::static_pointer_cast<FunctionDeclarationNode>(declaration_node);
-
-			m_global_map[function->name] = function->name;
+			FunctionDeclarationNode* function = static_cast<FunctionDeclarationNode*>(declaration_node);
 
 			if(function->parameters.empty())
-				analyze_statement(function->body);
+				schedule(AnalysisItem::STATEMENT, function->body);
 			else {
 				// If there are parameters push new scope
-				m_local_map_stack.push_back(current_map());
+				m_names.push_scope();
 				for (auto& param : function->parameters) {
-					// Check if parameter name already exists
-					if (current_map().find(param.name) != current_map().end())
-						report_error("Variable '" + param.name + "' is already defined", {});
+					// Check if parameter name already exists, internal variables can be shadowed by parameters
+					if (const Binding* binding = m_names.find(param.name); binding && binding->id.valid())
+						report_error("Variable '" + param.name.str() + "' is already defined", {});
 
 					// Add parameter to the local variable map
-					Name new_param_name = make_unique(param.name);
-					current_map()[param.name] = new_param_name;
-					param.name = new_param_name;
+					param.id = new_variable();
+					m_names.bind(param.name, { param.id, param.name });
 				}
-				analyze_statement(function->body);
-				m_local_map_stack.pop_back();
+				if (m_check_types)
+					m_type_checker->check_function(function);
+				schedule(AnalysisItem::POP_SCOPE);
+				schedule(AnalysisItem::STATEMENT, function->body);
 			}
 			break;
 		}
-		case NodeType::EXTERNAL_DECLARATION: {
-			ptr<ExternalFunctionNode> external = std::static_pointer_cast<ExternalFunctionNode>(declaration_node);
-
-			m_global_map[external->name] = external->name;
-			break;
-		}
 		default:
 			break;
 		}
 	}
 
-	void SemanticAnalyzer::analyze_statement(ptr<StatementNode> statement) {
+	void SemanticAnalyzer::bind_variable(VariableNode* variable) {
+		Name variable_name = variable->identifier;
+		variable->name = variable_name;
+		if (variable->flag == VarFlag::Local) {
+			// Add variable to the current scope
+			variable->id = new_variable();
+			m_names.bind(variable_name, { variable->id, variable_name });
+		}
+		// All other VarFlags are handled the same, as globals, except for internal which allows renaming.
+		// Internal variables are only declared at the top level, so their bindings are never popped
+		else if (variable->flag == VarFlag::Internal) {
+			variable->name = make_unique(variable_name);
+			m_names.bind(variable_name, { VarId{}, variable->name });
+		}
+
+		// Global variables are added to the symbol table under their unique Name, the type check adds what it finds out about them
+		if (m_check_types)
+			m_type_checker->check_variable(variable);
+		else if (variable->flag != VarFlag::Local)
+			m_type_checker->get_symbols()[variable->name] = VariableType{ variable->type, variable->flag, 0, false, 0 };
+	}
+
+	void SemanticAnalyzer::analyze_statement(StatementNode* statement) {
 		switch (statement->get_type())
 		{
 		case NodeType::BLOCK_STATEMENT: {
-			ptr<BlockStatementNode> block_statement = std::static_pointer_cast<BlockStatementNode>(statement);
-			m_local_map_stack.push_back(current_map());
-			for (auto& block : block_statement->items) {
-				if (std::holds_alternative<ptr<StatementNode>>(block))
-					analyze_statement(std::get<ptr<StatementNode>>(block));
+			BlockStatementNode* block_statement = static_cast<BlockStatementNode*>(statement);
+			m_names.push_scope();
+			schedule(AnalysisItem::POP_SCOPE);
+			for (auto block = block_statement->items.rbegin(); block != block_statement->items.rend(); ++block) {
+				if (std::holds_alternative<StatementNode*>(*block))
+					schedule(AnalysisItem::STATEMENT, std::get<StatementNode*>(*block));
 				else
-					analyze_declaration(std::get<ptr<DeclarationNode>>(block));
+					schedule(AnalysisItem::DECLARATION, std::get<DeclarationNode*>(*block));
 			}
-			m_local_map_stack.pop_back();
 			break;
 		}
 		case NodeType::EXPR_STATEMENT: {
-			ptr<ExprStatementNode> expr_statement = std::static_pointer_cast<ExprStatementNode>(statement);
-			analyze_expression(expr_statement->expression);
+			ExprStatementNode* expr_statement = static_cast<ExprStatementNode*>(statement);
+			schedule(AnalysisItem::EXPRESSION, expr_statement->expression);
 			break;
 		}
 		case NodeType::RETURN_STATEMENT: {
-			ptr<ReturnStatementNode> return_statement = std::static_pointer_cast<ReturnStatementNode>(statement);
-			analyze_expression(return_statement->expression);
+			ReturnStatementNode* return_statement = static_cast<ReturnStatementNode*>(statement);
+			schedule(AnalysisItem::EXPRESSION, return_statement->expression);
 			break;
 		}
 		case NodeType::IF_STATEMENT: {
-			ptr<IfStatementNode> if_statement = std::static_pointer_cast<IfStatementNode>(statement);
+			IfStatementNode* if_statement = static_cast<IfStatementNode*>(statement);
 
 			// Resolve subexpressions and statements
-			analyze_expression(if_statement->condition);
-			analyze_statement(if_statement->body);
 			if (if_statement->else_body)
-				analyze_statement(if_statement->else_body);
+				schedule(AnalysisItem::STATEMENT, if_statement->else_body);
+			schedule(AnalysisItem::STATEMENT, if_statement->body);
+			schedule(AnalysisItem::EXPRESSION, if_statement->condition);
 			break;
 		}
 		case NodeType::WHILE_STATEMENT: {
 			// Each loop gets a unique id to distinguish break and continue statements
 			uint64_t loop_id = new_loop();
-			ptr<WhileStatementNode> while_statement = std::static_pointer_cast<WhileStatementNode>(statement);
+			WhileStatementNode* while_statement = static_cast<WhileStatementNode*>(statement);
 			while_statement->id = loop_id;
 
-			// Resolve subexpressions and statements
-			analyze_expression(while_statement->condition);
-			analyze_statement(while_statement->body);
-
-			// Set current loop to the outer loop (if there is one)
-			m_loop_stack.pop_back();
+			// Resolve subexpressions and statements, then set current loop to the outer loop
+			schedule(AnalysisItem::POP_LOOP);
+			schedule(AnalysisItem::STATEMENT, while_statement->body);
+			schedule(AnalysisItem::EXPRESSION, while_statement->condition);
 			break;
 		}
 		case NodeType::LOOP_STATEMENT: {
 			// Each loop gets a unique id to distinguish break and continue statements
 			uint64_t loop_id = new_loop();
-			ptr<LoopStatementNode> loop_statement = std::static_pointer_cast<LoopStatementNode>(statement);
+			LoopStatementNode* loop_statement = static_cast<LoopStatementNode*>(statement);
 			loop_statement->id = loop_id;
 
-			analyze_statement(loop_statement->body);
-
-			// Set current loop to the outer loop (if there is one)
-			m_loop_stack.pop_back();
+			schedule(AnalysisItem::POP_LOOP);
+			schedule(AnalysisItem::STATEMENT, loop_statement->body);
 			break;
 		}
 		case NodeType::FOR_STATEMENT: {
 			// Each loop gets a unique id to distinguish break and continue statements
 			uint64_t loop_id = new_loop();
-			ptr<ForStatementNode> for_statement = std::static_pointer_cast<ForStatementNode>(statement);
+			ForStatementNode* for_statement = static_cast<ForStatementNode*>(statement);
 			for_statement->id = loop_id;
 
-			// Resolve subexpressions and statements
-			analyze_expression(for_statement->init);
-			analyze_expression(for_statement->condition);
-			analyze_expression(for_statement->post_loop);
-			analyze_statement(for_statement->body);
-
-			// Set current loop to the outer loop (if there is one)
-			m_loop_stack.pop_back();
+			// Resolve subexpressions and statements, then set current loop to the outer loop
+			schedule(AnalysisItem::POP_LOOP);
+			schedule(AnalysisItem::STATEMENT, for_statement->body);
+			schedule(AnalysisItem::EXPRESSION, for_statement->post_loop);
+			schedule(AnalysisItem::EXPRESSION, for_statement->condition);
+			schedule(AnalysisItem::EXPRESSION, for_statement->init);
 			break;
 		}
 		case NodeType::BREAK_STATEMENT: {
 			if (m_loop_stack.empty())
 				m_error_handler->report_error(Error{ "Cannot use break outside of a loop" });
 			else {
-				ptr<BreakStatementNode> break_statement = std::static_pointer_cast<BreakStatementNode>(statement);
+				BreakStatementNode* break_statement = static_cast<BreakStatementNode*>(statement);
 				// Attach the id corresponding to the current loop we are in
 				break_statement->id = current_loop();
 			}
@@ -217,7 +255,7 @@ namespace Anthem {
 			if (m_loop_stack.empty())
 				m_error_handler->report_error(Error{ "Cannot use continue outside of a loop" });
 			else {
-				ptr<ContinueStatementNode> continue_statement = std::static_pointer_cast<ContinueStatementNode>(statement);
+				ContinueStatementNode* continue_statement = static_cast<ContinueStatementNode*>(statement);
 				// Attach the id corresponding to the current loop we are in
 				continue_statement->id = current_loop();
 			}
@@ -228,65 +266,93 @@ namespace Anthem {
 		}
 	}
 
-	void SemanticAnalyzer::analyze_expression(ptr<ExpressionNode> expression) {
+	void SemanticAnalyzer::analyze_expression(ExpressionNode* expression) {
+		expression->expression_id = new_expression();
+
+		// The expression is typed after its operands were analyzed
+		if (m_check_types)
+			schedule(AnalysisItem::TYPE_EXPRESSION, expression);
 		switch (expression->get_type()) {
 		case NodeType::UNARY_OPERATION: {
-			ptr<UnaryOperationNode> unary_op = std::static_pointer_cast<UnaryOperationNode>(expression);
-			analyze_expression(unary_op->expression);
+			UnaryOperationNode* unary_op = static_cast<UnaryOperationNode*>(expression);
+			schedule(AnalysisItem::EXPRESSION, unary_op->expression);
 			break;
 		}
 		case NodeType::BINARY_OPERATION: {
-			ptr<BinaryOperationNode> binary_op = std::static_pointer_cast<BinaryOperationNode>(expression);
-			analyze_expression(binary_op->left_expression);
-			analyze_expression(binary_op->right_expression);
+			BinaryOperationNode* binary_op = static_cast<BinaryOperationNode*>(expression);
+			schedule(AnalysisItem::EXPRESSION, binary_op->right_expression);
+			schedule(AnalysisItem::EXPRESSION, binary_op->left_expression);
 			break;
 		}
 		case NodeType::ASSIGNMENT: {
-			ptr<AssignmentNode> assignment = std::static_pointer_cast<AssignmentNode>(expression);
+			AssignmentNode* assignment = static_cast<AssignmentNode*>(expression);
 
 			// Check if assignment target is an LValue
-			if (assignment->lvalue->get_type() != NodeType::NAME_ACCESS)
+			if (assignment->lvalue->get_type() != NodeType::NAME_ACCESS && assignment->lvalue->get_type() != NodeType::INDEX)
 				report_error("Invalid assignment target", assignment->token);
-			analyze_expression(assignment->lvalue);
-			analyze_expression(assignment->expression);
+			schedule(AnalysisItem::EXPRESSION, assignment->expression);
+			schedule(AnalysisItem::EXPRESSION, assignment->lvalue);
 			break;
 		}
-		case NodeType::NAME_ACCESS: {
-			ptr<AccessNode> name_access = std::static_pointer_cast<AccessNode>(expression);
-			Name name = name_access->variable_token.value;
-
-			// Check if the variable exists
-			if (current_map().find(name) != current_map().end())
-				name_access->variable_token.value = current_map()[name];
-			else if (m_global_map.find(name) != m_global_map.end())
-				name_access->variable_token.value = m_global_map[name];
-			else
-				report_error("Variable '" + name + "' is not defined in this scope", name_access->variable_token);
-			
+		case NodeType::NAME_ACCESS:
+			resolve_access(static_cast<AccessNode*>(expression));
+			break;
+		case NodeType::INDEX: {
+			// The array is resolved here, only the index is an expression of its own
+			IndexNode* index = static_cast<IndexNode*>(expression);
+			resolve_access(index->array);
+			schedule(AnalysisItem::EXPRESSION, index->index);
 			break;
 		}
 		case NodeType::FUNCTION_CALL: {
-			ptr<FunctionCallNode> function_call = std::static_pointer_cast<FunctionCallNode>(expression);
-			Name name = function_call->variable_token.value;
+			FunctionCallNode* function_call = static_cast<FunctionCallNode*>(expression);
+			Name name = function_call->identifier;
 
-			if (m_global_map.find(name) == m_global_map.end())
-				report_error("Function '" + name + "' is not defined", function_call->variable_token);
-			else
-				name = m_global_map[name];
+			if (!m_type_checker->get_symbols().contains(name))
+				report_error("Function '" + name.str() + "' is not defined", function_call->variable_token);
+			else {
+				function_call->name = name;
+				if (m_check_types)
+					m_type_checker->check_call(function_call);
+			}
 			
-			for (auto& expr : function_call->argument_list) {
-				analyze_expression(expr);
+			for (auto argument = function_call->argument_list.rbegin(); argument != function_call->argument_list.rend(); ++argument) {
+				schedule(AnalysisItem::EXPRESSION, *argument);
 			}
 			break;
 		}
+		default:
+			break;
 		}
 	}
 
+	void SemanticAnalyzer::resolve_access(AccessNode* access) {
+		Name name = access->identifier;
+
+		// Check if the variable exists
+		if (const Binding* binding = m_names.find(name)) {
+			access->name = binding->name;
+			access->id = binding->id;
+		}
+		else if (m_type_checker->get_symbols().contains(name))
+			access->name = name;
+		else
+			report_error("Variable '" + name.str() + "' is not defined in this scope", access->variable_token);
+	}
+
 	void SemanticAnalyzer::report_error(const std::string& error_msg, const Token& token) {
-		m_error_handler->report_error(Error{ error_msg, token.position });
+		m_error_handler->report_error(Error{ error_msg, token.position() });
+	}
+
+	VarId SemanticAnalyzer::new_variable() {
+		return VarId(m_variable_counter++);
+	}
+
+	ExprId SemanticAnalyzer::new_expression() {
+		return ExprId(m_expression_counter++);
 	}
 
-	Name SemanticAnalyzer::make_unique(const Name& name) {
-		return name + "#" + std::to_string(m_unique_counter++);
+	Name SemanticAnalyzer::make_unique(Name name) {
+		return name.str() + "#" + std::to_string(m_unique_counter++);
 	}
 }
\ No newline at end of file
@@ -5,24 +5,31 @@
 #pragma once
 #include "Utilities/Error.h"
 #include "Parser/Parser.h"
-#include <unordered_map>
+#include "TypeChecker.h"
+#include "ScopedTable.h"
 
 namespace Anthem {
 	class SemanticAnalyzer {
 	public:
 		SemanticAnalyzer(ErrorHandler* error_handler);
 
-		void analyze_resolve(ptr<ProgramNode> program_node);
+		// Resolve and uniquify names and assign loop ids, the AST has to be type checked afterwards by <type_checker>.
+		// Names are resolved against its symbol table, which its own walk fills in again
+		void analyze_resolve(ProgramNode* program_node, TypeChecker& type_checker);
+
+		// Resolve names and type check every Node in the same walk, filling the symbol table of <type_checker>
+		void analyze(ProgramNode* program_node, TypeChecker& type_checker);
 	private:
 		// -- Utility --
 
-		using VarMap = std::unordered_map<Name, Name>;
+		// What a Name written in the source refers to, a local variable or a global variable that was renamed
+		struct Binding {
+			VarId id;
+			Name name{ "" };
+		};
 
 		void report_error(const std::string& error_msg, const Token& token);
 
-		// Get current variable/name map
-		VarMap& current_map();
-
 		// Start new loop
 		uint64_t new_loop();
 
@@ -31,25 +38,78 @@ namespace Anthem {
 
 		// -- Analysis --
 
-		// Add declarations to map / Handle multiple declarations
-		void save_declaration(ptr<DeclarationNode> declaration_node);
+		// Collect the top level declarations and walk the whole AST
+		void resolve_program(ProgramNode* program_node);
+
+		// Add functions to the symbol table / Handle multiple declarations
+		void save_declaration(DeclarationNode* declaration_node);
+
+		// Work left for the analysis, the children of a node are scheduled on an explicit stack instead of being analyzed recursively
+		struct AnalysisItem {
+			enum Kind : uint8_t {
+				DECLARATION,
+				STATEMENT,
+				EXPRESSION,
+
+				// Add an analyzed variable declaration to its scope
+				BIND_VARIABLE,
+
+				// Type an expression whose operands were analyzed, only scheduled when type checking is fused
+				TYPE_EXPRESSION,
+
+				// Leave the scope of a block or function
+				POP_SCOPE,
+
+				// Leave the body of a loop
+				POP_LOOP
+			};
+
+			Kind kind;
+			ASTNode* node{ nullptr };
+		};
 
-		void analyze_declaration(ptr<DeclarationNode> declaration_node);
-		void analyze_statement(ptr<StatementNode> statement);
-		void analyze_expression(ptr<ExpressionNode> expression);
+		void schedule(AnalysisItem::Kind kind, ASTNode* node = nullptr);
 
-		// Generate unique name
-		Name make_unique(const Name& name);
+		// Analyze scheduled items until the work stack is empty
+		void analyze_scheduled();
 
-		// Maps for local variables
-		std::vector<VarMap> m_local_map_stack;
-		VarMap m_global_map;
+		// Analyze a single node and schedule its children
+		void analyze_declaration(DeclarationNode* declaration_node);
+		void analyze_statement(StatementNode* statement);
+		void analyze_expression(ExpressionNode* expression);
+
+		void bind_variable(VariableNode* variable);
+
+		// Find the variable a name refers to, a local one or a variable of the whole program
+		void resolve_access(AccessNode* access);
+
+		// Number a new local variable
+		VarId new_variable();
+
+		// Number a new expression
+		ExprId new_expression();
+
+		// Generate unique name for an internal variable, which still needs a symbol of its own
+		Name make_unique(Name name);
+
+		// Local variables of the enclosing blocks and function, scopes are pushed and popped without copying the bindings.
+		// Internal variables are bound in the outermost scope to their unique Names, every other global variable and function
+		// is only recorded in the symbol table of the TypeChecker, together with its type
+		ScopedTable<Name, Binding> m_names;
 
 		// Stack for loop ids;
 		std::vector<uint64_t> m_loop_stack;
 		uint64_t m_loop_counter{ 0 };
 
+		uint32_t m_variable_counter{ 0 };
+		uint32_t m_expression_counter{ 0 };
 		uint64_t m_unique_counter{ 0 };
+
+		std::vector<AnalysisItem> m_work_stack;
 		ErrorHandler* m_error_handler;
+
+		// Holds the symbol table, its checks are only called when type checking is fused into the analysis
+		TypeChecker* m_type_checker{ nullptr };
+		bool m_check_types{ false };
 	};
 }
\ No newline at end of file
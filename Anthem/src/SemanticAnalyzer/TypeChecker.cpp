@@ -5,69 +5,284 @@
 #include "TypeChecker.h"
 
 namespace Anthem {
-	TypeChecker::TypeChecker(ErrorHandler* error_handler) : m_error_handler{ error_handler } {}
+	// Largest array in bytes, which keeps the offsets of stack arrays and their elements within 32 bits
+	static constexpr uint64_t MAX_ARRAY_SIZE = uint64_t(1) << 30;
 
-	void TypeChecker::check(ptr<ProgramNode> program) {
+	TypeChecker::TypeChecker(ErrorHandler* error_handler)
+		: m_constant_evaluator{ error_handler, m_symbol_table, m_expression_types }, m_error_handler{ error_handler } {}
+
+	void TypeChecker::check(ProgramNode* program) {
 		m_symbol_table.clear();
+		m_expression_types.clear();
 		for (auto& declaration : program->declarations)
 			track_function(declaration);
-		for (auto& declaration : program->declarations)
-			check_declaration(declaration);
+		for (auto& declaration : program->declarations) {
+			enter_declaration(declaration);
+			schedule(CheckItem::DECLARATION, declaration);
+			check_scheduled();
+		}
+	}
+
+	void TypeChecker::enter_declaration(DeclarationNode* declaration) {
+		m_in_const_function = declaration->get_type() == NodeType::FUNCTION_DECLARATION
+			&& static_cast<FunctionDeclarationNode*>(declaration)->is_const;
 	}
 
-	void TypeChecker::track_function(ptr<DeclarationNode> declaration) {
+	void TypeChecker::schedule(CheckItem::Kind kind, ASTNode* node) {
+		m_work_stack.push_back({ kind, node });
+	}
+
+	void TypeChecker::check_scheduled() {
+		while (!m_work_stack.empty()) {
+			CheckItem item = m_work_stack.back();
+			m_work_stack.pop_back();
+			switch (item.kind)
+			{
+			case CheckItem::DECLARATION:
+				check_declaration(static_cast<DeclarationNode*>(item.node));
+				break;
+			case CheckItem::STATEMENT:
+				check_statement(static_cast<StatementNode*>(item.node));
+				break;
+			case CheckItem::EXPRESSION:
+				check_expression(static_cast<ExpressionNode*>(item.node));
+				break;
+			case CheckItem::VARIABLE:
+				check_variable(static_cast<VariableNode*>(item.node));
+				break;
+			case CheckItem::TYPE_EXPRESSION:
+				type_expression(static_cast<ExpressionNode*>(item.node));
+				break;
+			}
+		}
+	}
+
+	void TypeChecker::track_function(DeclarationNode* declaration) {
 		if(declaration->get_type() == NodeType::FUNCTION_DECLARATION) {
-			auto function = std::static_pointer_cast<FunctionDeclarationNode>(declaration);
+			auto function = static_cast<FunctionDeclarationNode*>(declaration);
 			FunctionType func_type;
 
-			// Only 32 bit integer types for now
-			func_type.return_type = ReturnType::I32;
+			func_type.return_type = function->return_type;
+			func_type.is_const = function->is_const;
 			for (auto& parameter : function->parameters)
-				func_type.parameters.push_back(ReturnType::I32);
+				func_type.parameters.push_back(parameter.type);
 
 			// Add the function to the symbol table
 			m_symbol_table[function->name] = func_type;
 		}
 		else if (declaration->get_type() == NodeType::EXTERNAL_DECLARATION) {
-			auto function = std::static_pointer_cast<ExternalFunctionNode>(declaration);
+			auto function = static_cast<ExternalFunctionNode*>(declaration);
 			FunctionType func_type;
 			func_type.is_external = true;
-			func_type.return_type = ReturnType::I32;
+			func_type.return_type = function->return_type;
 			for (auto& parameter : function->parameters)
-				func_type.parameters.push_back(ReturnType::I32);
+				func_type.parameters.push_back(parameter.type);
 
 			// Add the external function to the symbol table
 			m_symbol_table[function->name] = func_type;
 		}
 	}
 
-	void TypeChecker::check_declaration(ptr<DeclarationNode> declaration) {
-		switch (declaration->get_type())
+	void TypeChecker::check_function(FunctionDeclarationNode* function) {
+		for (auto& parameter : function->parameters) {
+			if (!parameter.id.valid())
+				continue;
+			if (parameter.id.value() >= m_local_types.size())
+				m_local_types.resize(parameter.id.value() + 1);
+			m_local_types[parameter.id.value()] = parameter.type;
+		}
+	}
+
+	void TypeChecker::check_variable(VariableNode* variable) {
+		int64_t initializer = 0;
+		bool calls_functions = false;
+
+		if (variable->length_expression) {
+			check_array_length(variable);
+			if (variable->expression)
+				m_error_handler->report_error(Error{ std::format("Array '{0}' cannot have an initializer", variable->identifier), variable->variable_token.position() });
+		}
+		else if (variable->flag != VarFlag::Local && variable->expression) {
+			if (variable->flag == VarFlag::External)
+				m_error_handler->report_error(Error{ "External variable declarations cannot have an initializer", variable->variable_token.position() });
+			else if (std::optional<Constant> value = m_constant_evaluator.evaluate(variable->expression, "Global and internal variable declarations cannot have a non-constant initializer")) {
+				initializer = convert_constant(*value, variable->type).bits();
+				calls_functions = m_constant_evaluator.calls_functions();
+			}
+		}
+
+		// Locals are identified by their VarId and never looked up by Name
+		if (variable->flag == VarFlag::Local) {
+			if (variable->id.valid()) {
+				if (variable->id.value() >= m_local_types.size())
+					m_local_types.resize(variable->id.value() + 1);
+				if (variable->id.value() >= m_local_lengths.size())
+					m_local_lengths.resize(variable->id.value() + 1);
+				m_local_types[variable->id.value()] = variable->type;
+				m_local_lengths[variable->id.value()] = variable->array_length;
+			}
+		}
+		else
+			m_symbol_table[variable->name] = VariableType{ variable->type, variable->flag, initializer, calls_functions, variable->array_length };
+	}
+
+	void TypeChecker::check_array_length(VariableNode* variable) {
+		// An array whose length is wrong still gets one element, so its accesses don't cause errors of their own
+		variable->array_length = 1;
+		std::optional<Constant> length = m_constant_evaluator.evaluate(variable->length_expression, "The length of an array must be a constant expression");
+		if (!length)
+			return;
+
+		if (m_constant_evaluator.calls_functions() || is_floating(length->type))
+			m_error_handler->report_error(Error{ std::format("The length of array '{0}' must be an integer constant", variable->identifier), variable->variable_token.position() });
+		else if (length->integer <= 0)
+			m_error_handler->report_error(Error{ std::format("The length of array '{0}' must be positive", variable->identifier), variable->variable_token.position() });
+		else if (uint64_t(length->integer) > MAX_ARRAY_SIZE / type_size(variable->type))
+			m_error_handler->report_error(Error{ std::format("Array '{0}' is larger than {1} bytes", variable->identifier, MAX_ARRAY_SIZE), variable->variable_token.position() });
+		else
+			variable->array_length = static_cast<uint32_t>(length->integer);
+	}
+
+	void TypeChecker::check_call(FunctionCallNode* call) {
+		// Get the function type object of the called function from the symbol table
+		auto symbol = m_symbol_table.find(call->name);
+		if (symbol == m_symbol_table.end() || !std::holds_alternative<FunctionType>(symbol->second)) {
+			m_error_handler->report_error(Error{ std::format("'{0}' is not a function", call->name.view()), call->variable_token.position() });
+			return;
+		}
+		auto& function_type = std::get<FunctionType>(symbol->second);
+
+		// If the number of arguments don't match the number of parameters throw an error
+		if (call->argument_list.size() != function_type.parameters.size())
+			m_error_handler->report_error(Error{ std::format("Function call '{0}' expected {1} arguments but got {2}"
+				, call->name.view(), function_type.parameters.size(), call->argument_list.size())});
+
+		// Set external status
+		if (function_type.is_external)
+			call->is_external = true;
+
+		if (m_in_const_function && !function_type.is_const)
+			m_error_handler->report_error(Error{ std::format("Constant functions can only call constant functions, '{0}' is not one", call->name.view()), call->variable_token.position() });
+		m_expression_types.set(call->expression_id, function_type.return_type);
+	}
+
+	void TypeChecker::type_expression(ExpressionNode* expression) {
+		// Every numeric type converts implicitly to every other one, so only operators that have no meaning for a type are errors
+		switch (expression->get_type())
 		{
-		case NodeType::VARIABLE: {
-			auto variable = std::static_pointer_cast<VariableNode>(declaration);
-
-			int initializer = 0;
-
-			if (variable->flag != VarFlag::Local && variable->expression) {
-				if(variable->flag == VarFlag::External)
-					m_error_handler->report_error(Error{ "External variable declarations cannot have an initializer" });
-				else {
-					if (variable->expression->get_type() != NodeType::INT_LITERAL)
-						m_error_handler->report_error(Error{ "Global and internal variable declarations cannot have a non-constant initializer" });
-				}
-				initializer = std::static_pointer_cast<IntegerLiteralNode>(variable->expression)->integer;
+		case NodeType::INT_LITERAL: {
+			int64_t integer = static_cast<IntegerLiteralNode*>(expression)->integer;
+			m_expression_types.set(expression->expression_id, integer <= INT32_MAX ? ReturnType::I32 : ReturnType::I64);
+			break;
+		}
+		case NodeType::FLOAT_LITERAL:
+			m_expression_types.set(expression->expression_id, static_cast<FloatLiteralNode*>(expression)->type);
+			break;
+		case NodeType::BOOL_LITERAL:
+			m_expression_types.set(expression->expression_id, ReturnType::BOOL);
+			break;
+		case NodeType::UNARY_OPERATION: {
+			UnaryOperationNode* unary = static_cast<UnaryOperationNode*>(expression);
+			ReturnType operand = m_expression_types[unary->expression->expression_id];
+			if (unary->operator_token.type == BANG)
+				m_expression_types.set(expression->expression_id, ReturnType::BOOL);
+			else {
+				if (unary->operator_token.type == TILDE && is_floating(operand))
+					m_error_handler->report_error(Error{ "Operator '~' requires an integer operand", unary->operator_token.position() });
+				m_expression_types.set(expression->expression_id, operand == ReturnType::BOOL ? ReturnType::I32 : operand);
+			}
+			break;
+		}
+		case NodeType::BINARY_OPERATION: {
+			BinaryOperationNode* binary = static_cast<BinaryOperationNode*>(expression);
+			ReturnType operands = common_type(m_expression_types[binary->left_expression->expression_id], m_expression_types[binary->right_expression->expression_id]);
+			switch (binary->operator_token.type)
+			{
+			case PERCENT:
+				if (is_floating(operands))
+					m_error_handler->report_error(Error{ "Operator '%' requires integer operands", binary->operator_token.position() });
+				m_expression_types.set(expression->expression_id, operands);
+				break;
+			case PLUS:
+			case MINUS:
+			case STAR:
+			case SLASH:
+				m_expression_types.set(expression->expression_id, operands);
+				break;
+			default:
+				// Relational and logical operations
+				m_expression_types.set(expression->expression_id, ReturnType::BOOL);
+				break;
+			}
+			break;
+		}
+		case NodeType::ASSIGNMENT: {
+			AssignmentNode* assignment = static_cast<AssignmentNode*>(expression);
+			m_expression_types.set(expression->expression_id, m_expression_types[assignment->lvalue->expression_id]);
+			break;
+		}
+		case NodeType::NAME_ACCESS: {
+			AccessNode* access = static_cast<AccessNode*>(expression);
+			uint32_t length = 0;
+			m_expression_types.set(expression->expression_id, type_access(access, length));
+			if (length)
+				m_error_handler->report_error(Error{ std::format("Array '{0}' can only be accessed through an index", access->identifier), access->variable_token.position() });
+			break;
+		}
+		case NodeType::INDEX: {
+			IndexNode* index = static_cast<IndexNode*>(expression);
+			m_expression_types.set(expression->expression_id, type_access(index->array, index->length));
+
+			// Names that were not resolved were already reported
+			bool resolved = index->array->id.valid() || !index->array->name.empty();
+			if (resolved && !index->length) {
+				m_error_handler->report_error(Error{ std::format("'{0}' is not an array", index->array->identifier), index->bracket_token.position() });
+				index->length = 1;
 			}
+			if (is_floating(m_expression_types[index->index->expression_id]))
+				m_error_handler->report_error(Error{ "Array indices must be integers", index->bracket_token.position() });
+			break;
+		}
+		default:
+			// Calls are typed by check_call
+			break;
+		}
+	}
+
+	ReturnType TypeChecker::type_access(AccessNode* access, uint32_t& length) {
+		length = 0;
+		if (access->id.valid()) {
+			uint32_t id = access->id.value();
+			if (id < m_local_lengths.size())
+				length = m_local_lengths[id];
+			return id < m_local_types.size() ? m_local_types[id] : ReturnType::I32;
+		}
+		if (auto symbol = m_symbol_table.find(access->name); symbol != m_symbol_table.end() && std::holds_alternative<VariableType>(symbol->second)) {
+			if (m_in_const_function)
+				m_error_handler->report_error(Error{ std::format("Constant functions cannot access global variable '{0}'", access->identifier), access->variable_token.position() });
+			length = std::get<VariableType>(symbol->second).array_length;
+			return std::get<VariableType>(symbol->second).return_type;
+		}
+		return ReturnType::I32;
+	}
 
-			// Only 32 bit integer types for now
-			m_symbol_table[variable->variable_token.value] = VariableType{ ReturnType::I32, variable->flag, initializer };
+	void TypeChecker::check_declaration(DeclarationNode* declaration) {
+		switch (declaration->get_type())
+		{
+		case NodeType::VARIABLE: {
+			// The initializer and length are typed first, so that constant ones can be evaluated
+			auto variable = static_cast<VariableNode*>(declaration);
+			schedule(CheckItem::VARIABLE, variable);
 			if (variable->expression)
-				check_expression(variable->expression);
+				schedule(CheckItem::EXPRESSION, variable->expression);
+			if (variable->length_expression)
+				schedule(CheckItem::EXPRESSION, variable->length_expression);
 			break;
 		}
 		case NodeType::FUNCTION_DECLARATION: {
-			auto function = std::static_pointer_cast<FunctionDeclarationNode>(declaration);
-			check_statement(function->body);
+			auto function = static_cast<FunctionDeclarationNode*>(declaration);
+			check_function(function);
+			schedule(CheckItem::STATEMENT, function->body);
 			break; 
 		}
 		default:
@@ -75,49 +290,55 @@ namespace Anthem {
 		}
 	}
 
-	void TypeChecker::check_statement(ptr<StatementNode> statement) {
+	void TypeChecker::check_statement(StatementNode* statement) {
 		switch (statement->get_type())
 		{
 		case NodeType::BLOCK_STATEMENT: {
-			ptr<BlockStatementNode> block = std::static_pointer_cast<BlockStatementNode>(statement);
-			for (auto& item : block->items) {
-				if (std::holds_alternative<ptr<StatementNode>>(item))
-					check_statement(std::get<ptr<StatementNode>>(item));
+			BlockStatementNode* block = static_cast<BlockStatementNode*>(statement);
+			for (auto item = block->items.rbegin(); item != block->items.rend(); ++item) {
+				if (std::holds_alternative<StatementNode*>(*item))
+					schedule(CheckItem::STATEMENT, std::get<StatementNode*>(*item));
 				else
-					check_declaration(std::get<ptr<DeclarationNode>>(item));
+					schedule(CheckItem::DECLARATION, std::get<DeclarationNode*>(*item));
 			}
 			break;
 		}
 		case NodeType::EXPR_STATEMENT: {
-			ptr<ExprStatementNode> expr_statement = std::static_pointer_cast<ExprStatementNode>(statement);
-			check_expression(expr_statement->expression);
+			ExprStatementNode* expr_statement = static_cast<ExprStatementNode*>(statement);
+			schedule(CheckItem::EXPRESSION, expr_statement->expression);
+			break;
+		}
+		case NodeType::RETURN_STATEMENT: {
+			ReturnStatementNode* return_statement = static_cast<ReturnStatementNode*>(statement);
+			schedule(CheckItem::EXPRESSION, return_statement->expression);
 			break;
 		}
 		case NodeType::FOR_STATEMENT: {
-			ptr<ForStatementNode> for_statement = std::static_pointer_cast<ForStatementNode>(statement);
-			check_expression(for_statement->condition);
-			check_expression(for_statement->init);
-			check_expression(for_statement->post_loop);
-			check_statement(for_statement->body);
+			ForStatementNode* for_statement = static_cast<ForStatementNode*>(statement);
+			// Children are scheduled in reverse, so they are checked in the order condition, init, post loop, body
+			schedule(CheckItem::STATEMENT, for_statement->body);
+			schedule(CheckItem::EXPRESSION, for_statement->post_loop);
+			schedule(CheckItem::EXPRESSION, for_statement->init);
+			schedule(CheckItem::EXPRESSION, for_statement->condition);
 			break;
 		}
 		case NodeType::WHILE_STATEMENT: {
-			ptr<WhileStatementNode> while_statement = std::static_pointer_cast<WhileStatementNode>(statement);
-			check_expression(while_statement->condition);
-			check_statement(while_statement->body);
+			WhileStatementNode* while_statement = static_cast<WhileStatementNode*>(statement);
+			schedule(CheckItem::STATEMENT, while_statement->body);
+			schedule(CheckItem::EXPRESSION, while_statement->condition);
 			break;
 		}
 		case NodeType::LOOP_STATEMENT: {
-			ptr<LoopStatementNode> loop_statement = std::static_pointer_cast<LoopStatementNode>(statement);
-			check_statement(loop_statement->body);
+			LoopStatementNode* loop_statement = static_cast<LoopStatementNode*>(statement);
+			schedule(CheckItem::STATEMENT, loop_statement->body);
 			break;
 		}
 		case NodeType::IF_STATEMENT: {
-			ptr<IfStatementNode> if_statement = std::static_pointer_cast<IfStatementNode>(statement);
-			check_expression(if_statement->condition);
-			check_statement(if_statement->body);
+			IfStatementNode* if_statement = static_cast<IfStatementNode*>(statement);
 			if (if_statement->else_body)
-				check_statement(if_statement->else_body);
+				schedule(CheckItem::STATEMENT, if_statement->else_body);
+			schedule(CheckItem::STATEMENT, if_statement->body);
+			schedule(CheckItem::EXPRESSION, if_statement->condition);
 			break;
 		}
 		case NodeType::BREAK_STATEMENT:
@@ -128,48 +349,42 @@ namespace Anthem {
 		}
 	}
 
-	void TypeChecker::check_expression(ptr<ExpressionNode> expression) {
+	void TypeChecker::check_expression(ExpressionNode* expression) {
+		// The expression is typed after its operands, which are scheduled on top of it
+		schedule(CheckItem::TYPE_EXPRESSION, expression);
 		switch (expression->get_type())
 		{
 		// Type check subexpressions
 		case NodeType::UNARY_OPERATION: {
-			ptr<UnaryOperationNode> unary = std::static_pointer_cast<UnaryOperationNode>(expression);
-			check_expression(unary->expression);
+			UnaryOperationNode* unary = static_cast<UnaryOperationNode*>(expression);
+			schedule(CheckItem::EXPRESSION, unary->expression);
 			break;
 		}
 		case NodeType::BINARY_OPERATION: {
-			ptr<BinaryOperationNode> binary = std::static_pointer_cast<BinaryOperationNode>(expression);
-			check_expression(binary->left_expression);
-			check_expression(binary->right_expression);
+			BinaryOperationNode* binary = static_cast<BinaryOperationNode*>(expression);
+			schedule(CheckItem::EXPRESSION, binary->right_expression);
+			schedule(CheckItem::EXPRESSION, binary->left_expression);
 			break;
 		}
 		case NodeType::ASSIGNMENT: {
-			ptr<AssignmentNode> assignment = std::static_pointer_cast<AssignmentNode>(expression);
-			check_expression(assignment->lvalue);
-			check_expression(assignment->expression);
+			AssignmentNode* assignment = static_cast<AssignmentNode*>(expression);
+			schedule(CheckItem::EXPRESSION, assignment->expression);
+			schedule(CheckItem::EXPRESSION, assignment->lvalue);
 			break;
 		}
 		case NodeType::NAME_ACCESS:
 			break;
+		case NodeType::INDEX:
+			schedule(CheckItem::EXPRESSION, static_cast<IndexNode*>(expression)->index);
+			break;
 		case NodeType::FUNCTION_CALL: {
-			ptr<FunctionCallNode> call = std::static_pointer_cast<FunctionCallNode>(expression);
-
-			// Get the function type object of the called function from the symbol table
-			auto& function_type = std::get<FunctionType>(m_symbol_table[call->variable_token.value]);
-
-			// If the number of arguments don't match the number of parameters throw an error
-			if (call->argument_list.size() != function_type.parameters.size())
-				m_error_handler->report_error(Error{ std::format("Function call '{0}' expected {1} arguments but got {2}"
-					, call->variable_token.value, function_type.parameters.size(), call->argument_list.size())});
+			FunctionCallNode* call = static_cast<FunctionCallNode*>(expression);
+			check_call(call);
 
 			// Type check arguments
-			for (auto& arg : call->argument_list) {
-				check_expression(arg);
+			for (auto arg = call->argument_list.rbegin(); arg != call->argument_list.rend(); ++arg) {
+				schedule(CheckItem::EXPRESSION, *arg);
 			}
-
-			// Set external status
-			if (function_type.is_external)
-				call->is_external = true;
 			break;
 		}
 		default:
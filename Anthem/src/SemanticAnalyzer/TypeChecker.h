@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include "Utilities/Utilities.h"
 #include "Utilities/Error.h"
+#include "ConstantEvaluator.h"
 #include <Parser/ASTNodes.h>
 
 namespace Anthem {
@@ -13,20 +14,79 @@ namespace Anthem {
 	public:
 		TypeChecker(ErrorHandler* error_handler);
 
-		// Type Check an AST
-		void check(ptr<ProgramNode> program);
+		// Type Check an AST whose names were resolved by the SemanticAnalyzer, in a walk of its own
+		void check(ProgramNode* program);
 
 		SymbolTable& get_symbols() { return m_symbol_table; }
+		ExpressionTypes& get_expression_types() { return m_expression_types; }
 
-	private:
-		void check_declaration(ptr<DeclarationNode> declaration);
-		void check_statement(ptr<StatementNode> statement);
-		void check_expression(ptr<ExpressionNode> expression);
+		// -- Checks of single Nodes, also called by the SemanticAnalyzer when type checking is fused into its walk --
+
+		// Start checking a top level declaration, the body of a constant function may only do what can be evaluated at compile time
+		void enter_declaration(DeclarationNode* declaration);
 
 		// Add function to the symbol table
-		void track_function(ptr<DeclarationNode> declaration);
+		void track_function(DeclarationNode* declaration);
+
+		// Record the types of the parameters of a function whose names were resolved
+		void check_function(FunctionDeclarationNode* function);
+
+		// Add a resolved variable declaration to the symbol table and check its initializer
+		void check_variable(VariableNode* variable);
+
+		// Check the arguments of a resolved call against the called function and give the call its return type
+		void check_call(FunctionCallNode* call);
+
+		// Give an expression its type, once all of its operands have their own
+		void type_expression(ExpressionNode* expression);
+	private:
+		// Nodes left to check, children are scheduled on an explicit stack instead of being checked recursively
+		struct CheckItem {
+			enum Kind : uint8_t {
+				DECLARATION,
+				STATEMENT,
+				EXPRESSION,
+
+				// Check a variable declaration once its initializer was typed
+				VARIABLE,
+
+				// Type an expression whose operands were checked
+				TYPE_EXPRESSION
+			};
+
+			Kind kind;
+			ASTNode* node;
+		};
+
+		void schedule(CheckItem::Kind kind, ASTNode* node);
+
+		// Check scheduled nodes until the work stack is empty
+		void check_scheduled();
+
+		// Check a single node and schedule its children
+		void check_declaration(DeclarationNode* declaration);
+		void check_statement(StatementNode* statement);
+		void check_expression(ExpressionNode* expression);
+
+		// Evaluate the length of an array declaration
+		void check_array_length(VariableNode* variable);
+
+		// Type of an accessed variable, and its number of elements in <length> if it is an array
+		ReturnType type_access(AccessNode* access, uint32_t& length);
 	private:
 		SymbolTable m_symbol_table;
+		ExpressionTypes m_expression_types;
+
+		// Evaluates the initializers of global and internal variables
+		ConstantEvaluator m_constant_evaluator;
+
+		// Set while the body of a constant function is checked
+		bool m_in_const_function{ false };
+
+		// Types of local variables and parameters, and the lengths of local arrays, indexed by VarId
+		std::vector<ReturnType> m_local_types;
+		std::vector<uint32_t> m_local_lengths;
+		std::vector<CheckItem> m_work_stack;
 
 		ErrorHandler* m_error_handler;
 	};
@@ -1,70 +1,56 @@
 #include "Error.h"
 #include "Utilities.h"
-#include <fstream>
-#include <sstream>
 #include <iostream>
+#include <algorithm>
 
 namespace Anthem {
 	void ErrorHandler::report_error(const Error& error) {
-		m_errors.push_back(error);
+		if (!error_limit_reached())
+			m_errors.push_back(error);
 	}
 
 	void ErrorHandler::print_errors() {
 		for (auto& error : m_errors) {
-			// -- Read file contents --
-			std::ifstream file(error.token_position.src_file_path);
-
-			// Store file content to stringstream buffer
-			std::stringstream buffer;
-			buffer << file.rdbuf();
-
-			std::string source = buffer.str();
-
-			// -- File content substring to output comprehensive Error Message --
-			const int maximum_line_padding_characters = 30;
-			int leading_index = 0; // <-- How many characters will get included before the problematic Token
-			int after_index = 0; // <-- After the problematic Token
-
-			// Begin loop at the start of the error Token
-			for (int i = error.token_position.src_start_index; i > 0; i--) {
-				if (source[i] == '\n')
-					break;
-				if (leading_index >= maximum_line_padding_characters)
-					break;
-				leading_index++;
+			// Errors that are not tied to a source file only get their message logged
+			if (!m_source_manager || !m_source_manager->is_valid(error.token_position.file_id)) {
+				log(LogType::ERROR, error.message);
+				continue;
 			}
 
-			// Begin loop at the end of the error Token
-			for (int i = error.token_position.src_end_index; i < source.size(); i++) {
-				if (source[i] == '\n')
-					break;
-				if (after_index >= maximum_line_padding_characters)
-					break;
-				after_index++;
-			}
-
-			int start_pos = error.token_position.src_start_index - leading_index;
-			int end_pos = error.token_position.src_end_index + after_index;
-
-			std::string error_line = (leading_index == maximum_line_padding_characters ? "..." : "") 
-				+ source.substr(start_pos, end_pos - start_pos) 
-				+ (after_index == maximum_line_padding_characters ? "..." : "");
-
-			std::string line_info = std::format("Line {0}: ", error.token_position.src_line);
-																									 // 3 is the size of "..."
-			int padding_amount = line_info.size() + (leading_index == maximum_line_padding_characters ? 3 + leading_index : leading_index) - 1;
-			std::string arrows;
-			for (int i = 0; i < padding_amount; i++)
-				arrows += " ";
-			int arrow_number = error.token_position.src_end_index - error.token_position.src_start_index + 1;
-			for (int i = 0; i < arrow_number; i++)
-				arrows += "^";
-			
+			// -- Line and column are looked up in the line offset table of the file --
+			const Position& position = error.token_position;
+			uint32_t line = m_source_manager->get_line(position);
+			uint32_t column = m_source_manager->get_column(position);
+			std::string_view line_text = m_source_manager->get_line_text(position.file_id, line);
+
+			// -- Line substring to output comprehensive Error Message --
+			const uint32_t maximum_line_padding_characters = 30;
+			uint32_t line_size = uint32_t(line_text.size());
+			uint32_t token_length = position.src_end_index - position.src_start_index + 1;
+			uint32_t token_end = std::min(column + token_length, line_size);
+
+			// How many characters will get included before and after the problematic Token
+			uint32_t leading_count = std::min(column, maximum_line_padding_characters);
+			uint32_t after_count = std::min(line_size - token_end, maximum_line_padding_characters);
+			bool cut_leading = column > leading_count;
+			bool cut_after = token_end + after_count < line_size;
+
+			std::string error_line = (cut_leading ? "..." : "")
+				+ std::string(line_text.substr(column - leading_count, leading_count + token_end - column + after_count))
+				+ (cut_after ? "..." : "");
+
+			// Arrows start under the Token, 3 is the size of "..."
+			std::string line_info = std::format("Line {0}: ", line);
+			std::string arrows(line_info.size() + (cut_leading ? 3 : 0) + leading_count, ' ');
+			arrows.append(token_length, '^');
 
 			log(LogType::ERROR, error.message + " at file: '" + 
-				error.token_position.src_file_path.filename().string() + "', line: " + std::to_string(error.token_position.src_line));
+				m_source_manager->get_path(error.token_position.file_id).filename().string() + "', line: " + std::to_string(line));
 			std::cout << line_info << error_line << '\n' << arrows << "\n\n";
 		}
+
+		if (error_limit_reached())
+			log(LogType::ERROR, std::format("Too many errors, stopped after the first {0}", m_error_limit));
 	}
 
 	bool ErrorHandler::has_errors() {
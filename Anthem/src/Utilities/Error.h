@@ -3,6 +3,7 @@
 #include <filesystem>
 #include <vector>
 #include "Utilities.h"
+#include "SourceManager.h"
 
 namespace Anthem {
 	struct Error {
@@ -17,12 +18,17 @@ namespace Anthem {
 	class ErrorHandler {
 	public:
 		ErrorHandler() = default;
+		ErrorHandler(const SourceManager* source_manager) : m_source_manager{ source_manager } {}
 
 		const std::vector<Error>& get_errors() const { return m_errors; }
 
-		// Add error to the list
+		// Add error to the list, errors past the limit are dropped
 		void report_error(const Error& error);
 
+		// Keep at most <limit> errors, 0 keeps all of them. Phases that can go on after an error stop once the limit is reached
+		void set_error_limit(size_t limit) { m_error_limit = limit; }
+		bool error_limit_reached() const { return m_error_limit != 0 && m_errors.size() >= m_error_limit; }
+
 		// Log all errors to the console
 		void print_errors();
 
@@ -30,5 +36,9 @@ namespace Anthem {
 		bool has_errors();
 	private:
 		std::vector<Error> m_errors;
+		size_t m_error_limit{ 0 };
+
+		// Used to look up the source code, file and line of error positions
+		const SourceManager* m_source_manager{ nullptr };
 	};
 }
\ No newline at end of file
@@ -0,0 +1,38 @@
+// Ids.cpp
+// Contains the text conversions of local variable, temporary, expression and label ids
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#include "Ids.h"
+
+namespace Anthem {
+	// Label prefixes, indexed by LabelKind
+	static const char* s_label_prefixes[] = {
+		"loop.",
+		"exit.",
+		"false_label.",
+		"end_label.",
+		"early_leave.",
+		"end.",
+		"out_of_bounds."
+	};
+
+	std::string LabelId::str() const {
+		return s_label_prefixes[static_cast<uint8_t>(kind)] + std::to_string(number);
+	}
+
+	std::ostream& operator<<(std::ostream& stream, VarId id) {
+		return stream << '%' << id.value();
+	}
+
+	std::ostream& operator<<(std::ostream& stream, TempId id) {
+		return stream << '#' << id.value();
+	}
+
+	std::ostream& operator<<(std::ostream& stream, ExprId id) {
+		return stream << '$' << id.value();
+	}
+
+	std::ostream& operator<<(std::ostream& stream, const LabelId& label) {
+		return stream << s_label_prefixes[static_cast<uint8_t>(label.kind)] << label.number;
+	}
+}
@@ -0,0 +1,80 @@
+// Ids.h
+// Contains the typed integer ids of local variables, temporaries, expressions and labels
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+
+namespace Anthem {
+	/*
+	*  Locals and temporaries are only numbered while the program is analyzed and lowered, they never get a text of their own
+	*  and end up as stack slots. Each kind of id is a distinct type, so a local can't be passed where a temporary is expected.
+	*/
+	template<typename Tag>
+	class TypedId {
+	public:
+		static constexpr uint32_t INVALID = UINT32_MAX;
+
+		// The invalid id
+		TypedId() = default;
+		explicit TypedId(uint32_t value) : m_value{ value } {}
+
+		uint32_t value() const { return m_value; }
+		bool valid() const { return m_value != INVALID; }
+
+		bool operator==(const TypedId& other) const { return m_value == other.m_value; }
+		bool operator!=(const TypedId& other) const { return m_value != other.m_value; }
+	private:
+		uint32_t m_value{ INVALID };
+	};
+
+	// A local variable or parameter, numbered by the SemanticAnalyzer
+	using VarId = TypedId<struct VarIdTag>;
+
+	// A temporary holding an intermediate value, numbered per function by the AIRGenerator
+	using TempId = TypedId<struct TempIdTag>;
+
+	// An expression, numbered by the SemanticAnalyzer so later passes can keep what they know about it in dense tables
+	using ExprId = TypedId<struct ExprIdTag>;
+
+	enum class LabelKind : uint8_t {
+		// Start and exit of a loop, numbered by the loop id
+		LOOP,
+		EXIT,
+
+		// Else branch and end of an if statement
+		FALSE_BRANCH,
+		END_IF,
+
+		// Short-circuit target and end of a logical operation
+		EARLY_LEAVE,
+		END_LOGICAL,
+
+		// Trap of a function whose array indices are checked, numbered by the function
+		OUT_OF_BOUNDS
+	};
+
+	// A jump target, its text is only created when it is emitted or printed
+	struct LabelId {
+		LabelKind kind{ LabelKind::LOOP };
+		uint32_t number{ 0 };
+
+		std::string str() const;
+
+		bool operator==(const LabelId& other) const { return kind == other.kind && number == other.number; }
+		bool operator!=(const LabelId& other) const { return !(*this == other); }
+	};
+
+	std::ostream& operator<<(std::ostream& stream, VarId id);
+	std::ostream& operator<<(std::ostream& stream, TempId id);
+	std::ostream& operator<<(std::ostream& stream, ExprId id);
+	std::ostream& operator<<(std::ostream& stream, const LabelId& label);
+}
+
+template<typename Tag>
+struct std::hash<Anthem::TypedId<Tag>> {
+	size_t operator()(const Anthem::TypedId<Tag>& id) const noexcept { return std::hash<uint32_t>{}(id.value()); }
+};
@@ -0,0 +1,108 @@
+// Name.cpp
+// Contains the string interner behind the Name Class
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#include "Name.h"
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include <cstring>
+
+namespace Anthem {
+	/*
+	*  Maps strings to symbols and back. Characters are copied into large blocks that are never freed or moved,
+	*  so each Name costs its characters plus one view and one map entry, no matter how often it is used.
+	*  Lookups of existing strings only take a shared lock, so threads interning known names do not block each other.
+	*/
+	class StringInterner {
+	public:
+		StringInterner() {
+			m_strings.push_back(std::string_view{});
+			m_symbols.emplace(std::string_view{}, 0);
+		}
+
+		uint32_t intern(std::string_view string) {
+			{
+				std::shared_lock lock(m_mutex);
+				auto symbol = m_symbols.find(string);
+				if (symbol != m_symbols.end())
+					return symbol->second;
+			}
+
+			std::unique_lock lock(m_mutex);
+
+			// Another thread may have interned the same string between the two locks
+			auto symbol = m_symbols.find(string);
+			if (symbol != m_symbols.end())
+				return symbol->second;
+
+			std::string_view stored = store(string);
+			uint32_t id = uint32_t(m_strings.size());
+			m_strings.push_back(stored);
+			m_symbols.emplace(stored, id);
+			return id;
+		}
+
+		std::string_view lookup(uint32_t id) {
+			std::shared_lock lock(m_mutex);
+			return m_strings[id];
+		}
+
+		size_t size() {
+			std::shared_lock lock(m_mutex);
+			return m_strings.size();
+		}
+	private:
+		// Copy the characters into the current block, starting a new block when it is full
+		std::string_view store(std::string_view string) {
+			// Oversized strings get a block of their own
+			if (string.size() > BLOCK_SIZE) {
+				m_blocks.push_back(std::make_unique<char[]>(string.size()));
+				std::memcpy(m_blocks.back().get(), string.data(), string.size());
+				return { m_blocks.back().get(), string.size() };
+			}
+
+			if (string.size() > BLOCK_SIZE - m_block_used) {
+				m_blocks.push_back(std::make_unique<char[]>(BLOCK_SIZE));
+				m_block = m_blocks.back().get();
+				m_block_used = 0;
+			}
+			char* destination = m_block + m_block_used;
+			std::memcpy(destination, string.data(), string.size());
+			m_block_used += string.size();
+			return { destination, string.size() };
+		}
+	private:
+		static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+		std::shared_mutex m_mutex;
+		std::unordered_map<std::string_view, uint32_t> m_symbols;
+		std::vector<std::string_view> m_strings;
+
+		std::vector<std::unique_ptr<char[]>> m_blocks;
+		char* m_block{ nullptr };
+		size_t m_block_used{ BLOCK_SIZE };
+	};
+
+	// Constructed on first use, so Names can be created during static initialization
+	static StringInterner& get_interner() {
+		static StringInterner interner;
+		return interner;
+	}
+
+	Name::Name(std::string_view string) : m_id{ string.empty() ? 0 : get_interner().intern(string) } {}
+
+	std::string_view Name::view() const {
+		return m_id ? get_interner().lookup(m_id) : std::string_view{};
+	}
+
+	std::ostream& operator<<(std::ostream& stream, const Name& name) {
+		return stream << name.view();
+	}
+
+	size_t get_interned_name_count() {
+		return get_interner().size();
+	}
+}
@@ -0,0 +1,51 @@
+// Name.h
+// Contains the Name Class definition, an interned identifier
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace Anthem {
+	/*
+	*  Identifier interned in a global, thread-safe string table.
+	*  A Name is only a 32 bit symbol, so copying, comparing and hashing one never touches its characters.
+	*  The text lives for the whole program and is only looked up when it is printed or emitted.
+	*/
+	class Name {
+	public:
+		// The empty Name
+		Name() = default;
+
+		// Intern a string, the same text always gets the same symbol
+		Name(std::string_view string);
+		Name(const std::string& string) : Name{ std::string_view(string) } {}
+		Name(const char* string) : Name{ std::string_view(string) } {}
+
+		// Get the interned text, the view stays valid for the lifetime of the program
+		std::string_view view() const;
+		std::string str() const { return std::string(view()); }
+
+		uint32_t id() const { return m_id; }
+		bool empty() const { return m_id == 0; }
+
+		bool operator==(const Name& other) const { return m_id == other.m_id; }
+		bool operator!=(const Name& other) const { return m_id != other.m_id; }
+	private:
+		// Symbol 0 is reserved for the empty Name
+		uint32_t m_id{ 0 };
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const Name& name);
+
+	// Number of distinct Names interned so far (including the empty one)
+	size_t get_interned_name_count();
+}
+
+template<>
+struct std::hash<Anthem::Name> {
+	size_t operator()(const Anthem::Name& name) const noexcept { return std::hash<uint32_t>{}(name.id()); }
+};
@@ -0,0 +1,119 @@
+// SourceBuffer.cpp
+// Contains the SourceBuffer Class method implementations
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#include "SourceBuffer.h"
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+	#include <fstream>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+namespace Anthem {
+	const char SourceBuffer::s_empty[SourceBuffer::PADDING] = {};
+
+	SourceBuffer::~SourceBuffer() {
+		release();
+	}
+
+	SourceBuffer::SourceBuffer(SourceBuffer&& other) noexcept {
+		*this = std::move(other);
+	}
+
+	SourceBuffer& SourceBuffer::operator=(SourceBuffer&& other) noexcept {
+		if (this != &other) {
+			release();
+			m_data = std::exchange(other.m_data, nullptr);
+			m_size = std::exchange(other.m_size, 0);
+			m_mapped_size = std::exchange(other.m_mapped_size, 0);
+		}
+		return *this;
+	}
+
+	void SourceBuffer::release() {
+		if (!m_data)
+			return;
+#ifndef _WIN32
+		if (m_mapped_size) {
+			munmap(m_data, m_mapped_size);
+			m_data = nullptr;
+			return;
+		}
+#endif
+		delete[] m_data;
+		m_data = nullptr;
+	}
+
+	void SourceBuffer::load_string(std::string_view source) {
+		release();
+		m_size = source.size();
+		m_mapped_size = 0;
+
+		// Value initialization zeroes the padding
+		m_data = new char[m_size + PADDING]();
+		std::memcpy(m_data, source.data(), m_size);
+	}
+
+#ifdef _WIN32
+	bool SourceBuffer::load_file(const std::filesystem::path& file_path) {
+		std::ifstream file(file_path, std::ios::binary | std::ios::ate);
+		if (!file)
+			return false;
+
+		release();
+		m_size = static_cast<size_t>(file.tellg());
+		m_mapped_size = 0;
+		m_data = new char[m_size + PADDING]();
+
+		// Read straight into the padded buffer, without going through an intermediate string
+		file.seekg(0);
+		file.read(m_data, m_size);
+		return true;
+	}
+#else
+	bool SourceBuffer::load_file(const std::filesystem::path& file_path) {
+		int file = open(file_path.c_str(), O_RDONLY);
+		if (file < 0)
+			return false;
+
+		struct stat file_info;
+		if (fstat(file, &file_info) != 0) {
+			close(file);
+			return false;
+		}
+
+		size_t size = static_cast<size_t>(file_info.st_size);
+		size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+		size_t mapped_size = (size + PADDING + page_size - 1) / page_size * page_size;
+
+		// Reserve zeroed anonymous memory for the whole buffer including the padding, then map the file over its start.
+		// The kernel zero fills the rest of the last file page, and the pages after it stay anonymous zero pages
+		void* base = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (base == MAP_FAILED) {
+			close(file);
+			return false;
+		}
+		if (size && mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, file, 0) == MAP_FAILED) {
+			munmap(base, mapped_size);
+			close(file);
+			return false;
+		}
+		close(file);
+
+		// The lexer walks the file front to back
+		madvise(base, size, MADV_SEQUENTIAL);
+
+		release();
+		m_data = static_cast<char*>(base);
+		m_size = size;
+		m_mapped_size = mapped_size;
+		return true;
+	}
+#endif
+}
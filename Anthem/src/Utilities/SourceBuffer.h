@@ -0,0 +1,49 @@
+// SourceBuffer.h
+// Contains the SourceBuffer Class definition
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#pragma once
+#include <string_view>
+#include <filesystem>
+
+namespace Anthem {
+	/*
+	*  Immutable, read-only buffer holding the source code of a file.
+	*  Files are memory mapped where the platform allows it, so loading a file costs page faults instead of copies.
+	*  The buffer is always followed by at least PADDING zero bytes, the first one acts as the End of File sentinel
+	*  and the rest allow reading a few characters ahead of the end without checking bounds.
+	*/
+	class SourceBuffer {
+	public:
+		static constexpr size_t PADDING = 64;
+
+		SourceBuffer() = default;
+		~SourceBuffer();
+
+		SourceBuffer(SourceBuffer&& other) noexcept;
+		SourceBuffer& operator=(SourceBuffer&& other) noexcept;
+		SourceBuffer(const SourceBuffer&) = delete;
+		SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+		// Map the file at the given path, returns false if it could not be opened
+		bool load_file(const std::filesystem::path& file_path);
+
+		// Copy source code that does not come from a file (e.g. generated code)
+		void load_string(std::string_view source);
+
+		const char* data() const { return m_data ? m_data : s_empty; }
+		size_t size() const { return m_size; }
+		std::string_view view() const { return { data(), m_size }; }
+	private:
+		void release();
+	private:
+		char* m_data{ nullptr };
+		size_t m_size{ 0 };
+
+		// Size of the memory mapping, 0 if the buffer was allocated on the heap
+		size_t m_mapped_size{ 0 };
+
+		// Used for empty buffers, so there is always a sentinel to read
+		static const char s_empty[PADDING];
+	};
+}
@@ -0,0 +1,90 @@
+// SourceManager.cpp
+// Contains the SourceManager Class method implementations
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#include "SourceManager.h"
+#include "Lexer/Scanner.h"
+#include <algorithm>
+
+namespace Anthem {
+	SourceManager::SourceManager() {
+		// Reserve the invalid FileID
+		m_files.push_back({});
+	}
+
+	FileID SourceManager::load_file(const std::filesystem::path& file_path) {
+		SourceBuffer buffer;
+		if (!buffer.load_file(file_path))
+			return INVALID_FILE;
+		m_files.push_back({ file_path, std::move(buffer), {}, false });
+		return static_cast<FileID>(m_files.size() - 1);
+	}
+
+	FileID SourceManager::add_file(const std::filesystem::path& file_path, std::string_view source) {
+		SourceBuffer buffer;
+		buffer.load_string(source);
+		m_files.push_back({ file_path, std::move(buffer), {}, false });
+		return static_cast<FileID>(m_files.size() - 1);
+	}
+
+	bool SourceManager::is_valid(FileID file_id) const {
+		return file_id != INVALID_FILE && file_id < m_files.size();
+	}
+
+	const std::filesystem::path& SourceManager::get_path(FileID file_id) const {
+		return m_files[file_id].path;
+	}
+
+	std::string_view SourceManager::get_source(FileID file_id) const {
+		return m_files[file_id].source.view();
+	}
+
+	std::string_view SourceManager::get_text(FileID file_id, uint32_t offset, uint32_t length) const {
+		return get_source(file_id).substr(offset, length);
+	}
+
+	uint32_t SourceManager::get_line(const Position& position) const {
+		return find_line(position.file_id, position.src_start_index);
+	}
+
+	uint32_t SourceManager::get_column(const Position& position) const {
+		uint32_t line = find_line(position.file_id, position.src_start_index);
+		return position.src_start_index - get_line_offsets(position.file_id)[line];
+	}
+
+	std::string_view SourceManager::get_line_text(FileID file_id, uint32_t line) const {
+		const std::vector<uint32_t>& line_offsets = get_line_offsets(file_id);
+		std::string_view source = get_source(file_id);
+		if (line >= line_offsets.size())
+			return {};
+
+		uint32_t start = line_offsets[line];
+		uint32_t end = line + 1 < line_offsets.size() ? line_offsets[line + 1] - 1 : uint32_t(source.size());
+		return source.substr(start, end - start);
+	}
+
+	const std::vector<uint32_t>& SourceManager::get_line_offsets(FileID file_id) const {
+		std::lock_guard lock(m_line_offsets_mutex);
+		SourceFile& file = m_files[file_id];
+		if (file.has_line_offsets)
+			return file.line_offsets;
+
+		// Count the lines first so the table is allocated exactly once
+		std::string_view source = file.source.view();
+		file.line_offsets.reserve(count_newlines(source.data(), source.size()) + 1);
+		file.line_offsets.push_back(0);
+		for (size_t newline = source.find('\n'); newline != std::string_view::npos; newline = source.find('\n', newline + 1))
+			file.line_offsets.push_back(uint32_t(newline + 1));
+
+		file.has_line_offsets = true;
+		return file.line_offsets;
+	}
+
+	uint32_t SourceManager::find_line(FileID file_id, uint32_t offset) const {
+		const std::vector<uint32_t>& line_offsets = get_line_offsets(file_id);
+
+		// The line is the last one starting at or before the offset
+		auto next_line = std::upper_bound(line_offsets.begin(), line_offsets.end(), offset);
+		return static_cast<uint32_t>(next_line - line_offsets.begin() - 1);
+	}
+}
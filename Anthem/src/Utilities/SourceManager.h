@@ -0,0 +1,70 @@
+// SourceManager.h
+// Contains the SourceManager Class definition
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#pragma once
+#include <string>
+#include <string_view>
+#include <filesystem>
+#include <vector>
+#include <mutex>
+#include "Utilities.h"
+#include "SourceBuffer.h"
+
+namespace Anthem {
+	/*
+	*  Owns the source code of every file taking part in a compilation and assigns each one a small FileID.
+	*  Tokens and Positions only store a FileID and byte offsets, everything else (file path, token text,
+	*  line and column numbers) is looked up here when it is actually needed.
+	*/
+	class SourceManager {
+	public:
+		SourceManager();
+
+		// Map a file from disk and register it, returns INVALID_FILE if the file could not be opened.
+		// The returned FileID and the source buffer stay valid for the lifetime of the SourceManager
+		FileID load_file(const std::filesystem::path& file_path);
+
+		// Register source code that is already in memory under a file path
+		FileID add_file(const std::filesystem::path& file_path, std::string_view source);
+
+		// Return true if the FileID refers to a registered file
+		bool is_valid(FileID file_id) const;
+
+		const std::filesystem::path& get_path(FileID file_id) const;
+		// The returned view is followed by SourceBuffer::PADDING zero bytes
+		std::string_view get_source(FileID file_id) const;
+
+		// Get the text in the range [offset, offset + length) of a file
+		std::string_view get_text(FileID file_id, uint32_t offset, uint32_t length) const;
+
+		// Get the (zero based) line a position starts at
+		uint32_t get_line(const Position& position) const;
+
+		// Get the (zero based) column a position starts at, in bytes from the start of its line
+		uint32_t get_column(const Position& position) const;
+
+		// Get the text of a (zero based) line, without its newline
+		std::string_view get_line_text(FileID file_id, uint32_t line) const;
+	private:
+		struct SourceFile {
+			std::filesystem::path path;
+			SourceBuffer source;
+
+			// Offset of the first character of every line, only built once a line is asked for
+			std::vector<uint32_t> line_offsets;
+			bool has_line_offsets{ false };
+		};
+
+		// Get the line offset table of a file, building it on first use
+		const std::vector<uint32_t>& get_line_offsets(FileID file_id) const;
+
+		// Find the line that contains an offset by binary searching the line offset table
+		uint32_t find_line(FileID file_id, uint32_t offset) const;
+	private:
+		// Index 0 is reserved for positions that do not belong to any file
+		// Line offset tables are built lazily by const lookups, so the files are mutable and guarded by a mutex
+		mutable std::vector<SourceFile> m_files;
+		mutable std::mutex m_line_offsets_mutex;
+	};
+}
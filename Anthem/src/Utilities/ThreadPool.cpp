@@ -0,0 +1,142 @@
+// ThreadPool.cpp
+// Contains the ThreadPool Class method implementations
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#include "ThreadPool.h"
+
+namespace Anthem {
+	ThreadPool::ThreadPool(size_t thread_count) {
+		if (thread_count == 0)
+			thread_count = std::thread::hardware_concurrency();
+		if (thread_count == 0)
+			thread_count = 1;
+
+		m_ranges = std::make_unique<WorkRange[]>(thread_count);
+		for (size_t i = 1; i < thread_count; i++)
+			m_workers.emplace_back([this, i] { worker_loop(i); });
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			std::lock_guard lock(m_mutex);
+			m_stopping = true;
+		}
+		m_work_available.notify_all();
+		for (std::thread& worker : m_workers)
+			worker.join();
+	}
+
+	void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& function) {
+		if (count == 0)
+			return;
+
+		// Run small batches directly instead of waking up the workers
+		if (count == 1 || m_workers.empty()) {
+			for (size_t i = 0; i < count; i++)
+				function(i);
+			return;
+		}
+
+		{
+			std::lock_guard lock(m_mutex);
+			m_function = &function;
+			m_remaining = count;
+
+			// Deal out the indices in equal contiguous ranges, which keeps neighbouring indices on the same thread
+			size_t thread_count = size();
+			for (size_t i = 0; i < thread_count; i++)
+				m_ranges[i].range = pack_range(count * i / thread_count, count * (i + 1) / thread_count);
+			m_generation++;
+		}
+		m_work_available.notify_all();
+
+		run_batch(0);
+
+		std::unique_lock lock(m_mutex);
+		m_work_done.wait(lock, [this] { return m_remaining == 0 && m_active_workers == 0; });
+		m_function = nullptr;
+	}
+
+	void ThreadPool::worker_loop(size_t thread_index) {
+		uint64_t seen_generation = 0;
+		while (true) {
+			{
+				std::unique_lock lock(m_mutex);
+				m_work_available.wait(lock, [&] { return m_stopping || m_generation != seen_generation; });
+				if (m_stopping)
+					return;
+				seen_generation = m_generation;
+
+				// The batch may have been finished by the other threads before this one woke up
+				if (m_remaining == 0)
+					continue;
+				m_active_workers++;
+			}
+
+			run_batch(thread_index);
+
+			{
+				std::lock_guard lock(m_mutex);
+				m_active_workers--;
+			}
+			m_work_done.notify_all();
+		}
+	}
+
+	void ThreadPool::run_batch(size_t thread_index) {
+		size_t index;
+		while (take_index(thread_index, index) || steal_index(thread_index, index))
+			run_index(index);
+	}
+
+	bool ThreadPool::take_index(size_t thread_index, size_t& index) {
+		std::atomic<uint64_t>& range = m_ranges[thread_index].range;
+		uint64_t current = range.load();
+		while (true) {
+			uint64_t next = current >> 32;
+			uint64_t end = current & UINT32_MAX;
+			if (next >= end)
+				return false;
+
+			// A thief may have shrunk the range in the meantime, then the new value is loaded and tried again
+			if (range.compare_exchange_weak(current, pack_range(next + 1, end))) {
+				index = size_t(next);
+				return true;
+			}
+		}
+	}
+
+	bool ThreadPool::steal_index(size_t thread_index, size_t& index) {
+		size_t thread_count = size();
+		for (size_t offset = 1; offset < thread_count; offset++) {
+			std::atomic<uint64_t>& victim = m_ranges[(thread_index + offset) % thread_count].range;
+			uint64_t current = victim.load();
+			while (true) {
+				uint64_t next = current >> 32;
+				uint64_t end = current & UINT32_MAX;
+				if (next >= end)
+					break;
+
+				// Take the back half, rounded up so a single index left can be stolen too
+				uint64_t middle = end - (end - next + 1) / 2;
+				if (victim.compare_exchange_weak(current, pack_range(next, middle))) {
+					// Nobody steals from an empty range, so this thread's own range can be set directly
+					m_ranges[thread_index].range = pack_range(middle + 1, end);
+					index = size_t(middle);
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	void ThreadPool::run_index(size_t index) {
+		(*m_function)(index);
+
+		if (m_remaining.fetch_sub(1) == 1) {
+			// Take the lock so the notification can not slip in between the waiter's check and its wait
+			{ std::lock_guard lock(m_mutex); }
+			m_work_done.notify_all();
+		}
+	}
+}
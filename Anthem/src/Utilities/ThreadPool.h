@@ -0,0 +1,78 @@
+// ThreadPool.h
+// Contains the ThreadPool Class definition
+// Copyright (c) 2024-present, Stylianos Kementzetzidis
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Anthem {
+	/*
+	*  Fixed set of worker threads used by the phases that can split their work into independent pieces.
+	*  The thread calling parallel_for takes part in the work, so a pool of N threads starts N - 1 workers.
+	*  Every thread starts a batch with its own contiguous range of indices, and once it runs out it steals
+	*  half of the remaining indices of another thread, so batches of uneven pieces still keep every thread busy.
+	*/
+	class ThreadPool {
+	public:
+		// Uses one thread per hardware thread if <thread_count> is 0
+		explicit ThreadPool(size_t thread_count = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// Number of threads work is spread over, including the calling thread
+		size_t size() const { return m_workers.size() + 1; }
+
+		// Call <function> for every index in [0, count) and wait until all calls have returned.
+		// Only one parallel_for may run at a time, <count> must fit in 32 bits
+		void parallel_for(size_t count, const std::function<void(size_t)>& function);
+	private:
+		// Indices [next, end) of the current batch that a thread has not run yet, packed in one word as (next << 32) | end,
+		// so the owner can take the front and thieves can split off the back with a single compare and swap
+		struct alignas(64) WorkRange {
+			std::atomic<uint64_t> range{ 0 };
+		};
+
+		static uint64_t pack_range(uint64_t next, uint64_t end) { return (next << 32) | end; }
+
+		void worker_loop(size_t thread_index);
+
+		// Run indices from the range of <thread_index>, then steal from the other threads until no indices are left
+		void run_batch(size_t thread_index);
+
+		// Take the next index of the range of <thread_index>, returns false if it is empty
+		bool take_index(size_t thread_index, size_t& index);
+
+		// Move the back half of another thread's range to the (empty) range of <thread_index> and take its first index
+		bool steal_index(size_t thread_index, size_t& index);
+
+		void run_index(size_t index);
+	private:
+		std::vector<std::thread> m_workers;
+
+		std::mutex m_mutex;
+		std::condition_variable m_work_available;
+		std::condition_variable m_work_done;
+
+		// State of the current batch
+		const std::function<void(size_t)>* m_function{ nullptr };
+		std::atomic<size_t> m_remaining{ 0 };
+
+		// One range per thread, the calling thread owns the first one
+		std::unique_ptr<WorkRange[]> m_ranges;
+
+		// Workers that are running indices of the current batch, the batch is only over once they have all left it
+		size_t m_active_workers{ 0 };
+
+		// Incremented for every batch, so sleeping workers can tell a new batch from a spurious wake up
+		uint64_t m_generation{ 0 };
+		bool m_stopping{ false };
+	};
+}
@@ -1,17 +1,19 @@
 #pragma once
 #include <filesystem>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <variant>
 #include <unordered_map>
+#include <cstdint>
+#include <bit>
+#include "Name.h"
+#include "Ids.h"
 
 namespace Anthem {
 	template<typename T>
 	using ptr = std::shared_ptr<T>;
 
-	// Using 'Name' type in case it gets changed from std::string
-	using Name = std::string;
-
 	enum class VarFlag {
 		Local,
 		Global,
@@ -20,6 +22,8 @@ namespace Anthem {
 	};
 
 	enum class ReturnType {
+		I8,
+		I16,
 		I32,
 		I64,
 		F32,
@@ -27,22 +31,96 @@ namespace Anthem {
 		BOOL
 	};
 
+	inline bool is_floating(ReturnType type) { return type == ReturnType::F32 || type == ReturnType::F64; }
+
+	// Size of a value of the type in bytes
+	inline uint32_t type_size(ReturnType type) {
+		switch (type)
+		{
+		case ReturnType::I8:
+		case ReturnType::BOOL:
+			return 1;
+		case ReturnType::I16:
+			return 2;
+		case ReturnType::I64:
+		case ReturnType::F64:
+			return 8;
+		default:
+			return 4;
+		}
+	}
+
+	// Type both operands of an arithmetic or relational operation are converted to.
+	// Floating point wins over integers and the wider type wins otherwise, bools take part as i32
+	inline ReturnType common_type(ReturnType a, ReturnType b) {
+		if (a == ReturnType::BOOL) a = ReturnType::I32;
+		if (b == ReturnType::BOOL) b = ReturnType::I32;
+		if (is_floating(a) != is_floating(b))
+			return is_floating(a) ? a : b;
+		return type_size(a) >= type_size(b) ? a : b;
+	}
+
+	// Wrap an integer to the width of an integer type, bools become 0 or 1
+	inline int64_t wrap_integer(int64_t value, ReturnType type) {
+		switch (type)
+		{
+		case ReturnType::I8:	return int8_t(value);
+		case ReturnType::I16:	return int16_t(value);
+		case ReturnType::I32:	return int32_t(value);
+		case ReturnType::BOOL:	return value != 0;
+		default:				return value;
+		}
+	}
+
+	// Bit pattern of a floating point value stored as <type>
+	inline int64_t floating_bits(double value, ReturnType type) {
+		if (type == ReturnType::F32)
+			return std::bit_cast<uint32_t>(float(value));
+		return std::bit_cast<int64_t>(value);
+	}
+
 	struct VariableType {
 		ReturnType return_type = ReturnType::I32;
 		VarFlag flag = VarFlag::Local;
-		int initializer = 0;
+
+		// Initial value converted to the type, floating point values are stored as their bit pattern
+		int64_t initializer = 0;
+
+		// The initializer calls constant functions, so it is only evaluated by the AIRGenerator once they are generated
+		bool calls_functions = false;
+
+		// Number of elements if the variable is an array, 0 otherwise
+		uint32_t array_length = 0;
 	};
 
 	struct FunctionType {
 		ReturnType return_type = ReturnType::I32;
 		std::vector<ReturnType> parameters;
 		bool is_external = false;
+		bool is_const = false;
 		VarFlag flag = VarFlag::Global;
 	};
 
 	using Type = std::variant<VariableType, FunctionType>;
 	using SymbolTable = std::unordered_map<Name, Type>;
 
+	// Type of every expression of a program, produced by the TypeChecker and indexed by the ExprId of the expression
+	class ExpressionTypes {
+	public:
+		ReturnType operator[](ExprId id) const { return m_types[id.value()]; }
+
+		void set(ExprId id, ReturnType type) {
+			if (id.value() >= m_types.size())
+				m_types.resize(id.value() + 1, ReturnType::I32);
+			m_types[id.value()] = type;
+		}
+
+		size_t size() const { return m_types.size(); }
+		void clear() { m_types.clear(); }
+	private:
+		std::vector<ReturnType> m_types;
+	};
+
 	enum class UnaryOperation {
 		NEGATE,
 		COMPLEMENT,
@@ -72,15 +150,30 @@ namespace Anthem {
 		NONE
 	};
 
-	struct Position {
-		std::filesystem::path src_file_path{ "" };
+	inline bool is_relational(BinaryOperation operation) {
+		switch (operation) {
+		case BinaryOperation::GREATER:
+		case BinaryOperation::LESS:
+		case BinaryOperation::GREATER_EQUAL:
+		case BinaryOperation::LESS_EQUAL:
+		case BinaryOperation::EQUAL:
+		case BinaryOperation::NOT_EQUAL:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// Index of a file registered in the SourceManager
+	using FileID = uint16_t;
+	constexpr FileID INVALID_FILE = 0;
 
-		// Token Start and End Index in source file
-		int src_start_index{ 0 };
-		int src_end_index{ 0 };
+	struct Position {
+		FileID file_id{ INVALID_FILE };
 
-		// Line of Token in the source file
-		int src_line{ 0 };
+		// Token Start and End Index in source file, the line is computed by the SourceManager when needed
+		uint32_t src_start_index{ 0 };
+		uint32_t src_end_index{ 0 };
 	};
 
 	enum class LogType {
@@ -14,4 +14,5 @@ group "Anthem"
 	include "Anthem/build-lib.lua"
 group ""
 
-include "Anthem-Build-Manager/build-app.lua"
\ No newline at end of file
+include "Anthem-Build-Manager/build-app.lua"
+include "Anthem-Benchmark/build-bench.lua"
\ No newline at end of file